@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2026, Regents of the University of California
+ * BSD license, See the COPYING file for more information
+ */
+
+/*
+ * Digest-only and HMAC signatures.
+ *
+ * Between services that already trust each other a public key signature is
+ * mostly overhead. With DigestAlgorithm set to SHA256 the SignatureBits are
+ * just the digest of the signed part (Name, SignedInfo and Content), which
+ * only detects corruption; with HMAC-SHA256 they are a MAC of it, keyed by
+ * a secret both sides share. The DigestAlgorithm OID is what tells the
+ * receiver which one it got, objects without it are signed with the
+ * publisher's key as before.
+ */
+
+#include <ccn/ccn.h>
+
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/sha.h>
+
+#include <string.h>
+
+#include "digest_sign.h"
+
+#define HASHLEN SHA256_DIGEST_LENGTH
+
+enum digest_sign_alg
+digest_sign_alg_from_oid(const char *oid, size_t len)
+{
+	if (!oid || len == 0)
+		return DIGEST_SIGN_DEFAULT;
+
+	if (len == sizeof(DIGEST_SIGN_OID_SHA256) - 1 &&
+			!memcmp(oid, DIGEST_SIGN_OID_SHA256, len))
+		return DIGEST_SIGN_SHA256;
+
+	if (len == sizeof(DIGEST_SIGN_OID_HMAC_SHA256) - 1 &&
+			!memcmp(oid, DIGEST_SIGN_OID_HMAC_SHA256, len))
+		return DIGEST_SIGN_HMAC_SHA256;
+
+	return DIGEST_SIGN_UNKNOWN;
+}
+
+enum digest_sign_alg
+digest_sign_alg_of(const unsigned char *msg,
+		const struct ccn_parsed_ContentObject *pco)
+{
+	const unsigned char *oid;
+	size_t len;
+	int r;
+
+	if (pco->offset[CCN_PCO_B_DigestAlgorithm] ==
+			pco->offset[CCN_PCO_E_DigestAlgorithm])
+		return DIGEST_SIGN_DEFAULT;
+
+	r = ccn_ref_tagged_string(CCN_DTAG_DigestAlgorithm, msg,
+			pco->offset[CCN_PCO_B_DigestAlgorithm],
+			pco->offset[CCN_PCO_E_DigestAlgorithm], &oid, &len);
+	if (r < 0)
+		return DIGEST_SIGN_UNKNOWN;
+
+	return digest_sign_alg_from_oid((const char *) oid, len);
+}
+
+static int
+compute(const unsigned char *data, size_t len, enum digest_sign_alg alg,
+		const void *secret, size_t secret_len, unsigned char *result)
+{
+	unsigned int result_len;
+
+	switch (alg) {
+	case DIGEST_SIGN_SHA256:
+		SHA256(data, len, result);
+		return 0;
+	case DIGEST_SIGN_HMAC_SHA256:
+		if (!secret || secret_len == 0)
+			return -1;
+
+		if (!HMAC(EVP_sha256(), secret, secret_len, data, len, result,
+				&result_len) || result_len != HASHLEN)
+			return -1;
+		return 0;
+	default:
+		return -1;
+	}
+}
+
+/*
+ * result is appended to, ccn_encode_ContentObject() can't be used since
+ * libccn signs everything with a private key
+ */
+int
+digest_sign_encode_ContentObject(struct ccn_charbuf *result,
+		const struct ccn_charbuf *name, const struct ccn_charbuf *signed_info,
+		const void *content, size_t content_len, enum digest_sign_alg alg,
+		const void *secret, size_t secret_len)
+{
+	struct ccn_charbuf *signed_part;
+	unsigned char bits[HASHLEN];
+	const char *oid;
+	int r = -1;
+
+	if (alg == DIGEST_SIGN_SHA256)
+		oid = DIGEST_SIGN_OID_SHA256;
+	else if (alg == DIGEST_SIGN_HMAC_SHA256)
+		oid = DIGEST_SIGN_OID_HMAC_SHA256;
+	else
+		return -1;
+
+	signed_part = ccn_charbuf_create();
+	if (!signed_part)
+		return -1;
+
+	if (ccn_charbuf_append_charbuf(signed_part, name) < 0 ||
+			ccn_charbuf_append_charbuf(signed_part, signed_info) < 0 ||
+			ccnb_append_tagged_blob(signed_part, CCN_DTAG_Content, content,
+			content_len) < 0)
+		goto out;
+
+	if (compute(signed_part->buf, signed_part->length, alg, secret, secret_len,
+			bits) < 0)
+		goto out;
+
+	if (ccn_charbuf_append_tt(result, CCN_DTAG_ContentObject, CCN_DTAG) < 0 ||
+			ccn_charbuf_append_tt(result, CCN_DTAG_Signature, CCN_DTAG) < 0 ||
+			ccnb_append_tagged_udata(result, CCN_DTAG_DigestAlgorithm, oid,
+			strlen(oid)) < 0 ||
+			ccnb_append_tagged_blob(result, CCN_DTAG_SignatureBits, bits,
+			sizeof(bits)) < 0 ||
+			ccn_charbuf_append_closer(result) < 0 || /* </Signature> */
+			ccn_charbuf_append_charbuf(result, signed_part) < 0 ||
+			ccn_charbuf_append_closer(result) < 0) /* </ContentObject> */
+		goto out;
+
+	r = 0;
+
+out:
+	OPENSSL_cleanse(bits, sizeof(bits));
+	ccn_charbuf_destroy(&signed_part);
+	return r;
+}
+
+/* returns 1 if the object is valid, 0 otherwise */
+int
+digest_sign_verify(const unsigned char *msg,
+		const struct ccn_parsed_ContentObject *pco, const void *secret,
+		size_t secret_len)
+{
+	unsigned char expected[HASHLEN];
+	const unsigned char *bits;
+	size_t bits_len;
+	int r;
+
+	r = ccn_ref_tagged_BLOB(CCN_DTAG_SignatureBits, msg,
+			pco->offset[CCN_PCO_B_SignatureBits],
+			pco->offset[CCN_PCO_E_SignatureBits], &bits, &bits_len);
+	if (r < 0 || bits_len != HASHLEN)
+		return 0;
+
+	r = compute(msg + pco->offset[CCN_PCO_B_Name],
+			pco->offset[CCN_PCO_E_Content] - pco->offset[CCN_PCO_B_Name],
+			digest_sign_alg_of(msg, pco), secret, secret_len, expected);
+	if (r < 0)
+		return 0;
+
+	return CRYPTO_memcmp(expected, bits, HASHLEN) == 0;
+}
@@ -0,0 +1,31 @@
+/*
+ * Copyright (c) 2026, Regents of the University of California
+ * BSD license, See the COPYING file for more information
+ */
+
+#ifndef DIGEST_SIGN_H
+#  define	DIGEST_SIGN_H
+
+/* values of DigestAlgorithm */
+#  define DIGEST_SIGN_OID_SHA256 "2.16.840.1.101.3.4.2.1"
+#  define DIGEST_SIGN_OID_HMAC_SHA256 "1.2.840.113549.2.9"
+
+enum digest_sign_alg {
+	DIGEST_SIGN_UNKNOWN = -1,
+	DIGEST_SIGN_DEFAULT = 0, /* signed with publisher's key */
+	DIGEST_SIGN_SHA256,
+	DIGEST_SIGN_HMAC_SHA256
+};
+
+enum digest_sign_alg digest_sign_alg_from_oid(const char *oid, size_t len);
+enum digest_sign_alg digest_sign_alg_of(const unsigned char *msg,
+		const struct ccn_parsed_ContentObject *pco);
+int digest_sign_encode_ContentObject(struct ccn_charbuf *result,
+		const struct ccn_charbuf *name, const struct ccn_charbuf *signed_info,
+		const void *content, size_t content_len, enum digest_sign_alg alg,
+		const void *secret, size_t secret_len);
+int digest_sign_verify(const unsigned char *msg,
+		const struct ccn_parsed_ContentObject *pco, const void *secret,
+		size_t secret_len);
+
+#endif	/* DIGEST_SIGN_H */
@@ -16,6 +16,8 @@
 // On MacOS X, need to have the latest version from MacPorts
 // and add /opt/local/include as an include path
 #include <openssl/rsa.h>
+#include <openssl/ec.h>
+#include <openssl/objects.h>
 #include <openssl/pem.h>
 #include <openssl/evp.h>
 #include <openssl/sha.h>
@@ -24,63 +26,88 @@
 #include <openssl/err.h>
 
 #include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 
 #include "key_utils.h"
 #include "pyccn.h"
 #include "objects.h"
 #include "util.h"
 
-static char g_seed_file[200];
-static int g_seeded = 0;
-
-static void
-save_seed(void)
+/*
+ * Entropy for the PRNG, without ever blocking: getrandom() only waits until
+ * the kernel's pool is initialized early at boot, /dev/urandom never does.
+ * /dev/random (used before) could stall startup for seconds on VMs and
+ * containers.
+ */
+static int
+read_entropy(unsigned char *buf, size_t len)
 {
-	assert(*g_seed_file);
-
-	if (!g_seeded)
-		return; /* so we won't pollute the seed file*/
+	ssize_t r;
+	int fd;
+
+#ifdef SYS_getrandom
+	while (len > 0) {
+		r = syscall(SYS_getrandom, buf, len, 0);
+		if (r < 0 && errno == EINTR)
+			continue;
+		if (r < 0)
+			break; /* ENOSYS on older kernels */
+		buf += r;
+		len -= r;
+	}
 
-	RAND_write_file(g_seed_file);
-}
+	if (len == 0)
+		return 0;
+#endif
 
-static void
-seed_prng(void)
-{
-	const char *file;
-	int res;
+	fd = open("/dev/urandom", O_RDONLY);
+	if (fd < 0)
+		return -1;
 
-	if (*g_seed_file)
-		file = g_seed_file;
-	else
-		file = RAND_file_name(g_seed_file, sizeof(g_seed_file));
+	while (len > 0) {
+		r = read(fd, buf, len);
+		if (r < 0 && errno == EINTR)
+			continue;
+		if (r <= 0)
+			break;
+		buf += r;
+		len -= r;
+	}
+	close(fd);
 
-	if (!file)
-		panic("Unable to obtain name for random seed file.");
+	return len == 0 ? 0 : -1;
+}
 
-	if (RAND_load_file(file, -1)) {
-		g_seeded = 1;
+static pthread_once_t g_prng_once = PTHREAD_ONCE_INIT;
 
-		/* for a good measure */
-		RAND_load_file("/dev/random", 8);
+static void
+seed_prng_once(void)
+{
+	unsigned char seed[48];
 
-		return;
-	}
+	if (read_entropy(seed, sizeof(seed)) < 0)
+		panic("Unable to gather seed, neither getrandom() nor /dev/urandom"
+				" is available?");
 
-	/*
-	 * This is a special case, I hope it won't be normally used
-	 * please review if this is sufficient, I'm not using purely /dev/random
-	 * because some computers don't have enough enthropy
-	 */
-	res = RAND_load_file("/dev/urandom", 2048);
-	if (res < 2048)
-		panic("Unable to gather seed, /dev/urandom not available?");
+	RAND_seed(seed, sizeof(seed));
+	OPENSSL_cleanse(seed, sizeof(seed));
 
-	res = RAND_load_file("/dev/random", 32);
-	if (res < 32)
-		panic("Unable to gather enough entropy, /dev/random not available?");
+	if (!RAND_status())
+		panic("Unable to seed the PRNG");
+}
 
-	g_seeded = 1;
+/* done on first key generation, not when the module is imported */
+static void
+seed_prng(void)
+{
+	pthread_once(&g_prng_once, seed_prng_once);
 }
 
 static int
@@ -125,16 +152,117 @@ error:
 	return -1;
 }
 
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+/*
+ * OpenSSL before 1.1 is only thread safe once the application provides
+ * locking, we sign and verify without the GIL so we need it
+ */
+static pthread_mutex_t *g_openssl_locks;
+
+static void
+openssl_lock(int mode, int n, const char *UNUSED(file), int UNUSED(line))
+{
+	if (mode & CRYPTO_LOCK)
+		pthread_mutex_lock(&g_openssl_locks[n]);
+	else
+		pthread_mutex_unlock(&g_openssl_locks[n]);
+}
+
+static void
+openssl_thread_id(CRYPTO_THREADID *id)
+{
+	CRYPTO_THREADID_set_numeric(id, (unsigned long) pthread_self());
+}
+
+static void
+initialize_locking(void)
+{
+	int i, n;
+
+	/* someone else (e.g. python's _ssl) already takes care of it */
+	if (CRYPTO_get_locking_callback())
+		return;
+
+	n = CRYPTO_num_locks();
+	g_openssl_locks = malloc(n * sizeof(*g_openssl_locks));
+	if (!g_openssl_locks)
+		panic("Unable to allocate OpenSSL locks");
+
+	for (i = 0; i < n; i++)
+		pthread_mutex_init(&g_openssl_locks[i], NULL);
+
+	CRYPTO_THREADID_set_callback(openssl_thread_id);
+	CRYPTO_set_locking_callback(openssl_lock);
+}
+#endif
+
+/*
+ * Called on import, so it's kept to what can't wait. OpenSSL 1.1 and later
+ * load error strings on their own on first use and need no locking
+ * callbacks; the PRNG is seeded before the first key is generated.
+ */
 void
 initialize_crypto(void)
 {
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
 	/* needed so openssl's errors make sense to humans */
 	ERR_load_crypto_strings();
+
+	initialize_locking();
+#endif
+}
+
+/*
+ * Keys are shared the same way RSA structures are shared by
+ * EVP_PKEY_set1_RSA(), both capsules free their own reference
+ */
+static EVP_PKEY *
+pkey_ref(EVP_PKEY *key)
+{
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+	CRYPTO_add(&key->references, 1, CRYPTO_LOCK_EVP_PKEY);
+#else
+	EVP_PKEY_up_ref(key);
+#endif
+	return key;
+}
+
+/* public part of any key type, goes through SubjectPublicKeyInfo */
+static EVP_PKEY *
+pkey_public_dup(EVP_PKEY *key)
+{
+	unsigned char *der = NULL;
+	const unsigned char *p;
+	EVP_PKEY *public_key;
+	int len;
+
+	len = i2d_PUBKEY(key, &der);
+	if (len < 0)
+		return NULL;
+
+	p = der;
+	public_key = d2i_PUBKEY(NULL, &p, len);
+	OPENSSL_free(der);
+
+	return public_key;
+}
+
+const char *
+key_type_name(const struct ccn_pkey *key)
+{
+	switch (EVP_PKEY_base_id((const EVP_PKEY *) key)) {
+	case EVP_PKEY_RSA:
+		return "RSA";
+	case EVP_PKEY_EC:
+		return "EC";
+	default:
+		return "unknown";
+	}
 }
 
 int
-create_public_key_digest(RSA *private_key_rsa,
-		PyObject **py_public_key_digest, int *public_key_digest_len)
+create_public_key_digest(EVP_PKEY *key, PyObject **py_public_key_digest,
+		int *public_key_digest_len)
 {
 	unsigned int err;
 	unsigned char *public_key_der = NULL;
@@ -143,39 +271,22 @@ create_public_key_digest(RSA *private_key_rsa,
 	size_t key_digest_size;
 	PyObject *py_digest = NULL;
 	int r;
-	EVP_PKEY *public_key = NULL;
-	RSA *public_key_rsa = NULL;
 
-	assert(private_key_rsa);
+	assert(key);
 	assert(py_public_key_digest);
 
-	public_key = EVP_PKEY_new();
-	JUMP_IF_NULL(public_key, openssl_error);
-
-	public_key_rsa = RSAPublicKey_dup(private_key_rsa);
-	JUMP_IF_NULL(public_key_rsa, openssl_error);
-
-	r = EVP_PKEY_set1_RSA(public_key, public_key_rsa);
-	RSA_free(public_key_rsa);
-	public_key_rsa = NULL;
+	/* only the public part is encoded, even for a private key */
+	r = i2d_PUBKEY(key, &public_key_der);
 	JUMP_IF_NEG(r, openssl_error);
-
-	r = i2d_PUBKEY(public_key, &public_key_der);
-	EVP_PKEY_free(public_key);
-	public_key = NULL;
-	if (r < 0) {
-		free(public_key_der);
-		goto openssl_error;
-	}
 	der_len = r;
 
 	r = create_key_digest(public_key_der, der_len, &key_digest,
 			&key_digest_size);
-	free(public_key_der);
-	public_key_der = NULL;
+	OPENSSL_free(public_key_der);
 	JUMP_IF_NEG(r, error);
 
 	py_digest = PyBytes_FromStringAndSize((char *) key_digest, key_digest_size);
+	free(key_digest);
 	JUMP_IF_NULL(py_digest, error);
 
 	*py_public_key_digest = py_digest;
@@ -189,49 +300,32 @@ openssl_error:
 	PyErr_Format(g_PyExc_CCNKeyError, "Unable to generate digest from the key:"
 			" %s", ERR_reason_error_string(err));
 error:
-	if (public_key_rsa)
-		RSA_free(public_key_rsa);
-	if (public_key)
-		EVP_PKEY_free(public_key);
-	if (public_key_der)
-		free(public_key_der);
 	return -1;
 }
 
 int
-ccn_keypair_from_rsa(int public_only, RSA *private_key_rsa,
+ccn_keypair_from_pkey(int public_only, EVP_PKEY *key,
 		PyObject **py_private_key_ccn, PyObject **py_public_key_ccn)
 {
-	struct ccn_pkey *private_key = NULL, *public_key = NULL;
+	struct ccn_pkey *public_key = NULL;
 	PyObject *py_private_key = NULL, *py_public_key = NULL;
 	unsigned int err;
-	int r;
-	RSA *public_key_rsa;
 
 	if (!public_only && py_private_key_ccn) {
-		private_key = (struct ccn_pkey *) EVP_PKEY_new();
-		JUMP_IF_NULL(private_key, openssl_error);
-
-		py_private_key = CCNObject_New(PKEY_PRIV, private_key);
-		JUMP_IF_NULL(py_private_key, error);
-
-		r = EVP_PKEY_set1_RSA((EVP_PKEY*) private_key, private_key_rsa);
-		JUMP_IF_NEG(r, openssl_error);
+		py_private_key = CCNObject_New(PKEY_PRIV,
+				(struct ccn_pkey *) pkey_ref(key));
+		if (!py_private_key) {
+			EVP_PKEY_free(key);
+			goto error;
+		}
 	}
 
 	if (py_public_key_ccn) {
-		public_key = (struct ccn_pkey *) EVP_PKEY_new();
+		public_key = (struct ccn_pkey *) pkey_public_dup(key);
 		JUMP_IF_NULL(public_key, openssl_error);
 
 		py_public_key = CCNObject_New(PKEY_PUB, public_key);
 		JUMP_IF_NULL(py_public_key, error);
-
-		public_key_rsa = RSAPublicKey_dup(private_key_rsa);
-		JUMP_IF_NULL(public_key_rsa, openssl_error);
-
-		r = EVP_PKEY_set1_RSA((EVP_PKEY *) public_key, public_key_rsa);
-		RSA_free(public_key_rsa);
-		JUMP_IF_NULL(r, error);
 	}
 
 	if (py_private_key_ccn) {
@@ -252,8 +346,6 @@ error:
 	if (!py_public_key && public_key)
 		ccn_pubkey_free(public_key);
 	Py_XDECREF(py_public_key);
-	if (!py_private_key && private_key)
-		ccn_pubkey_free(private_key);
 	Py_XDECREF(py_private_key);
 	return -1;
 }
@@ -261,37 +353,16 @@ error:
 PyObject *
 _pyccn_privatekey_dup(const struct ccn_pkey *key)
 {
-	RSA *private_key_rsa;
-	PyObject *py_private_key = NULL;
-	struct ccn_pkey *private_key;
-	unsigned int err;
-	int r;
-
-	private_key = (struct ccn_pkey *) EVP_PKEY_new();
-	JUMP_IF_NULL(private_key, openssl_error);
-
-	py_private_key = CCNObject_New(PKEY_PRIV, private_key);
-	if (!py_private_key) {
-		EVP_PKEY_free((EVP_PKEY *) private_key);
-		goto error;
-	}
+	EVP_PKEY *private_key;
+	PyObject *py_private_key;
 
-	private_key_rsa = EVP_PKEY_get1_RSA((EVP_PKEY *) key);
-	JUMP_IF_NULL(private_key_rsa, openssl_error);
+	private_key = pkey_ref((EVP_PKEY *) key);
 
-	r = EVP_PKEY_set1_RSA((EVP_PKEY*) private_key, private_key_rsa);
-	RSA_free(private_key_rsa);
-	JUMP_IF_NEG(r, openssl_error);
+	py_private_key = CCNObject_New(PKEY_PRIV, (struct ccn_pkey *) private_key);
+	if (!py_private_key)
+		EVP_PKEY_free(private_key);
 
 	return py_private_key;
-
-openssl_error:
-	err = ERR_get_error();
-	PyErr_Format(g_PyExc_CCNKeyError, "Unable to generate keypair from the key:"
-			" %s", ERR_reason_error_string(err));
-error:
-	Py_XDECREF(py_private_key);
-	return NULL;
 }
 
 #if 0
@@ -328,38 +399,113 @@ generate_RSA_keypair(unsigned char** private_key_der, size_t *private_key_len,
 // Caller must free
 //
 
+static int
+keypair_from_generated(EVP_PKEY *key, PyObject **py_private_key_ccn,
+		PyObject **py_public_key_ccn, PyObject **py_public_key_digest,
+		int *public_key_digest_len)
+{
+	int r;
+
+	r = ccn_keypair_from_pkey(0, key, py_private_key_ccn, py_public_key_ccn);
+	if (r < 0)
+		return -1;
+
+	r = create_public_key_digest(key, py_public_key_digest,
+			public_key_digest_len);
+	if (r < 0) {
+		Py_CLEAR(*py_private_key_ccn);
+		Py_CLEAR(*py_public_key_ccn);
+		return -1;
+	}
+
+	return 0;
+}
+
 int
 generate_key(int length, PyObject **py_private_key_ccn,
 		PyObject **py_public_key_ccn, PyObject **py_public_key_digest,
 		int *public_key_digest_len)
 {
 	RSA *private_key_rsa;
+	EVP_PKEY *key;
+	unsigned int err;
 	int r;
 
+	Py_BEGIN_ALLOW_THREADS
 	seed_prng();
 	private_key_rsa = RSA_generate_key(length, 65537, NULL, NULL);
-	save_seed();
+	Py_END_ALLOW_THREADS
+	JUMP_IF_NULL(private_key_rsa, openssl_error);
 
-	if (!private_key_rsa) {
-		unsigned int err;
+	key = EVP_PKEY_new();
+	if (!key || !EVP_PKEY_assign_RSA(key, private_key_rsa)) {
+		RSA_free(private_key_rsa);
+		EVP_PKEY_free(key);
+		goto openssl_error;
+	}
 
-		err = ERR_get_error();
-		PyErr_Format(g_PyExc_CCNKeyError, "Unable to generate digest from the"
-				" key: %s", ERR_reason_error_string(err));
+	r = keypair_from_generated(key, py_private_key_ccn, py_public_key_ccn,
+			py_public_key_digest, public_key_digest_len);
+	EVP_PKEY_free(key);
+
+	return r;
+
+openssl_error:
+	err = ERR_get_error();
+	PyErr_Format(g_PyExc_CCNKeyError, "Unable to generate the key: %s",
+			ERR_reason_error_string(err));
+	return -1;
+}
+
+int
+generate_key_ec(const char *curve, PyObject **py_private_key_ccn,
+		PyObject **py_public_key_ccn, PyObject **py_public_key_digest,
+		int *public_key_digest_len)
+{
+	EC_KEY *private_key_ec = NULL;
+	EVP_PKEY *key;
+	unsigned int err;
+	int nid, r;
+
+	nid = OBJ_sn2nid(curve);
+	if (nid == NID_undef)
+		nid = OBJ_txt2nid(curve);
+	if (nid == NID_undef) {
+		PyErr_Format(PyExc_ValueError, "Unknown curve: %s", curve);
 		return -1;
 	}
 
-	r = ccn_keypair_from_rsa(0, private_key_rsa, py_private_key_ccn,
-			py_public_key_ccn);
-	if (r < 0)
-		return -1;
+	private_key_ec = EC_KEY_new_by_curve_name(nid);
+	JUMP_IF_NULL(private_key_ec, openssl_error);
 
-	r = create_public_key_digest(private_key_rsa, py_public_key_digest,
-			public_key_digest_len);
-	if (r < 0)
-		return -1;
+	/* name the curve in the encoding, instead of listing its parameters */
+	EC_KEY_set_asn1_flag(private_key_ec, OPENSSL_EC_NAMED_CURVE);
 
-	return 0;
+	Py_BEGIN_ALLOW_THREADS
+	seed_prng();
+	r = EC_KEY_generate_key(private_key_ec);
+	Py_END_ALLOW_THREADS
+	if (!r)
+		goto openssl_error;
+
+	key = EVP_PKEY_new();
+	if (!key || !EVP_PKEY_assign_EC_KEY(key, private_key_ec)) {
+		EVP_PKEY_free(key);
+		goto openssl_error;
+	}
+
+	r = keypair_from_generated(key, py_private_key_ccn, py_public_key_ccn,
+			py_public_key_digest, public_key_digest_len);
+	EVP_PKEY_free(key);
+
+	return r;
+
+openssl_error:
+	err = ERR_get_error();
+	PyErr_Format(g_PyExc_CCNKeyError, "Unable to generate the key: %s",
+			ERR_reason_error_string(err));
+	EC_KEY_free(private_key_ec);
+	return -1;
 }
 
 #if 0
@@ -374,6 +520,128 @@ generate_keypair(int length, struct keypair** KP)
 }
 #endif
 
+/*
+ * RSA keys are written in their traditional (PKCS#1) form, as they always
+ * were, other types in their own traditional form if they have one
+ */
+static int
+pem_write_private_bio(BIO *bio, EVP_PKEY *key)
+{
+	RSA *key_rsa;
+	EC_KEY *key_ec;
+	int r;
+
+	switch (EVP_PKEY_base_id(key)) {
+	case EVP_PKEY_RSA:
+		key_rsa = EVP_PKEY_get1_RSA(key);
+		if (!key_rsa)
+			return 0;
+		r = PEM_write_bio_RSAPrivateKey(bio, key_rsa, NULL, NULL, 0, NULL,
+				NULL);
+		RSA_free(key_rsa);
+		return r;
+	case EVP_PKEY_EC:
+		key_ec = EVP_PKEY_get1_EC_KEY(key);
+		if (!key_ec)
+			return 0;
+		r = PEM_write_bio_ECPrivateKey(bio, key_ec, NULL, NULL, 0, NULL, NULL);
+		EC_KEY_free(key_ec);
+		return r;
+	default:
+		return PEM_write_bio_PrivateKey(bio, key, NULL, NULL, 0, NULL, NULL);
+	}
+}
+
+static int
+pem_write_public_bio(BIO *bio, EVP_PKEY *key)
+{
+	RSA *key_rsa;
+	int r;
+
+	if (EVP_PKEY_base_id(key) != EVP_PKEY_RSA)
+		return PEM_write_bio_PUBKEY(bio, key);
+
+	key_rsa = EVP_PKEY_get1_RSA(key);
+	if (!key_rsa)
+		return 0;
+	r = PEM_write_bio_RSAPublicKey(bio, key_rsa);
+	RSA_free(key_rsa);
+
+	return r;
+}
+
+/*
+ * Reads a single PEM block, the type of key is decided by its name. It
+ * doesn't touch python objects, so it can run without the GIL; the reason
+ * of a failure is left in errbuf.
+ */
+static EVP_PKEY *
+pem_read_key_bio(BIO *bio, int *public_only, char *errbuf, size_t errlen)
+{
+	char *name = NULL, *header = NULL;
+	unsigned char *data = NULL;
+	const unsigned char *p;
+	long len;
+	EVP_PKEY *key = NULL;
+	RSA *key_rsa;
+	unsigned long err;
+
+	if (!PEM_read_bio(bio, &name, &header, &data, &len))
+		goto openssl_error;
+
+	p = data;
+	if (!strcmp(name, PEM_STRING_RSA)) {
+		*public_only = 0;
+		key = d2i_PrivateKey(EVP_PKEY_RSA, NULL, &p, len);
+	} else if (!strcmp(name, PEM_STRING_ECPRIVATEKEY)) {
+		*public_only = 0;
+		key = d2i_PrivateKey(EVP_PKEY_EC, NULL, &p, len);
+	} else if (!strcmp(name, PEM_STRING_PKCS8INF)) {
+		*public_only = 0;
+		key = d2i_AutoPrivateKey(NULL, &p, len);
+	} else if (!strcmp(name, PEM_STRING_PUBLIC)) {
+		*public_only = 1;
+		key = d2i_PUBKEY(NULL, &p, len);
+	} else if (!strcmp(name, PEM_STRING_RSA_PUBLIC)) {
+		*public_only = 1;
+		key_rsa = d2i_RSAPublicKey(NULL, &p, len);
+		if (key_rsa) {
+			key = EVP_PKEY_new();
+			if (!key || !EVP_PKEY_assign_RSA(key, key_rsa)) {
+				EVP_PKEY_free(key);
+				RSA_free(key_rsa);
+				key = NULL;
+			}
+		}
+	} else {
+		snprintf(errbuf, errlen, "Unsupported PEM type: %s", name);
+		goto error;
+	}
+
+	if (!key)
+		goto openssl_error;
+
+	OPENSSL_free(name);
+	OPENSSL_free(header);
+	OPENSSL_free(data);
+
+	return key;
+
+openssl_error:
+	err = ERR_get_error();
+	{
+		char buf[256];
+
+		ERR_error_string_n(err, buf, sizeof(buf));
+		snprintf(errbuf, errlen, "Unable to read key: %s", buf);
+	}
+error:
+	OPENSSL_free(name);
+	OPENSSL_free(header);
+	OPENSSL_free(data);
+	return NULL;
+}
+
 //
 // Writes without encryption/password!
 //
@@ -381,62 +649,55 @@ generate_keypair(int length, struct keypair** KP)
 int
 write_key_pem_private(FILE *fp, struct ccn_pkey *private_key_ccn)
 {
-	RSA *private_key_rsa;
+	BIO *bio;
 	unsigned long err;
+	int r;
 
-	private_key_rsa = EVP_PKEY_get1_RSA((EVP_PKEY *) private_key_ccn);
-	if (!private_key_rsa) {
-		err = ERR_get_error();
-		PyErr_Format(g_PyExc_CCNKeyError, "Unable to obtain EVP PKEY: %s",
-				ERR_reason_error_string(err));
-		return -1;
-	}
-
-	if (!PEM_write_RSAPrivateKey(fp, private_key_rsa, NULL, NULL, 0, NULL, NULL)) {
-		err = ERR_get_error();
-		RSA_free(private_key_rsa);
-		PyErr_Format(g_PyExc_CCNKeyError, "Unable to write Private Key: %s",
-				ERR_reason_error_string(err));
-		return -1;
-	}
+	bio = BIO_new_fp(fp, BIO_NOCLOSE);
+	JUMP_IF_NULL(bio, openssl_error);
 
-	//PEM_write_RSAPublicKey(stderr, private_key_rsa);
-	RSA_free(private_key_rsa);
+	r = pem_write_private_bio(bio, (EVP_PKEY *) private_key_ccn);
+	BIO_free(bio);
+	if (!r)
+		goto openssl_error;
 
 	return 0;
+
+openssl_error:
+	err = ERR_get_error();
+	PyErr_Format(g_PyExc_CCNKeyError, "Unable to write Private Key: %s",
+			ERR_reason_error_string(err));
+	return -1;
 }
 
 int
-write_key_pem_public(FILE *fp, struct ccn_pkey *private_key_ccn)
+write_key_pem_public(FILE *fp, struct ccn_pkey *public_key_ccn)
 {
-	RSA *private_key_rsa;
+	BIO *bio;
 	unsigned long err;
+	int r;
 
-	private_key_rsa = EVP_PKEY_get1_RSA((EVP_PKEY*) private_key_ccn);
-	if (!private_key_rsa) {
-		err = ERR_get_error();
-		PyErr_Format(g_PyExc_CCNKeyError, "Unable to obtain EVP PKEY: %s",
-				ERR_reason_error_string(err));
-		return -1;
-	}
+	bio = BIO_new_fp(fp, BIO_NOCLOSE);
+	JUMP_IF_NULL(bio, openssl_error);
 
-	if (!PEM_write_RSAPublicKey(fp, private_key_rsa)) {
-		err = ERR_get_error();
-		RSA_free(private_key_rsa);
-		PyErr_Format(g_PyExc_CCNKeyError, "Unable to write Public Key: %s",
-				ERR_reason_error_string(err));
-		return -1;
-	}
-	RSA_free(private_key_rsa);
+	r = pem_write_public_bio(bio, (EVP_PKEY *) public_key_ccn);
+	BIO_free(bio);
+	if (!r)
+		goto openssl_error;
 
 	return 0;
+
+openssl_error:
+	err = ERR_get_error();
+	PyErr_Format(g_PyExc_CCNKeyError, "Unable to write Public Key: %s",
+			ERR_reason_error_string(err));
+	return -1;
 }
 
 PyObject *
 get_key_pem_private(const struct ccn_pkey *private_key_ccn)
 {
 	unsigned long err;
-	RSA *private_key_rsa = NULL;
 	BIO *bio;
 	BUF_MEM *bufmem;
 	int r;
@@ -445,13 +706,9 @@ get_key_pem_private(const struct ccn_pkey *private_key_ccn)
 	bio = BIO_new(BIO_s_mem());
 	JUMP_IF_NULL(bio, openssl_error);
 
-	private_key_rsa = EVP_PKEY_get1_RSA((EVP_PKEY *) private_key_ccn);
-	JUMP_IF_NULL(private_key_rsa, openssl_error);
-
-	r = PEM_write_bio_RSAPrivateKey(bio, private_key_rsa, NULL, NULL, 0, NULL,
-			NULL);
-	RSA_free(private_key_rsa);
-	private_key_rsa = NULL;
+	Py_BEGIN_ALLOW_THREADS
+	r = pem_write_private_bio(bio, (EVP_PKEY *) private_key_ccn);
+	Py_END_ALLOW_THREADS
 	if (!r)
 		goto openssl_error;
 
@@ -467,7 +724,6 @@ openssl_error:
 	err = ERR_get_error();
 	PyErr_Format(g_PyExc_CCNKeyError, "Unable to obtain PEM: %s",
 			ERR_reason_error_string(err));
-	RSA_free(private_key_rsa);
 	BIO_free(bio);
 	return NULL;
 }
@@ -476,7 +732,6 @@ PyObject *
 get_key_pem_public(const struct ccn_pkey *key_ccn)
 {
 	unsigned long err;
-	RSA *public_key_rsa = NULL;
 	BIO *bio;
 	BUF_MEM *bufmem;
 	int r;
@@ -485,12 +740,9 @@ get_key_pem_public(const struct ccn_pkey *key_ccn)
 	bio = BIO_new(BIO_s_mem());
 	JUMP_IF_NULL(bio, openssl_error);
 
-	public_key_rsa = EVP_PKEY_get1_RSA((EVP_PKEY *) key_ccn);
-	JUMP_IF_NULL(public_key_rsa, openssl_error);
-
-	r = PEM_write_bio_RSAPublicKey(bio, public_key_rsa);
-	RSA_free(public_key_rsa);
-	public_key_rsa = NULL;
+	Py_BEGIN_ALLOW_THREADS
+	r = pem_write_public_bio(bio, (EVP_PKEY *) key_ccn);
+	Py_END_ALLOW_THREADS
 	if (!r)
 		goto openssl_error;
 
@@ -506,7 +758,6 @@ openssl_error:
 	err = ERR_get_error();
 	PyErr_Format(g_PyExc_CCNKeyError, "Unable to obtain PEM: %s",
 			ERR_reason_error_string(err));
-	RSA_free(public_key_rsa);
 	BIO_free(bio);
 	return NULL;
 }
@@ -515,23 +766,20 @@ PyObject *
 get_key_der_private(struct ccn_pkey *private_key_ccn)
 {
 	PyObject *result;
-	RSA *private_key_rsa;
 	unsigned long err;
 	unsigned char *private_key_der = NULL;
 	int der_len;
 
 	assert(private_key_ccn);
 
-	private_key_rsa = EVP_PKEY_get1_RSA((EVP_PKEY *) private_key_ccn);
-	JUMP_IF_NULL(private_key_rsa, openssl_error);
-
-	der_len = i2d_RSAPrivateKey(private_key_rsa, &private_key_der);
+	/* PKCS#1 for RSA, RFC 5915 for EC */
+	Py_BEGIN_ALLOW_THREADS
+	der_len = i2d_PrivateKey((EVP_PKEY *) private_key_ccn, &private_key_der);
+	Py_END_ALLOW_THREADS
 	JUMP_IF_NEG(der_len, openssl_error);
 
 	result = PyBytes_FromStringAndSize((char *) private_key_der, der_len);
-	RSA_free(private_key_rsa);
-	private_key_rsa = NULL;
-	JUMP_IF_NULL(result, error);
+	OPENSSL_free(private_key_der);
 
 	return result;
 
@@ -539,8 +787,6 @@ openssl_error:
 	err = ERR_get_error();
 	PyErr_Format(g_PyExc_CCNKeyError, "Unable to write Private Key: %s",
 			ERR_reason_error_string(err));
-error:
-	RSA_free(private_key_rsa);
 	return NULL;
 }
 
@@ -548,23 +794,17 @@ PyObject *
 get_key_der_public(struct ccn_pkey *public_key_ccn)
 {
 	PyObject *result;
-	RSA *public_key_rsa;
 	unsigned long err;
 	unsigned char *public_key_der = NULL;
 	int der_len;
 
-	public_key_rsa = EVP_PKEY_get1_RSA((EVP_PKEY *) public_key_ccn);
-	JUMP_IF_NULL(public_key_rsa, openssl_error);
-
-	//i2d_RSAPublicKey() is also valid, but openssl doesn't
-	//seem to understand it
-	der_len = i2d_RSA_PUBKEY(public_key_rsa, &public_key_der);
+	Py_BEGIN_ALLOW_THREADS
+	der_len = i2d_PUBKEY((EVP_PKEY *) public_key_ccn, &public_key_der);
+	Py_END_ALLOW_THREADS
 	JUMP_IF_NEG(der_len, openssl_error);
 
 	result = PyBytes_FromStringAndSize((char *) public_key_der, der_len);
-	RSA_free(public_key_rsa);
-	public_key_rsa = NULL;
-	JUMP_IF_NULL(result, error);
+	OPENSSL_free(public_key_der);
 
 	return result;
 
@@ -572,11 +812,32 @@ openssl_error:
 	err = ERR_get_error();
 	PyErr_Format(g_PyExc_CCNKeyError, "Unable to write Public Key: %s",
 			ERR_reason_error_string(err));
-error:
-	RSA_free(public_key_rsa);
 	return NULL;
 }
 
+static int
+keypair_from_read(int public_only, EVP_PKEY *key,
+		PyObject **py_private_key_ccn, PyObject **py_public_key_ccn,
+		PyObject **py_public_key_digest, int *public_key_digest_len)
+{
+	int r;
+
+	r = ccn_keypair_from_pkey(public_only, key, py_private_key_ccn,
+			py_public_key_ccn);
+	if (r < 0)
+		return -1;
+
+	r = create_public_key_digest(key, py_public_key_digest,
+			public_key_digest_len);
+	if (r < 0) {
+		Py_CLEAR(*py_private_key_ccn);
+		Py_CLEAR(*py_public_key_ccn);
+		return -1;
+	}
+
+	return 0;
+}
+
 //
 // Reads without decryption
 //
@@ -586,71 +847,33 @@ read_key_pem(FILE *fp, PyObject **py_private_key_ccn,
 		PyObject **py_public_key_ccn, PyObject **py_public_key_digest,
 		int *public_key_digest_len)
 {
-	RSA *private_key_rsa = NULL;
-	PyObject *py_private_key = NULL, *py_public_key = NULL;
-	unsigned long err, reason;
-	fpos_t fpos;
-	int r;
-	int public_only;
-
-	r = fgetpos(fp, &fpos);
-	JUMP_IF_NEG(r, errno_error);
-
-	private_key_rsa = PEM_read_RSAPrivateKey(fp, NULL, NULL, NULL);
-	if (private_key_rsa) {
-		public_only = 0;
-		goto success;
-	}
-
-	err = ERR_get_error();
-	reason = ERR_GET_REASON(err);
-
-	/* 108 was meaning that start line isn't recognized */
-	if (reason == 108) {
-		r = fsetpos(fp, &fpos);
-		JUMP_IF_NEG(r, errno_error);
-
-		private_key_rsa = PEM_read_RSAPublicKey(fp, NULL, NULL, NULL);
-		if (private_key_rsa) {
-			public_only = 1;
-			goto success;
-		}
+	EVP_PKEY *key;
+	BIO *bio;
+	unsigned long err;
+	char errbuf[300];
+	int r, public_only;
 
+	bio = BIO_new_fp(fp, BIO_NOCLOSE);
+	if (!bio) {
 		err = ERR_get_error();
-		reason = ERR_GET_REASON(err);
+		PyErr_Format(g_PyExc_CCNKeyError, "Unable to read key: %s",
+				ERR_reason_error_string(err));
+		return -1;
 	}
 
-	{
-		char buf[256];
-
-		ERR_error_string_n(err, buf, sizeof(buf));
-		PyErr_Format(g_PyExc_CCNKeyError, "Unable to read Private Key: %s",
-				buf);
-		goto error;
+	/* fp belongs to a python file object, so this one keeps the GIL */
+	key = pem_read_key_bio(bio, &public_only, errbuf, sizeof(errbuf));
+	BIO_free(bio);
+	if (!key) {
+		PyErr_SetString(g_PyExc_CCNKeyError, errbuf);
+		return -1;
 	}
 
-success:
-
-	r = ccn_keypair_from_rsa(public_only, private_key_rsa, py_private_key_ccn,
-			py_public_key_ccn);
-	JUMP_IF_NEG(r, error);
-
-	r = create_public_key_digest(private_key_rsa, py_public_key_digest,
-			public_key_digest_len);
-	JUMP_IF_NEG(r, error);
-
-	RSA_free(private_key_rsa);
-
-	return 0;
+	r = keypair_from_read(public_only, key, py_private_key_ccn,
+			py_public_key_ccn, py_public_key_digest, public_key_digest_len);
+	EVP_PKEY_free(key);
 
-errno_error:
-	PyErr_SetFromErrno(PyExc_IOError);
-error:
-	Py_XDECREF(py_private_key);
-	Py_XDECREF(py_public_key);
-	if (private_key_rsa)
-		RSA_free(private_key_rsa);
-	return -1;
+	return r;
 }
 
 int
@@ -660,42 +883,46 @@ put_key_pem(int is_public_only, PyObject *py_key_pem,
 {
 	unsigned char *key_pem;
 	Py_ssize_t pem_len;
-	RSA *key_rsa = NULL;
-	BIO *bio = NULL;
-	int r;
+	EVP_PKEY *key;
+	BIO *bio;
+	char errbuf[300];
+	int r, public_only;
 	unsigned long err;
 
 	r = PyBytes_AsStringAndSize(py_key_pem, (char **) &key_pem, &pem_len);
-	JUMP_IF_NEG(r, error);
+	if (r < 0)
+		return -1;
 
 	bio = BIO_new_mem_buf(key_pem, pem_len);
-	JUMP_IF_NULL(bio, openssl_error);
-
-	if (is_public_only)
-		key_rsa = PEM_read_bio_RSAPublicKey(bio, NULL, NULL, NULL);
-	else
-		key_rsa = PEM_read_bio_RSAPrivateKey(bio, NULL, NULL, NULL);
-	JUMP_IF_NULL(key_rsa, openssl_error);
-
-	r = ccn_keypair_from_rsa(is_public_only, key_rsa, py_private_key_ccn,
-			py_public_key_ccn);
-	JUMP_IF_NEG(r, error);
+	if (!bio) {
+		err = ERR_get_error();
+		PyErr_Format(g_PyExc_CCNKeyError, "Unable to parse key: %s",
+				ERR_reason_error_string(err));
+		return -1;
+	}
 
-	r = create_public_key_digest(key_rsa, py_public_key_digest, NULL);
-	JUMP_IF_NEG(r, error);
+	/* py_key_pem is immutable and the caller holds a reference */
+	Py_BEGIN_ALLOW_THREADS
+	key = pem_read_key_bio(bio, &public_only, errbuf, sizeof(errbuf));
+	BIO_free(bio);
+	Py_END_ALLOW_THREADS
+	if (!key) {
+		PyErr_SetString(g_PyExc_CCNKeyError, errbuf);
+		return -1;
+	}
 
-	RSA_free(key_rsa);
+	if (public_only && !is_public_only) {
+		PyErr_SetString(g_PyExc_CCNKeyError, "Unable to parse key: not a"
+				" private key");
+		EVP_PKEY_free(key);
+		return -1;
+	}
 
-	return 0;
+	r = keypair_from_read(is_public_only, key, py_private_key_ccn,
+			py_public_key_ccn, py_public_key_digest, NULL);
+	EVP_PKEY_free(key);
 
-openssl_error:
-	err = ERR_get_error();
-	PyErr_Format(g_PyExc_CCNKeyError, "Unable to parse key: %s",
-			ERR_reason_error_string(err));
-error:
-	RSA_free(key_rsa);
-	BIO_free(bio);
-	return -1;
+	return r;
 }
 
 int
@@ -703,49 +930,41 @@ put_key_der(int is_public_only, PyObject *py_key_der,
 		PyObject **py_private_key_ccn, PyObject **py_public_key_ccn,
 		PyObject **py_public_key_digest, int *public_key_digest_len)
 {
-	RSA *key_rsa = NULL;
+	EVP_PKEY *key;
 	const unsigned char *key_der;
 	Py_ssize_t der_len;
 	int r;
 	unsigned long err;
 
 	r = PyBytes_AsStringAndSize(py_key_der, (char **) &key_der, &der_len);
-	JUMP_IF_NEG(r, error);
+	if (r < 0)
+		return -1;
 
+	/* py_key_der is immutable and the caller holds a reference */
+	Py_BEGIN_ALLOW_THREADS
 	if (is_public_only)
-		key_rsa = d2i_RSA_PUBKEY(NULL, &key_der, der_len);
+		key = d2i_PUBKEY(NULL, &key_der, der_len);
 	else
-		key_rsa = d2i_RSAPrivateKey(NULL, &key_der, der_len);
+		key = d2i_AutoPrivateKey(NULL, &key_der, der_len);
+	Py_END_ALLOW_THREADS
 
 	//above changes the key_der, so we set it to NULL for safety to not use it
 	key_der = NULL;
-	JUMP_IF_NULL(key_rsa, openssl_error);
-
-	r = ccn_keypair_from_rsa(is_public_only, key_rsa, py_private_key_ccn,
-			py_public_key_ccn);
-	JUMP_IF_NEG(r, error);
-
-	r = create_public_key_digest(key_rsa, py_public_key_digest,
-			public_key_digest_len);
-	JUMP_IF_NEG(r, error);
-
-	RSA_free(key_rsa);
-
-	return 0;
-
-openssl_error:
-	err = ERR_get_error();
-	{
+	if (!key) {
 		char buf[256];
 
+		err = ERR_get_error();
 		ERR_error_string_n(err, buf, sizeof(buf));
 		PyErr_Format(g_PyExc_CCNKeyError, "Unable to read Private Key: %s",
 				buf);
+		return -1;
 	}
 
-error:
-	RSA_free(key_rsa);
-	return -1;
+	r = keypair_from_read(is_public_only, key, py_private_key_ccn,
+			py_public_key_ccn, py_public_key_digest, public_key_digest_len);
+	EVP_PKEY_free(key);
+
+	return r;
 }
 
 #if 0
@@ -812,20 +1031,3 @@ get_ASN_public_key(unsigned char** public_key_der, int* public_key_der_len, stru
 	i2d_RSAPublicKey(private_key_rsa, &pub);
 	return 0;
 }
-
-RSA *
-ccn_key_to_rsa(struct ccn_pkey *key_ccn)
-{
-	RSA *private_key_rsa;
-	unsigned int err;
-
-	private_key_rsa = EVP_PKEY_get1_RSA((EVP_PKEY *) key_ccn);
-	if (!private_key_rsa) {
-		err = ERR_get_error();
-		PyErr_Format(g_PyExc_CCNKeyError, "Error obtaining private key: %s",
-				ERR_reason_error_string(err));
-		return NULL;
-	}
-
-	return private_key_rsa;
-}
\ No newline at end of file
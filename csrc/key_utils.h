@@ -13,6 +13,7 @@
 // On MacOS X, need to have the latest version from MacPorts
 // and add /opt/local/include as an include path
 #  include <openssl/rsa.h>
+#  include <openssl/ec.h>
 #  include <openssl/pem.h>
 #  include <openssl/evp.h>
 #  include <openssl/sha.h>
@@ -35,15 +36,19 @@ struct keypair {
 };
 
 void initialize_crypto(void);
-int create_public_key_digest(RSA *private_key_rsa,
-		PyObject **py_public_key_digest, int *public_key_digest_len);
-int ccn_keypair_from_rsa(int public_only, RSA *private_key_rsa,
+const char *key_type_name(const struct ccn_pkey *key);
+int create_public_key_digest(EVP_PKEY *key, PyObject **py_public_key_digest,
+		int *public_key_digest_len);
+int ccn_keypair_from_pkey(int public_only, EVP_PKEY *key,
 		PyObject **py_private_key_ccn,
 		PyObject **py_public_key_ccn);
 PyObject *_pyccn_privatekey_dup(const struct ccn_pkey *key);
 int generate_key(int length, PyObject **private_key_ccn,
 		PyObject **public_key_ccn, PyObject ** public_key_digest,
 		int *public_key_digest_len);
+int generate_key_ec(const char *curve, PyObject **private_key_ccn,
+		PyObject **public_key_ccn, PyObject **public_key_digest,
+		int *public_key_digest_len);
 //int generate_keypair(int length, struct keypair** KP);
 
 // We use "PEM" to make things "readable" for now
@@ -70,6 +75,5 @@ int release_keypair(struct keypair** KP);
 int build_keylocator_from_key(struct ccn_charbuf** keylocator, struct ccn_pkey* key);
 
 int get_ASN_public_key(unsigned char** public_key_der, int* public_key_der_len, struct ccn_pkey* private_key);
-RSA *ccn_key_to_rsa(struct ccn_pkey *key_ccn);
 
 #endif /* _KEY_UTILS_H_ */
@@ -0,0 +1,466 @@
+/*
+ * Copyright (c) 2026, Regents of the University of California
+ * BSD license, See the COPYING file for more information
+ */
+
+/*
+ * Aggregated (Merkle hash tree) signatures.
+ *
+ * A batch of n ContentObjects is signed with one public key operation. The
+ * leaves are SHA256 digests of what a regular signature covers (Name,
+ * SignedInfo and Content), every internal node is the digest of its two
+ * children and only the root is signed. All objects carry the same
+ * SignatureBits, and each one its path to the root in the Witness, laid out
+ * as in CCNx: a DER DigestInfo with the MHT OID, whose digest is the DER
+ * MerklePath (node number, then sibling digests from the root down).
+ *
+ * Nodes are numbered as in a heap: the root is 1, children of k are 2k and
+ * 2k + 1, and the n leaves are nodes n .. 2n - 1.
+ */
+
+#include <ccn/ccn.h>
+
+#include <openssl/evp.h>
+#include <openssl/sha.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "merkle.h"
+
+#define HASHLEN SHA256_DIGEST_LENGTH
+
+#define DER_INTEGER 0x02
+#define DER_OCTET_STRING 0x04
+#define DER_OID 0x06
+#define DER_SEQUENCE 0x30
+
+/* 1.2.840.113550.11.1.2.2 - Merkle hash tree with SHA256 */
+static const unsigned char mht_oid[] = {
+	0x2a, 0x86, 0x48, 0x86, 0xf7, 0x0e, 0x0b, 0x01, 0x02, 0x02
+};
+
+/* each sibling in the path is an OCTET STRING with the digest */
+#define PATH_ENTRY_LEN (2 + HASHLEN)
+
+static void
+hash_pair(const unsigned char *left, const unsigned char *right,
+		unsigned char *result)
+{
+	SHA256_CTX ctx;
+
+	SHA256_Init(&ctx);
+	SHA256_Update(&ctx, left, HASHLEN);
+	SHA256_Update(&ctx, right, HASHLEN);
+	SHA256_Final(result, &ctx);
+}
+
+static int
+depth(size_t node)
+{
+	int d = 0;
+
+	while (node > 1) {
+		node >>= 1;
+		d++;
+	}
+
+	return d;
+}
+
+static size_t
+der_len_size(size_t len)
+{
+	size_t n = 1;
+
+	if (len < 0x80)
+		return 1;
+
+	while (len) {
+		len >>= 8;
+		n++;
+	}
+
+	return n;
+}
+
+static int
+der_append_header(struct ccn_charbuf *c, unsigned char tag, size_t len)
+{
+	unsigned char hdr[2 + sizeof(size_t)];
+	size_t n, i;
+
+	hdr[0] = tag;
+	n = der_len_size(len);
+	if (n == 1)
+		hdr[1] = (unsigned char) len;
+	else {
+		hdr[1] = 0x80 | (n - 1);
+		for (i = n; i > 1; i--, len >>= 8)
+			hdr[i] = len & 0xff;
+	}
+
+	return ccn_charbuf_append(c, hdr, 1 + n);
+}
+
+/* the node number as a positive DER INTEGER */
+static size_t
+der_node(size_t node, unsigned char *buf)
+{
+	unsigned char tmp[sizeof(size_t) + 1];
+	size_t n = 0;
+
+	do {
+		tmp[n++] = node & 0xff;
+		node >>= 8;
+	} while (node);
+
+	if (tmp[n - 1] & 0x80)
+		tmp[n++] = 0;
+
+	for (node = 0; node < n; node++)
+		buf[node] = tmp[n - 1 - node];
+
+	return n;
+}
+
+static int
+append_witness(struct ccn_charbuf *c, const unsigned char *tree, size_t leaf)
+{
+	unsigned char integer[sizeof(size_t) + 1];
+	size_t integer_len, hashes_len, path_len, mp_len, alg_len, info_len;
+	size_t sibling;
+	int d, j;
+
+	d = depth(leaf);
+	integer_len = der_node(leaf, integer);
+	hashes_len = d * PATH_ENTRY_LEN;
+	path_len = 1 + der_len_size(integer_len) + integer_len +
+			1 + der_len_size(hashes_len) + hashes_len;
+	mp_len = 1 + der_len_size(path_len) + path_len;
+	alg_len = 2 + sizeof(mht_oid) + 2;
+	info_len = 1 + der_len_size(alg_len) + alg_len +
+			1 + der_len_size(mp_len) + mp_len;
+
+	/* DigestInfo */
+	if (der_append_header(c, DER_SEQUENCE, info_len) < 0)
+		return -1;
+
+	/* AlgorithmIdentifier */
+	if (der_append_header(c, DER_SEQUENCE, alg_len) < 0 ||
+			der_append_header(c, DER_OID, sizeof(mht_oid)) < 0 ||
+			ccn_charbuf_append(c, mht_oid, sizeof(mht_oid)) < 0 ||
+			ccn_charbuf_append(c, "\x05\x00", 2) < 0)
+		return -1;
+
+	/* MerklePath in the digest */
+	if (der_append_header(c, DER_OCTET_STRING, mp_len) < 0 ||
+			der_append_header(c, DER_SEQUENCE, path_len) < 0 ||
+			der_append_header(c, DER_INTEGER, integer_len) < 0 ||
+			ccn_charbuf_append(c, integer, integer_len) < 0 ||
+			der_append_header(c, DER_SEQUENCE, hashes_len) < 0)
+		return -1;
+
+	/* siblings of the leaf's ancestors, starting just below the root */
+	for (j = 1; j <= d; j++) {
+		sibling = (leaf >> (d - j)) ^ 1;
+		if (der_append_header(c, DER_OCTET_STRING, HASHLEN) < 0 ||
+				ccn_charbuf_append(c, tree + sibling * HASHLEN, HASHLEN) < 0)
+			return -1;
+	}
+
+	return 0;
+}
+
+/* Name, SignedInfo and Content, the part covered by the signature */
+static int
+encode_signed_part(struct ccn_charbuf *c, const struct merkle_leaf *leaf)
+{
+	if (ccn_charbuf_append_charbuf(c, leaf->name) < 0 ||
+			ccn_charbuf_append_charbuf(c, leaf->signed_info) < 0 ||
+			ccnb_append_tagged_blob(c, CCN_DTAG_Content, leaf->content,
+			leaf->content_len) < 0)
+		return -1;
+
+	return 0;
+}
+
+static int
+sign_root(const unsigned char *root, const struct ccn_pkey *private_key,
+		unsigned char **sig, unsigned int *sig_len)
+{
+	EVP_PKEY *pkey = (EVP_PKEY *) private_key;
+	EVP_MD_CTX *ctx;
+	int r;
+
+	*sig = malloc(EVP_PKEY_size(pkey));
+	if (!*sig)
+		return MERKLE_ENOMEM;
+
+	ctx = EVP_MD_CTX_create();
+	if (!ctx) {
+		free(*sig);
+		return MERKLE_ENOMEM;
+	}
+
+	r = EVP_SignInit_ex(ctx, EVP_sha256(), NULL) &&
+			EVP_SignUpdate(ctx, root, HASHLEN) &&
+			EVP_SignFinal(ctx, *sig, sig_len, pkey);
+	EVP_MD_CTX_destroy(ctx);
+
+	if (!r) {
+		free(*sig);
+		return MERKLE_ESIGN;
+	}
+
+	return MERKLE_OK;
+}
+
+/*
+ * On success results holds n new ContentObjects, otherwise it's left
+ * untouched
+ */
+int
+merkle_encode_ContentObjects(struct ccn_charbuf **results,
+		const struct merkle_leaf *leaves, size_t n,
+		const struct ccn_pkey *private_key)
+{
+	struct ccn_charbuf **objects = NULL, *witness = NULL, *co;
+	unsigned char *tree = NULL, *sig = NULL;
+	unsigned int sig_len;
+	size_t i, k;
+	int r;
+
+	if (n == 0 || n > MERKLE_MAX_LEAVES)
+		return MERKLE_EINVAL;
+
+	r = MERKLE_ENOMEM;
+	objects = calloc(n, sizeof(*objects));
+	tree = malloc(2 * n * HASHLEN);
+	witness = ccn_charbuf_create();
+	if (!objects || !tree || !witness)
+		goto out;
+
+	/* leaves, the signed part is kept to be wrapped later */
+	for (i = 0; i < n; i++) {
+		objects[i] = ccn_charbuf_create();
+		if (!objects[i] || encode_signed_part(objects[i], &leaves[i]) < 0)
+			goto out;
+
+		SHA256(objects[i]->buf, objects[i]->length, tree + (n + i) * HASHLEN);
+	}
+
+	for (k = n - 1; k >= 1; k--)
+		hash_pair(tree + 2 * k * HASHLEN, tree + (2 * k + 1) * HASHLEN,
+				tree + k * HASHLEN);
+
+	r = sign_root(tree + HASHLEN, private_key, &sig, &sig_len);
+	if (r < 0) {
+		sig = NULL;
+		goto out;
+	}
+
+	r = MERKLE_ENOMEM;
+	for (i = 0; i < n; i++) {
+		witness->length = 0;
+		if (append_witness(witness, tree, n + i) < 0)
+			goto out;
+
+		co = ccn_charbuf_create();
+		if (!co)
+			goto out;
+
+		if (ccn_charbuf_append_tt(co, CCN_DTAG_ContentObject, CCN_DTAG) < 0 ||
+				ccn_charbuf_append_tt(co, CCN_DTAG_Signature, CCN_DTAG) < 0 ||
+				ccnb_append_tagged_blob(co, CCN_DTAG_Witness, witness->buf,
+				witness->length) < 0 ||
+				ccnb_append_tagged_blob(co, CCN_DTAG_SignatureBits, sig,
+				sig_len) < 0 ||
+				ccn_charbuf_append_closer(co) < 0 || /* </Signature> */
+				ccn_charbuf_append_charbuf(co, objects[i]) < 0 ||
+				ccn_charbuf_append_closer(co) < 0) { /* </ContentObject> */
+			ccn_charbuf_destroy(&co);
+			goto out;
+		}
+
+		ccn_charbuf_destroy(&objects[i]);
+		objects[i] = co;
+	}
+
+	for (i = 0; i < n; i++) {
+		results[i] = objects[i];
+		objects[i] = NULL;
+	}
+	r = MERKLE_OK;
+
+out:
+	free(sig);
+	free(tree);
+	ccn_charbuf_destroy(&witness);
+	if (objects)
+		for (i = 0; i < n; i++)
+			ccn_charbuf_destroy(&objects[i]);
+	free(objects);
+	return r;
+}
+
+int
+merkle_has_witness(const struct ccn_parsed_ContentObject *pco)
+{
+	return pco->offset[CCN_PCO_B_Witness] != pco->offset[CCN_PCO_E_Witness];
+}
+
+/* reads DER header with expected tag, on success *p points to the value */
+static int
+der_read(const unsigned char **p, const unsigned char *end, unsigned char tag,
+		size_t *len)
+{
+	const unsigned char *q = *p;
+	size_t l, n;
+
+	if (end - q < 2 || *q++ != tag)
+		return -1;
+
+	l = *q++;
+	if (l & 0x80) {
+		n = l & 0x7f;
+		if (n == 0 || n > 4 || (size_t) (end - q) < n)
+			return -1;
+		for (l = 0; n > 0; n--)
+			l = l << 8 | *q++;
+	}
+
+	if ((size_t) (end - q) < l)
+		return -1;
+
+	*p = q;
+	*len = l;
+
+	return 0;
+}
+
+/* computes root of the tree from object's leaf and its witness */
+static int
+merkle_root(const unsigned char *msg, const struct ccn_parsed_ContentObject *pco,
+		unsigned char *root)
+{
+	const unsigned char *witness, *p, *end, *oid, *hashes;
+	size_t witness_len, len, node, count;
+	int r;
+
+	r = ccn_ref_tagged_BLOB(CCN_DTAG_Witness, msg,
+			pco->offset[CCN_PCO_B_Witness], pco->offset[CCN_PCO_E_Witness],
+			&witness, &witness_len);
+	if (r < 0)
+		return -1;
+
+	p = witness;
+	end = witness + witness_len;
+
+	/* DigestInfo, AlgorithmIdentifier */
+	if (der_read(&p, end, DER_SEQUENCE, &len) < 0)
+		return -1;
+	end = p + len;
+	if (der_read(&p, end, DER_SEQUENCE, &len) < 0)
+		return -1;
+	oid = p;
+	p += len;
+	if (der_read(&oid, p, DER_OID, &len) < 0 || len != sizeof(mht_oid) ||
+			memcmp(oid, mht_oid, len))
+		return -1;
+
+	/* MerklePath */
+	if (der_read(&p, end, DER_OCTET_STRING, &len) < 0)
+		return -1;
+	end = p + len;
+	if (der_read(&p, end, DER_SEQUENCE, &len) < 0)
+		return -1;
+	end = p + len;
+
+	if (der_read(&p, end, DER_INTEGER, &len) < 0 || len == 0 ||
+			len > sizeof(int) + 1 || *p & 0x80)
+		return -1;
+	for (node = 0; len > 0; len--)
+		node = node << 8 | *p++;
+	if (node == 0 || node >= 2 * (size_t) MERKLE_MAX_LEAVES)
+		return -1;
+
+	if (der_read(&p, end, DER_SEQUENCE, &len) < 0 || len % PATH_ENTRY_LEN)
+		return -1;
+	hashes = p;
+	count = len / PATH_ENTRY_LEN;
+	if (count != (size_t) depth(node))
+		return -1;
+
+	SHA256(msg + pco->offset[CCN_PCO_B_Name],
+			pco->offset[CCN_PCO_E_Content] - pco->offset[CCN_PCO_B_Name], root);
+
+	/* walk up from the leaf, its sibling is the last one */
+	while (node > 1) {
+		p = hashes + --count * PATH_ENTRY_LEN;
+		if (p[0] != DER_OCTET_STRING || p[1] != HASHLEN)
+			return -1;
+
+		if (node & 1)
+			hash_pair(p + 2, root, root);
+		else
+			hash_pair(root, p + 2, root);
+
+		node >>= 1;
+	}
+
+	return 0;
+}
+
+/*
+ * Returns 1 when all objects belong to the same tree and its root has valid
+ * signature, 0 otherwise. Only one public key operation is done.
+ */
+int
+merkle_verify_ContentObjects(const unsigned char *const *msgs,
+		const struct ccn_parsed_ContentObject *const *pcos, size_t n,
+		const struct ccn_pkey *public_key)
+{
+	unsigned char root[HASHLEN], first_root[HASHLEN];
+	const unsigned char *sig, *first_sig = NULL;
+	size_t sig_len, first_sig_len = 0, i;
+	EVP_MD_CTX *ctx;
+	int r;
+
+	if (n == 0)
+		return 0;
+
+	for (i = 0; i < n; i++) {
+		if (!merkle_has_witness(pcos[i]))
+			return 0;
+
+		r = ccn_ref_tagged_BLOB(CCN_DTAG_SignatureBits, msgs[i],
+				pcos[i]->offset[CCN_PCO_B_SignatureBits],
+				pcos[i]->offset[CCN_PCO_E_SignatureBits], &sig, &sig_len);
+		if (r < 0)
+			return 0;
+
+		if (merkle_root(msgs[i], pcos[i], i ? root : first_root) < 0)
+			return 0;
+
+		if (i == 0) {
+			first_sig = sig;
+			first_sig_len = sig_len;
+		} else if (sig_len != first_sig_len ||
+				memcmp(sig, first_sig, sig_len) ||
+				memcmp(root, first_root, HASHLEN))
+			return 0;
+	}
+
+	ctx = EVP_MD_CTX_create();
+	if (!ctx)
+		return 0;
+
+	r = EVP_VerifyInit_ex(ctx, EVP_sha256(), NULL) &&
+			EVP_VerifyUpdate(ctx, first_root, HASHLEN) &&
+			EVP_VerifyFinal(ctx, first_sig, first_sig_len,
+			(EVP_PKEY *) public_key) == 1;
+	EVP_MD_CTX_destroy(ctx);
+
+	return r;
+}
@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) 2026, Regents of the University of California
+ * BSD license, See the COPYING file for more information
+ */
+
+#ifndef MERKLE_H
+#  define	MERKLE_H
+
+/* largest batch signed at once, keeps node numbers well within an int */
+#  define MERKLE_MAX_LEAVES (1 << 20)
+
+enum merkle_result {
+	MERKLE_OK = 0,
+	MERKLE_ENOMEM = -1,
+	MERKLE_EINVAL = -2,
+	MERKLE_ESIGN = -3
+};
+
+struct merkle_leaf {
+	const struct ccn_charbuf *name;
+	const struct ccn_charbuf *signed_info;
+	const void *content;
+	size_t content_len;
+};
+
+int merkle_encode_ContentObjects(struct ccn_charbuf **results,
+		const struct merkle_leaf *leaves, size_t n,
+		const struct ccn_pkey *private_key);
+int merkle_has_witness(const struct ccn_parsed_ContentObject *pco);
+int merkle_verify_ContentObjects(const unsigned char *const *msgs,
+		const struct ccn_parsed_ContentObject *const *pcos, size_t n,
+		const struct ccn_pkey *public_key);
+
+#endif	/* MERKLE_H */
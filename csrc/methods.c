@@ -22,29 +22,12 @@
 
 // Registering callbacks
 
-PyObject *
-_pyccn_cmd_generate_RSA_key(PyObject *UNUSED(self), PyObject *args)
+static PyObject *
+set_generated_key(PyObject *py_key, const char *type, PyObject *py_private_key,
+		PyObject *py_public_key, PyObject *py_public_key_digest)
 {
-	PyObject *py_key, *py_o;
-	long keylen;
-	PyObject *py_private_key = NULL, *py_public_key = NULL,
-			*py_public_key_digest = NULL;
-	int public_key_digest_len, r;
-
-	if (!PyArg_ParseTuple(args, "Ol", &py_key, &keylen))
-		return NULL;
-
-	if (strcmp(py_key->ob_type->tp_name, "Key")) {
-		PyErr_SetString(PyExc_TypeError, "Must pass a Key");
-		return NULL;
-	}
-
-	r = generate_key(keylen, &py_private_key, &py_public_key,
-			&py_public_key_digest, &public_key_digest_len);
-	if (r < 0) {
-		PyErr_SetString(g_PyExc_CCNKeyError, "Unable to genearate a key");
-		return NULL;
-	}
+	PyObject *py_o;
+	int r;
 
 	r = PyObject_SetAttrString(py_key, "ccn_data_private", py_private_key);
 	Py_CLEAR(py_private_key);
@@ -54,14 +37,14 @@ _pyccn_cmd_generate_RSA_key(PyObject *UNUSED(self), PyObject *args)
 	Py_CLEAR(py_public_key);
 	JUMP_IF_NEG(r, error);
 
-	py_o = PyUnicode_FromString("RSA");
+	py_o = PyUnicode_FromString(type);
 	JUMP_IF_NULL(py_o, error);
 	r = PyObject_SetAttrString(py_key, "type", py_o);
 	Py_DECREF(py_o);
 	JUMP_IF_NEG(r, error);
 
 	r = PyObject_SetAttrString(py_key, "publicKeyID", py_public_key_digest);
-	Py_DECREF(py_public_key_digest);
+	Py_CLEAR(py_public_key_digest);
 	JUMP_IF_NEG(r, error);
 
 	Py_RETURN_NONE;
@@ -73,6 +56,58 @@ error:
 	return NULL;
 }
 
+PyObject *
+_pyccn_cmd_generate_RSA_key(PyObject *UNUSED(self), PyObject *args)
+{
+	PyObject *py_key;
+	long keylen;
+	PyObject *py_private_key = NULL, *py_public_key = NULL,
+			*py_public_key_digest = NULL;
+	int public_key_digest_len, r;
+
+	if (!PyArg_ParseTuple(args, "Ol", &py_key, &keylen))
+		return NULL;
+
+	if (strcmp(py_key->ob_type->tp_name, "Key")) {
+		PyErr_SetString(PyExc_TypeError, "Must pass a Key");
+		return NULL;
+	}
+
+	r = generate_key(keylen, &py_private_key, &py_public_key,
+			&py_public_key_digest, &public_key_digest_len);
+	if (r < 0)
+		return NULL;
+
+	return set_generated_key(py_key, "RSA", py_private_key, py_public_key,
+			py_public_key_digest);
+}
+
+PyObject *
+_pyccn_cmd_generate_EC_key(PyObject *UNUSED(self), PyObject *args)
+{
+	PyObject *py_key;
+	const char *curve = "prime256v1";
+	PyObject *py_private_key = NULL, *py_public_key = NULL,
+			*py_public_key_digest = NULL;
+	int public_key_digest_len, r;
+
+	if (!PyArg_ParseTuple(args, "O|s", &py_key, &curve))
+		return NULL;
+
+	if (strcmp(py_key->ob_type->tp_name, "Key")) {
+		PyErr_SetString(PyExc_TypeError, "Must pass a Key");
+		return NULL;
+	}
+
+	r = generate_key_ec(curve, &py_private_key, &py_public_key,
+			&py_public_key_digest, &public_key_digest_len);
+	if (r < 0)
+		return NULL;
+
+	return set_generated_key(py_key, "EC", py_private_key, py_public_key,
+			py_public_key_digest);
+}
+
 
 // ** Methods of SignedInfo
 //
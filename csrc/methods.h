@@ -9,6 +9,7 @@
 #  define	METHODS_H
 
 PyObject *_pyccn_cmd_generate_RSA_key(PyObject *UNUSED(self), PyObject *args);
+PyObject *_pyccn_cmd_generate_EC_key(PyObject *UNUSED(self), PyObject *args);
 PyObject *_pyccn_SigningParams_from_ccn(PyObject *UNUSED(self),
 		PyObject *py_signing_params);
 PyObject *_pyccn_cmd_dump_charbuf(PyObject *self, PyObject *py_charbuf);
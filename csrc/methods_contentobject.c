@@ -11,23 +11,130 @@
 
 #include "pyccn.h"
 #include "util.h"
+#include "digest_sign.h"
 #include "methods_contentobject.h"
+#include "merkle.h"
 #include "methods_interest.h"
 #include "methods_key.h"
 #include "methods_name.h"
 #include "methods_signature.h"
 #include "methods_signedinfo.h"
 #include "objects.h"
+#include "trace.h"
+
+static int
+parse_ContentObject(PyObject *py_content_object)
+{
+	struct content_object_data *context;
+	struct ccn_charbuf *content_object;
+	int r;
+
+	assert(CCNObject_IsValid(CONTENT_OBJECT, py_content_object));
+
+	context = PyCapsule_GetContext(py_content_object);
+	assert(context);
+
+	content_object = CCNObject_Get(CONTENT_OBJECT, py_content_object);
+
+	context->parsed = 0;
+	context->comps.n = 0;
+	r = ccn_parse_ContentObject(content_object->buf, content_object->length,
+			&context->pco, &context->comps);
+	if (r < 0) {
+		PyErr_SetString(g_PyExc_CCNContentObjectError, "Unable to parse the"
+				" ContentObject");
+		return -1;
+	}
+	context->parsed = 1;
+
+	return 0;
+}
+
+struct ccn_parsed_ContentObject *
+_pyccn_content_object_get_pco(PyObject *py_content_object)
+{
+	struct content_object_data *context;
+	int r;
+
+	assert(CCNObject_IsValid(CONTENT_OBJECT, py_content_object));
+
+	context = PyCapsule_GetContext(py_content_object);
+	assert(context);
+
+	if (!context->parsed) {
+		r = parse_ContentObject(py_content_object);
+		if (r < 0)
+			return NULL;
+	}
+
+	return &context->pco;
+}
+
+struct ccn_indexbuf *
+_pyccn_content_object_get_comps(PyObject *py_content_object)
+{
+	struct content_object_data *context;
+	int r;
+
+	assert(CCNObject_IsValid(CONTENT_OBJECT, py_content_object));
+
+	context = PyCapsule_GetContext(py_content_object);
+	assert(context);
+
+	if (!context->parsed) {
+		r = parse_ContentObject(py_content_object);
+		if (r < 0)
+			return NULL;
+	}
+
+	return &context->comps;
+}
+
+/*
+ * Used when the object was already parsed by ccn (i.e. in an upcall), so we
+ * don't need to parse it second time
+ */
+int
+_pyccn_content_object_set_parsed(PyObject *py_content_object,
+		const struct ccn_parsed_ContentObject *pco,
+		const struct ccn_indexbuf *comps)
+{
+	struct content_object_data *context;
+	int r;
+
+	assert(CCNObject_IsValid(CONTENT_OBJECT, py_content_object));
+
+	context = PyCapsule_GetContext(py_content_object);
+	assert(context);
+
+	context->parsed = 0;
+	context->comps.n = 0;
+	r = ccn_indexbuf_append(&context->comps, comps->buf, comps->n);
+	JUMP_IF_NEG_MEM(r, error);
+
+	memcpy(&context->pco, pco, sizeof(context->pco));
+	context->parsed = 1;
+
+	return 0;
+
+error:
+	return -1;
+}
 
 static PyObject *
-Content_from_ccn_parsed(struct ccn_charbuf *content_object,
-		struct ccn_parsed_ContentObject *parsed_content_object)
+Content_from_ccn_parsed(PyObject *py_content_object)
 {
+	struct ccn_charbuf *content_object;
+	struct ccn_parsed_ContentObject *parsed_content_object;
 	const char *value;
 	size_t size;
-	PyObject *py_content;
 	int r;
 
+	content_object = CCNObject_Get(CONTENT_OBJECT, py_content_object);
+	parsed_content_object = _pyccn_content_object_get_pco(py_content_object);
+	if (!parsed_content_object)
+		return NULL;
+
 	r = ccn_content_get_value(content_object->buf, content_object->length,
 			parsed_content_object, (const unsigned char **) &value, &size);
 	if (r < 0) {
@@ -36,11 +143,38 @@ Content_from_ccn_parsed(struct ccn_charbuf *content_object,
 		return NULL;
 	}
 
-	py_content = PyBytes_FromStringAndSize(value, size);
-	if (!py_content)
+	return PyBytes_FromStringAndSize(value, size);
+}
+
+/* None when the object is signed with the publisher's key */
+static PyObject *
+DigestAlgorithm_from_ccn_parsed(PyObject *py_content_object)
+{
+	struct ccn_charbuf *content_object;
+	struct ccn_parsed_ContentObject *pco;
+	const unsigned char *oid;
+	size_t size;
+	int r;
+
+	content_object = CCNObject_Get(CONTENT_OBJECT, py_content_object);
+	pco = _pyccn_content_object_get_pco(py_content_object);
+	if (!pco)
 		return NULL;
 
-	return py_content;
+	if (pco->offset[CCN_PCO_B_DigestAlgorithm] ==
+			pco->offset[CCN_PCO_E_DigestAlgorithm])
+		Py_RETURN_NONE;
+
+	r = ccn_ref_tagged_string(CCN_DTAG_DigestAlgorithm, content_object->buf,
+			pco->offset[CCN_PCO_B_DigestAlgorithm],
+			pco->offset[CCN_PCO_E_DigestAlgorithm], &oid, &size);
+	if (r < 0) {
+		PyErr_SetString(g_PyExc_CCNSignatureError, "Unable to parse"
+				" DigestAlgorithm");
+		return NULL;
+	}
+
+	return PyUnicode_FromStringAndSize((const char *) oid, size);
 }
 
 static PyObject *
@@ -94,224 +228,80 @@ Name_obj_from_ccn_parsed(PyObject *py_content_object)
 	return py_Name;
 }
 
-static int
-parse_ContentObject(PyObject *py_content_object)
+/*
+ * Copies element between offsets b and e (i.e. Signature or SignedInfo) into
+ * its own capsule and converts it to Python object using obj_from_ccn
+ */
+static PyObject *
+Element_obj_from_ccn_parsed(PyObject *py_content_object,
+		enum _pyccn_capsules type, enum ccn_parsed_content_object_offsetid b,
+		enum ccn_parsed_content_object_offsetid e,
+		PyObject *(*obj_from_ccn)(PyObject *))
 {
-	struct content_object_data *context;
 	struct ccn_charbuf *content_object;
+	struct ccn_parsed_ContentObject *parsed_content_object;
+	struct ccn_charbuf *element;
+	PyObject *py_element, *py_o;
 	int r;
 
-	assert(CCNObject_IsValid(CONTENT_OBJECT, py_content_object));
-
-	context = PyCapsule_GetContext(py_content_object);
-	assert(context);
-	if (context->pco)
-		free(context->pco);
-	ccn_indexbuf_destroy(&context->comps);
-
-	/*
-	 * no error happens between deallocation and following line, so I'm not
-	 * setting context->pco to NULL
-	 */
-	context->pco = calloc(1, sizeof(struct ccn_parsed_ContentObject));
-	JUMP_IF_NULL_MEM(context->pco, error);
-
-	context->comps = ccn_indexbuf_create();
-	JUMP_IF_NULL_MEM(context->comps, error);
-
 	content_object = CCNObject_Get(CONTENT_OBJECT, py_content_object);
+	parsed_content_object = _pyccn_content_object_get_pco(py_content_object);
+	if (!parsed_content_object)
+		return NULL;
 
-	r = ccn_parse_ContentObject(content_object->buf, content_object->length,
-			context->pco, context->comps);
-	if (r < 0) {
-		PyErr_SetString(g_PyExc_CCNContentObjectError, "Unable to parse the"
-				" ContentObject");
-		goto error;
-	}
+	py_element = CCNObject_New_charbuf(type, &element);
+	if (!py_element)
+		return NULL;
 
-	return 0;
-error:
-	if (context->pco) {
-		free(context->pco);
-		context->pco = NULL;
+	r = ccn_charbuf_append(element,
+			&content_object->buf[parsed_content_object->offset[b]],
+			(size_t) (parsed_content_object->offset[e]
+			- parsed_content_object->offset[b]));
+	if (r < 0) {
+		Py_DECREF(py_element);
+		return PyErr_NoMemory();
 	}
-	ccn_indexbuf_destroy(&context->comps);
-	return -1;
-}
-
-struct ccn_parsed_ContentObject *
-_pyccn_content_object_get_pco(PyObject *py_content_object)
-{
-	struct content_object_data *context;
-	int r;
-
-	assert(CCNObject_IsValid(CONTENT_OBJECT, py_content_object));
-
-	context = PyCapsule_GetContext(py_content_object);
-	assert(context);
-
-	if (context->pco)
-		return context->pco;
-
-	r = parse_ContentObject(py_content_object);
-	JUMP_IF_NEG(r, error);
-
-	assert(context->pco);
-	return context->pco;
-
-error:
-	return NULL;
-}
-
-void
-_pyccn_content_object_set_pco(PyObject *py_content_object,
-		struct ccn_parsed_ContentObject *pco)
-{
-	struct content_object_data *context;
-
-	assert(CCNObject_IsValid(CONTENT_OBJECT, py_content_object));
-
-	context = PyCapsule_GetContext(py_content_object);
-	assert(context);
-
-	if (context->pco)
-		free(context->pco);
-
-	context->pco = pco;
-}
-
-struct ccn_indexbuf *
-_pyccn_content_object_get_comps(PyObject *py_content_object)
-{
-	struct content_object_data *context;
-	int r;
-
-	assert(CCNObject_IsValid(CONTENT_OBJECT, py_content_object));
-
-	context = PyCapsule_GetContext(py_content_object);
-	assert(context);
-
-	if (context->comps)
-		return context->comps;
-
-	r = parse_ContentObject(py_content_object);
-	JUMP_IF_NEG(r, error);
-
-	assert(context->comps);
-	return context->comps;
-
-error:
-	return NULL;
-}
 
-void
-_pyccn_content_object_set_comps(PyObject *py_content_object,
-		struct ccn_indexbuf *comps)
-{
-	struct content_object_data *context;
-
-	assert(CCNObject_IsValid(CONTENT_OBJECT, py_content_object));
-
-	context = PyCapsule_GetContext(py_content_object);
-	assert(context);
+	py_o = obj_from_ccn(py_element);
+	Py_DECREF(py_element);
 
-	if (context->comps)
-		free(context->comps);
-
-	context->comps = comps;
+	return py_o;
 }
 
 // ** Methods of ContentObject
 //
 // Content Objects
 
+/*
+ * Only ccn_data is set here, fields listed in ContentObject._lazy_fields are
+ * decoded by ContentObject_field_from_ccn once they're accessed
+ */
 PyObject *
 ContentObject_obj_from_ccn(PyObject *py_content_object)
 {
-	struct ccn_charbuf *content_object;
-	struct ccn_parsed_ContentObject *parsed_content_object;
 	PyObject *py_obj_ContentObject, *py_o;
+	PyObject *py_lazy;
 	int r;
-	struct ccn_charbuf *signature;
-	PyObject *py_signature;
-	struct ccn_charbuf *signed_info;
-	PyObject *py_signed_info;
 
 	if (!CCNObject_ReqType(CONTENT_OBJECT, py_content_object))
 		return NULL;
 
-	content_object = CCNObject_Get(CONTENT_OBJECT, py_content_object);
-	parsed_content_object = _pyccn_content_object_get_pco(py_content_object);
-	if (!parsed_content_object)
+	/* we still want to refuse malformed objects right away */
+	if (!_pyccn_content_object_get_pco(py_content_object))
 		return NULL;
 
-	debug("ContentObject_from_ccn_parsed content_object->length=%zd\n",
-			content_object->length);
-
 	py_obj_ContentObject = PyObject_CallObject(g_type_ContentObject, NULL);
 	if (!py_obj_ContentObject)
 		return NULL;
 
-	/* Name */
-	py_o = Name_obj_from_ccn_parsed(py_content_object);
-	JUMP_IF_NULL(py_o, error);
-	r = PyObject_SetAttrString(py_obj_ContentObject, "name", py_o);
-	Py_DECREF(py_o);
-	JUMP_IF_NEG(r, error);
-
-	/* Content */
-	py_o = Content_from_ccn_parsed(content_object, parsed_content_object);
-	JUMP_IF_NULL(py_o, error);
-	r = PyObject_SetAttrString(py_obj_ContentObject, "content", py_o);
-	Py_DECREF(py_o);
-	JUMP_IF_NEG(r, error);
-
-	/* Signature */
-	debug("ContentObject_from_ccn_parsed Signature\n");
-	py_signature = CCNObject_New_charbuf(SIGNATURE, &signature);
-	JUMP_IF_NULL(py_signature, error);
-	r = ccn_charbuf_append(signature,
-			&content_object->buf[parsed_content_object->offset[CCN_PCO_B_Signature]],
-			(size_t) (parsed_content_object->offset[CCN_PCO_E_Signature]
-			- parsed_content_object->offset[CCN_PCO_B_Signature]));
-	if (r < 0) {
-		PyErr_NoMemory();
-		Py_DECREF(py_signature);
-		goto error;
-	}
-
-	py_o = Signature_obj_from_ccn(py_signature);
-	Py_DECREF(py_signature);
-	JUMP_IF_NULL(py_o, error);
-	r = PyObject_SetAttrString(py_obj_ContentObject, "signature", py_o);
-	Py_DECREF(py_o);
-	JUMP_IF_NEG(r, error);
-
-	debug("ContentObject_from_ccn_parsed SignedInfo\n");
-
-	py_signed_info = CCNObject_New_charbuf(SIGNED_INFO, &signed_info);
-	JUMP_IF_NULL(py_signed_info, error);
-
-	r = ccn_charbuf_append(signed_info,
-			&content_object->buf[parsed_content_object->offset[CCN_PCO_B_SignedInfo]],
-			(size_t) (parsed_content_object->offset[CCN_PCO_E_SignedInfo]
-			- parsed_content_object->offset[CCN_PCO_B_SignedInfo]));
-	if (r < 0) {
-		PyErr_NoMemory();
-		Py_DECREF(py_signed_info);
-		goto error;
-	}
-
-	py_o = SignedInfo_obj_from_ccn(py_signed_info);
-	Py_DECREF(py_signed_info);
+	py_o = PyObject_GetAttrString(py_obj_ContentObject, "_lazy_fields");
 	JUMP_IF_NULL(py_o, error);
-	r = PyObject_SetAttrString(py_obj_ContentObject, "signedInfo", py_o);
+	py_lazy = PySet_New(py_o);
 	Py_DECREF(py_o);
-	JUMP_IF_NEG(r, error);
+	JUMP_IF_NULL(py_lazy, error);
 
-	debug("ContentObject_from_ccn_parsed DigestAlgorithm\n");
-	// TODO...  Note this seems to default to nothing in the library...?
-	r = PyObject_SetAttrString(py_obj_ContentObject, "digestAlgorithm", Py_None);
+	r = PyObject_SetAttrString(py_obj_ContentObject, "_lazy", py_lazy);
+	Py_DECREF(py_lazy);
 	JUMP_IF_NEG(r, error);
 
 	/* Original data  */
@@ -331,6 +321,36 @@ error:
 	return NULL;
 }
 
+PyObject *
+_pyccn_cmd_ContentObject_field_from_ccn(PyObject *UNUSED(self), PyObject *args)
+{
+	PyObject *py_content_object;
+	const char *field;
+
+	if (!PyArg_ParseTuple(args, "Os", &py_content_object, &field))
+		return NULL;
+
+	if (!CCNObject_ReqType(CONTENT_OBJECT, py_content_object))
+		return NULL;
+
+	if (!strcmp(field, "name"))
+		return Name_obj_from_ccn_parsed(py_content_object);
+	else if (!strcmp(field, "content"))
+		return Content_from_ccn_parsed(py_content_object);
+	else if (!strcmp(field, "digestAlgorithm"))
+		return DigestAlgorithm_from_ccn_parsed(py_content_object);
+	else if (!strcmp(field, "signedInfo"))
+		return Element_obj_from_ccn_parsed(py_content_object, SIGNED_INFO,
+			CCN_PCO_B_SignedInfo, CCN_PCO_E_SignedInfo,
+			SignedInfo_obj_from_ccn);
+	else if (!strcmp(field, "signature"))
+		return Element_obj_from_ccn_parsed(py_content_object, SIGNATURE,
+			CCN_PCO_B_Signature, CCN_PCO_E_Signature, Signature_obj_from_ccn);
+
+	PyErr_Format(PyExc_ValueError, "Unknown ContentObject field: %s", field);
+	return NULL;
+}
+
 PyObject *
 _pyccn_cmd_content_to_bytearray(PyObject *UNUSED(self), PyObject *arg)
 {
@@ -367,6 +387,11 @@ _pyccn_cmd_content_to_bytearray(PyObject *UNUSED(self), PyObject *arg)
 	return result;
 }
 
+/*
+ * What ContentObject.content is set to: text is encoded and numbers turned
+ * into text, objects supporting the buffer protocol are kept as they are,
+ * encode_ContentObject() reads them without copying
+ */
 PyObject *
 _pyccn_cmd_content_to_bytes(PyObject *UNUSED(self), PyObject *arg)
 {
@@ -392,6 +417,12 @@ _pyccn_cmd_content_to_bytes(PyObject *UNUSED(self), PyObject *arg)
 	} else if (PyUnicode_Check(arg))
 		return PyUnicode_EncodeUTF8(PyUnicode_AS_UNICODE(arg),
 			PyUnicode_GET_SIZE(arg), NULL);
+	else if (PyBytes_Check(arg) || PyObject_CheckBuffer(arg))
+		return Py_INCREF(arg), arg;
+#if PY_MAJOR_VERSION < 3
+	else if (PyObject_CheckReadBuffer(arg))
+		return Py_INCREF(arg), arg; /* e.g. mmap, only has the old interface */
+#endif
 
 	return PyObject_Bytes(arg);
 }
@@ -401,12 +432,15 @@ _pyccn_cmd_encode_ContentObject(PyObject *UNUSED(self), PyObject *args)
 {
 	PyObject *py_content_object, *py_name, *py_content, *py_signed_info,
 			*py_key;
-	PyObject *py_o = NULL, *ret = NULL;
+	PyObject *py_o = NULL, *py_oid, *py_pkey = NULL, *ret = NULL;
 	struct ccn_charbuf *name, *signed_info, *content_object = NULL;
 	struct ccn_pkey *private_key;
-	const char *digest_alg = NULL;
-	char *content;
-	Py_ssize_t content_len;
+	enum digest_sign_alg alg;
+	const char *secret = NULL;
+	const void *content;
+	char *oid;
+	Py_buffer content_view;
+	Py_ssize_t content_len, oid_len, secret_len = 0;
 	int r;
 
 	if (!PyArg_ParseTuple(args, "OOOOO", &py_content_object, &py_name,
@@ -424,69 +458,303 @@ _pyccn_cmd_encode_ContentObject(PyObject *UNUSED(self), PyObject *args)
 	} else
 		name = CCNObject_Get(NAME, py_name);
 
-	if (py_content != Py_None && !PyBytes_Check(py_content)) {
-		PyErr_SetString(PyExc_TypeError, "Must pass a Bytes as arg 3");
-		return NULL;
-	} else if (py_content == Py_None) {
-		content = NULL;
-		content_len = 0;
-	} else {
-		r = PyBytes_AsStringAndSize(py_content, &content, &content_len);
-		if (r < 0)
-			return NULL;
-	}
-
 	if (!CCNObject_IsValid(SIGNED_INFO, py_signed_info)) {
 		PyErr_SetString(PyExc_TypeError, "Must pass a CCN SignedInfo as arg 4");
 		return NULL;
 	} else
 		signed_info = CCNObject_Get(SIGNED_INFO, py_signed_info);
 
-	if (strcmp(py_key->ob_type->tp_name, "Key")) {
-		PyErr_SetString(PyExc_TypeError, "Must pass a Key as arg 4");
+	/* read in place, the view also keeps e.g. a bytearray from resizing */
+	r = _pyccn_content_get_buffer(py_content, &content_view);
+	if (r < 0)
 		return NULL;
-	}
+	content = content_view.buf;
+	content_len = content_view.len;
 
 	// DigestAlgorithm
 	py_o = PyObject_GetAttrString(py_content_object, "digestAlgorithm");
-	if (py_o != Py_None) {
-		PyErr_SetString(PyExc_NotImplementedError, "non-default digest"
-				" algorithm not yet supported");
-		goto error;
+	JUMP_IF_NULL(py_o, error);
+	if (py_o == Py_None)
+		alg = DIGEST_SIGN_DEFAULT;
+	else {
+		py_oid = _pyccn_unicode_to_utf8(py_o, &oid, &oid_len);
+		JUMP_IF_NULL(py_oid, error);
+		alg = digest_sign_alg_from_oid(oid, oid_len);
+		Py_DECREF(py_oid);
 	}
 	Py_CLEAR(py_o);
 
-	// Key
-	private_key = Key_to_ccn_private(py_key);
+	if (alg == DIGEST_SIGN_UNKNOWN) {
+		PyErr_SetString(PyExc_NotImplementedError, "unsupported digest"
+				" algorithm");
+		goto error;
+	} else if (alg == DIGEST_SIGN_DEFAULT &&
+			strcmp(py_key->ob_type->tp_name, "Key")) {
+		PyErr_SetString(PyExc_TypeError, "Must pass a Key as arg 5");
+		goto error;
+	} else if (alg == DIGEST_SIGN_HMAC_SHA256) {
+		// the key is the shared secret
+		if (!PyBytes_Check(py_key) || PyBytes_GET_SIZE(py_key) == 0) {
+			PyErr_SetString(PyExc_TypeError, "HMAC needs a shared secret"
+					" (non-empty bytes) as arg 5");
+			goto error;
+		}
+		secret = PyBytes_AS_STRING(py_key);
+		secret_len = PyBytes_GET_SIZE(py_key);
+	}
 
-	// Note that we don't load this key into the keystore hashtable in the library
-	// because it makes this method require access to a ccn handle, and in fact,
-	// ccn_sign_content just uses what's in signedinfo (after an error check by
-	// chk_signing_params and then calls ccn_encode_ContentObject anyway
-	//
-	// Encode the content object
+	if (alg == DIGEST_SIGN_DEFAULT) {
+		private_key = Key_to_ccn_private(py_key, &py_pkey);
+		JUMP_IF_NULL(private_key, error);
+	}
+
+	TRACE_BEGIN("encode");
 
 	// Build the ContentObject here.
 	content_object = ccn_charbuf_create();
-	JUMP_IF_NULL_MEM(content_object, error);
+	if (!content_object) {
+		TRACE_END("encode");
+		PyErr_NoMemory();
+		goto error;
+	}
 
-	r = ccn_encode_ContentObject(content_object, name, signed_info, content,
-			content_len, digest_alg, private_key);
+	/*
+	 * everything used below is referenced by args, the content by its
+	 * buffer view and the private key by py_pkey, so the signing can run
+	 * without the GIL (content of a mutable buffer changed meanwhile by
+	 * another thread is the caller's problem)
+	 */
+	TRACE_BEGIN("sign");
+	if (alg == DIGEST_SIGN_DEFAULT) {
+		// Note that we don't load this key into the keystore hashtable in
+		// the library because it makes this method require access to a ccn
+		// handle, and in fact, ccn_sign_content just uses what's in
+		// signedinfo (after an error check by chk_signing_params and then
+		// calls ccn_encode_ContentObject anyway
+		Py_BEGIN_ALLOW_THREADS
+		r = ccn_encode_ContentObject(content_object, name, signed_info,
+				content, content_len, NULL, private_key);
+		Py_END_ALLOW_THREADS
+	} else if (content_len < GIL_MINSIZE)
+		r = digest_sign_encode_ContentObject(content_object, name,
+				signed_info, content, content_len, alg, secret, secret_len);
+	else {
+		Py_BEGIN_ALLOW_THREADS
+		r = digest_sign_encode_ContentObject(content_object, name,
+				signed_info, content, content_len, alg, secret, secret_len);
+		Py_END_ALLOW_THREADS
+	}
+	TRACE_END("sign");
 
 	debug("ccn_encode_ContentObject res=%d\n", r);
 	if (r < 0) {
+		TRACE_END("encode");
 		ccn_charbuf_destroy(&content_object);
 		PyErr_SetString(g_PyExc_CCNError, "Unable to encode ContentObject");
 		goto error;
 	}
 
 	ret = CCNObject_New(CONTENT_OBJECT, content_object);
+	TRACE_END("encode");
 
 error:
+	PyBuffer_Release(&content_view);
+	Py_XDECREF(py_pkey);
 	Py_XDECREF(py_o);
 	return ret;
 }
 
+/*
+ * Signs all objects with a single signature over the root of a Merkle hash
+ * tree built from them (see merkle.c), takes a sequence of
+ * (name, content, signed_info) and returns list of encoded objects
+ */
+PyObject *
+_pyccn_cmd_encode_ContentObjects_merkle(PyObject *UNUSED(self), PyObject *args)
+{
+	PyObject *py_parts, *py_key, *py_seq = NULL, *py_result = NULL, *py_o;
+	PyObject *py_pkey = NULL;
+	PyObject *py_name, *py_content, *py_signed_info;
+	struct merkle_leaf *leaves = NULL;
+	struct ccn_charbuf **objects = NULL;
+	struct ccn_pkey *private_key;
+	Py_buffer *views = NULL;
+	Py_ssize_t i, n, nviews = 0;
+	int r;
+
+	if (!PyArg_ParseTuple(args, "OO", &py_parts, &py_key))
+		return NULL;
+
+	if (strcmp(py_key->ob_type->tp_name, "Key")) {
+		PyErr_SetString(PyExc_TypeError, "Must pass a Key as arg 2");
+		return NULL;
+	}
+
+	/* a copy, so nothing used while the GIL is released goes away */
+	py_seq = PySequence_Tuple(py_parts);
+	JUMP_IF_NULL(py_seq, error);
+
+	n = PyTuple_GET_SIZE(py_seq);
+	if (n == 0 || n > MERKLE_MAX_LEAVES) {
+		PyErr_Format(PyExc_ValueError, "can sign between 1 and %d objects at"
+				" once", MERKLE_MAX_LEAVES);
+		goto error;
+	}
+
+	leaves = calloc(n, sizeof(*leaves));
+	objects = calloc(n, sizeof(*objects));
+	views = calloc(n, sizeof(*views));
+	if (!leaves || !objects || !views) {
+		PyErr_NoMemory();
+		goto error;
+	}
+
+	for (i = 0; i < n; i++) {
+		if (!PyArg_ParseTuple(PyTuple_GET_ITEM(py_seq, i), "OOO",
+				&py_name, &py_content, &py_signed_info))
+			goto error;
+
+		if (!CCNObject_IsValid(NAME, py_name)) {
+			PyErr_SetString(PyExc_TypeError, "Expected CCN Name");
+			goto error;
+		}
+
+		if (!CCNObject_IsValid(SIGNED_INFO, py_signed_info)) {
+			PyErr_SetString(PyExc_TypeError, "Expected CCN SignedInfo");
+			goto error;
+		}
+
+		if (_pyccn_content_get_buffer(py_content, &views[i]) < 0)
+			goto error;
+		nviews++;
+
+		leaves[i].name = CCNObject_Get(NAME, py_name);
+		leaves[i].signed_info = CCNObject_Get(SIGNED_INFO, py_signed_info);
+		leaves[i].content = views[i].buf;
+		leaves[i].content_len = views[i].len;
+	}
+
+	/* held until we're done, the Key can get a new one meanwhile */
+	private_key = Key_to_ccn_private(py_key, &py_pkey);
+	JUMP_IF_NULL(private_key, error);
+
+	TRACE_BEGIN("sign");
+	Py_BEGIN_ALLOW_THREADS
+	r = merkle_encode_ContentObjects(objects, leaves, n, private_key);
+	Py_END_ALLOW_THREADS
+	TRACE_END("sign");
+	if (r == MERKLE_ENOMEM) {
+		PyErr_NoMemory();
+		goto error;
+	} else if (r < 0) {
+		PyErr_SetString(g_PyExc_CCNError, "Unable to sign ContentObjects");
+		goto error;
+	}
+
+	py_result = PyList_New(n);
+	JUMP_IF_NULL(py_result, error);
+
+	for (i = 0; i < n; i++) {
+		py_o = CCNObject_New(CONTENT_OBJECT, objects[i]);
+		JUMP_IF_NULL(py_o, error);
+		objects[i] = NULL;
+		PyList_SET_ITEM(py_result, i, py_o);
+	}
+
+	for (i = 0; i < nviews; i++)
+		PyBuffer_Release(&views[i]);
+	free(views);
+	free(objects);
+	free(leaves);
+	Py_DECREF(py_pkey);
+	Py_DECREF(py_seq);
+
+	return py_result;
+
+error:
+	if (objects)
+		for (i = 0; i < n; i++)
+			ccn_charbuf_destroy(&objects[i]);
+	for (i = 0; i < nviews; i++)
+		PyBuffer_Release(&views[i]);
+	free(views);
+	free(objects);
+	free(leaves);
+	Py_XDECREF(py_result);
+	Py_XDECREF(py_pkey);
+	Py_XDECREF(py_seq);
+	return NULL;
+}
+
+/*
+ * Verifies a set of objects signed with encode_ContentObjects_merkle(), they
+ * all need to come from the same tree, only its root signature is checked
+ */
+PyObject *
+_pyccn_cmd_verify_ContentObjects(PyObject *UNUSED(self), PyObject *args)
+{
+	PyObject *py_objects, *py_pub_key, *py_seq, *py_o;
+	const unsigned char **msgs = NULL;
+	const struct ccn_parsed_ContentObject **pcos = NULL;
+	struct ccn_charbuf *content_object;
+	struct ccn_pkey *pub_key;
+	Py_ssize_t i, n;
+	int r;
+
+	if (!PyArg_ParseTuple(args, "OO", &py_objects, &py_pub_key))
+		return NULL;
+
+	if (!CCNObject_IsValid(PKEY_PUB, py_pub_key)) {
+		PyErr_SetString(PyExc_TypeError, "argument 2 must be CCN public key");
+		return NULL;
+	}
+
+	pub_key = CCNObject_Get(PKEY_PUB, py_pub_key);
+
+	py_seq = PySequence_Tuple(py_objects);
+	if (!py_seq)
+		return NULL;
+
+	n = PyTuple_GET_SIZE(py_seq);
+	msgs = calloc(n ? n : 1, sizeof(*msgs));
+	pcos = calloc(n ? n : 1, sizeof(*pcos));
+	if (!msgs || !pcos) {
+		PyErr_NoMemory();
+		goto error;
+	}
+
+	for (i = 0; i < n; i++) {
+		py_o = PyTuple_GET_ITEM(py_seq, i);
+		if (!CCNObject_IsValid(CONTENT_OBJECT, py_o)) {
+			PyErr_SetString(PyExc_TypeError, "expected CCN ContentObject");
+			goto error;
+		}
+
+		content_object = CCNObject_Get(CONTENT_OBJECT, py_o);
+		msgs[i] = content_object->buf;
+		pcos[i] = _pyccn_content_object_get_pco(py_o);
+		JUMP_IF_NULL(pcos[i], error);
+	}
+
+	TRACE_BEGIN("verify");
+	Py_BEGIN_ALLOW_THREADS
+	r = merkle_verify_ContentObjects(msgs, pcos, n, pub_key);
+	Py_END_ALLOW_THREADS
+	TRACE_END("verify");
+
+	free(pcos);
+	free(msgs);
+	Py_DECREF(py_seq);
+
+	return PyBool_FromLong(r == 1);
+
+error:
+	free(pcos);
+	free(msgs);
+	Py_DECREF(py_seq);
+	return NULL;
+}
+
 PyObject *
 _pyccn_cmd_ContentObject_obj_from_ccn(PyObject *UNUSED(self), PyObject *py_co)
 {
@@ -498,7 +766,7 @@ _pyccn_cmd_digest_contentobject(PyObject *UNUSED(self), PyObject *args)
 {
 	PyObject *py_content_object;
 	struct ccn_charbuf *content_object;
-	struct ccn_parsed_ContentObject *parsed_content_object;
+	struct ccn_parsed_ContentObject *parsed_content_object, pco;
 	PyObject *py_digest;
 
 	if (!PyArg_ParseTuple(args, "O", &py_content_object))
@@ -524,7 +792,24 @@ _pyccn_cmd_digest_contentobject(PyObject *UNUSED(self), PyObject *args)
 		return NULL;
 	}
 
-	ccn_digest_ContentObject(content_object->buf, parsed_content_object);
+	/*
+	 * the digest is cached in pco, which other threads can be reading, so
+	 * it's computed in a copy and stored once the GIL is back
+	 */
+	if (parsed_content_object->digest_bytes != sizeof(pco.digest)) {
+		pco = *parsed_content_object;
+		if (content_object->length < GIL_MINSIZE)
+			ccn_digest_ContentObject(content_object->buf, &pco);
+		else {
+			Py_BEGIN_ALLOW_THREADS
+			ccn_digest_ContentObject(content_object->buf, &pco);
+			Py_END_ALLOW_THREADS
+		}
+
+		memcpy(parsed_content_object->digest, pco.digest, sizeof(pco.digest));
+		parsed_content_object->digest_bytes = pco.digest_bytes;
+	}
+
 	py_digest = PyBytes_FromStringAndSize(
 			(char *) parsed_content_object->digest,
 			parsed_content_object->digest_bytes);
@@ -575,6 +860,131 @@ _pyccn_cmd_content_matches_interest(PyObject *UNUSED(self), PyObject *args)
 	return Py_INCREF(res), res;
 }
 
+/*
+ * Accepts either Interest object or its ccn_data, returns new reference to the
+ * capsule
+ */
+static PyObject *
+get_interest_capsule(PyObject *py_interest)
+{
+	PyObject *py_o;
+
+	if (CCNObject_IsValid(INTEREST, py_interest))
+		return Py_INCREF(py_interest), py_interest;
+
+	py_o = PyObject_GetAttrString(py_interest, "ccn_data");
+	if (!py_o)
+		return NULL;
+
+	if (!CCNObject_ReqType(INTEREST, py_o)) {
+		Py_DECREF(py_o);
+		return NULL;
+	}
+
+	return py_o;
+}
+
+/*
+ * Matches the content object against every interest in py_interests, the
+ * ContentObject is parsed (and digest computed) only once. Returns list of
+ * indices of matching interests or, if return_items is set, list of the
+ * matching items themselves.
+ */
+static PyObject *
+match_interests(PyObject *py_content_object, PyObject *py_interests,
+		int return_items)
+{
+	PyObject *py_seq, *py_item, *py_interest, *py_o;
+	PyObject *py_result = NULL;
+	struct ccn_charbuf *content_object, *interest;
+	struct ccn_parsed_ContentObject *pco;
+	struct ccn_parsed_interest *pi;
+	Py_ssize_t i, n;
+	int r;
+
+	if (!CCNObject_IsValid(CONTENT_OBJECT, py_content_object)) {
+		PyErr_SetString(PyExc_TypeError, "Expected CCN ContentObject");
+		return NULL;
+	}
+
+	content_object = CCNObject_Get(CONTENT_OBJECT, py_content_object);
+	pco = _pyccn_content_object_get_pco(py_content_object);
+	if (!pco)
+		return NULL;
+
+	py_seq = PySequence_Fast(py_interests, "Expected sequence of Interests");
+	if (!py_seq)
+		return NULL;
+
+	py_result = PyList_New(0);
+	JUMP_IF_NULL(py_result, error);
+
+	n = PySequence_Fast_GET_SIZE(py_seq);
+	for (i = 0; i < n; i++) {
+		py_item = PySequence_Fast_GET_ITEM(py_seq, i);
+
+		py_interest = get_interest_capsule(py_item);
+		JUMP_IF_NULL(py_interest, error);
+
+		interest = CCNObject_Get(INTEREST, py_interest);
+		pi = _pyccn_interest_get_pi(py_interest);
+		if (!pi) {
+			Py_DECREF(py_interest);
+			goto error;
+		}
+
+		r = ccn_content_matches_interest(content_object->buf,
+				content_object->length, 1, pco, interest->buf,
+				interest->length, pi);
+		Py_DECREF(py_interest);
+
+		if (!r)
+			continue;
+
+		if (return_items)
+			py_o = (Py_INCREF(py_item), py_item);
+		else {
+			py_o = _pyccn_Int_FromLong(i);
+			JUMP_IF_NULL(py_o, error);
+		}
+
+		r = PyList_Append(py_result, py_o);
+		Py_DECREF(py_o);
+		JUMP_IF_NEG(r, error);
+	}
+
+	Py_DECREF(py_seq);
+
+	return py_result;
+
+error:
+	Py_XDECREF(py_result);
+	Py_DECREF(py_seq);
+	return NULL;
+}
+
+PyObject *
+_pyccn_cmd_content_matches_interests(PyObject *UNUSED(self), PyObject *args)
+{
+	PyObject *py_content_object, *py_interests;
+
+	if (!PyArg_ParseTuple(args, "OO", &py_content_object, &py_interests))
+		return NULL;
+
+	return match_interests(py_content_object, py_interests, 0);
+}
+
+PyObject *
+_pyccn_cmd_interests_matching_content(PyObject *UNUSED(self), PyObject *args)
+{
+	PyObject *py_content_object, *py_interests;
+
+	if (!PyArg_ParseTuple(args, "OO", &py_content_object, &py_interests))
+		return NULL;
+
+	return match_interests(py_content_object, py_interests, 1);
+}
+
 PyObject *
 _pyccn_cmd_verify_content(PyObject *UNUSED(self), PyObject *args)
 {
@@ -608,7 +1018,24 @@ _pyccn_cmd_verify_content(PyObject *UNUSED(self), PyObject *args)
 
 	assert(content_object->length == pco->offset[CCN_PCO_E]);
 
-	r = ccn_verify_content(handle, content_object->buf, pco);
+	TRACE_BEGIN("verify");
+	switch (digest_sign_alg_of(content_object->buf, pco)) {
+	case DIGEST_SIGN_SHA256:
+	case DIGEST_SIGN_HMAC_SHA256:
+		/*
+		 * nothing ties these to the publisher, anyone can make them; the
+		 * digest can still be checked with verify_signature()
+		 */
+		r = -1;
+		break;
+	default:
+		/*
+		 * keeps the GIL, the handle (its key cache) isn't safe to use from
+		 * more than one thread
+		 */
+		r = ccn_verify_content(handle, content_object->buf, pco);
+	}
+	TRACE_END("verify");
 
 	res = r == 0 ? Py_True : Py_False;
 
@@ -623,6 +1050,9 @@ _pyccn_cmd_verify_signature(PyObject *UNUSED(self), PyObject *args)
 	struct ccn_charbuf *content_object;
 	struct ccn_parsed_ContentObject *pco;
 	struct ccn_pkey *pub_key;
+	enum digest_sign_alg alg;
+	const char *secret;
+	Py_ssize_t secret_len;
 	int r;
 
 	if (!PyArg_ParseTuple(args, "OO", &py_content_object, &py_pub_key))
@@ -634,20 +1064,73 @@ _pyccn_cmd_verify_signature(PyObject *UNUSED(self), PyObject *args)
 		return NULL;
 	}
 
-	if (!CCNObject_IsValid(PKEY_PUB, py_pub_key)) {
-		PyErr_SetString(PyExc_TypeError, "argument 2 must be CCN public key");
-		return NULL;
-	}
-
 	content_object = CCNObject_Get(CONTENT_OBJECT, py_content_object);
 	pco = _pyccn_content_object_get_pco(py_content_object);
 	if (!pco)
 		return NULL;
 
+	/*
+	 * digest-only objects are checked only when no key is given, HMAC ones
+	 * take the shared secret (bytes) in place of the public key. Anyone can
+	 * make a digest-only object, so it fails when any key is given, and an
+	 * HMAC one isn't signed by the holder of a public key either; otherwise
+	 * they would verify as signed by whatever key the caller expects.
+	 */
+	alg = digest_sign_alg_of(content_object->buf, pco);
+	if ((alg == DIGEST_SIGN_SHA256 && py_pub_key != Py_None)
+			|| (alg == DIGEST_SIGN_HMAC_SHA256
+			&& CCNObject_IsValid(PKEY_PUB, py_pub_key)))
+		Py_RETURN_FALSE;
+
+	if (alg == DIGEST_SIGN_SHA256 || alg == DIGEST_SIGN_HMAC_SHA256) {
+		if (alg == DIGEST_SIGN_HMAC_SHA256 && !PyBytes_Check(py_pub_key)) {
+			PyErr_SetString(PyExc_TypeError, "argument 2 must be the shared"
+					" secret for HMAC signed ContentObject");
+			return NULL;
+		}
+
+		if (alg == DIGEST_SIGN_SHA256) {
+			secret = NULL;
+			secret_len = 0;
+		} else {
+			secret = PyBytes_AS_STRING(py_pub_key);
+			secret_len = PyBytes_GET_SIZE(py_pub_key);
+		}
+
+		TRACE_BEGIN("verify");
+		if (content_object->length < GIL_MINSIZE)
+			r = digest_sign_verify(content_object->buf, pco, secret,
+					secret_len);
+		else {
+			Py_BEGIN_ALLOW_THREADS
+			r = digest_sign_verify(content_object->buf, pco, secret,
+					secret_len);
+			Py_END_ALLOW_THREADS
+		}
+		TRACE_END("verify");
+
+		return PyBool_FromLong(r);
+	}
+
+	if (!CCNObject_IsValid(PKEY_PUB, py_pub_key)) {
+		PyErr_SetString(PyExc_TypeError, "argument 2 must be CCN public key");
+		return NULL;
+	}
+
 	pub_key = CCNObject_Get(PKEY_PUB, py_pub_key);
 
-	r = ccn_verify_signature(content_object->buf, content_object->length, pco,
-			pub_key);
+	TRACE_BEGIN("verify");
+	Py_BEGIN_ALLOW_THREADS
+	if (merkle_has_witness(pco)) {
+		const unsigned char *msg = content_object->buf;
+		const struct ccn_parsed_ContentObject *cpco = pco;
+
+		r = merkle_verify_ContentObjects(&msg, &cpco, 1, pub_key);
+	} else
+		r = ccn_verify_signature(content_object->buf, content_object->length,
+				pco, pub_key);
+	Py_END_ALLOW_THREADS
+	TRACE_END("verify");
 	if (r < 0) {
 		PyErr_SetString(g_PyExc_CCNSignatureError, "error verifying signature");
 		return NULL;
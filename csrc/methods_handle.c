@@ -10,6 +10,15 @@
 #include <ccn/ccn_private.h>
 #include <ccn/keystore.h>
 #include <ccn/reg_mgmt.h>
+#include <ccn/schedule.h>
+
+#include <errno.h>
+#include <limits.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <sys/uio.h>
+#include <unistd.h>
 
 #include "pyccn.h"
 #include "util.h"
@@ -19,6 +28,11 @@
 #include "methods_interest.h"
 #include "methods_key.h"
 #include "objects.h"
+#include "output.h"
+#include "pit.h"
+#include "queue.h"
+#include "stats.h"
+#include "trace.h"
 
 static PyObject *
 UpcallInfo_obj_from_ccn(enum ccn_upcall_kind upcall_kind,
@@ -59,6 +73,10 @@ UpcallInfo_obj_from_ccn(enum ccn_upcall_kind upcall_kind,
 				ui->pco->offset[CCN_PCO_E]);
 		JUMP_IF_NEG_MEM(r, error);
 
+		r = _pyccn_content_object_set_parsed(py_data, ui->pco,
+				ui->content_comps);
+		JUMP_IF_NEG(r, error);
+
 		py_o = ContentObject_obj_from_ccn(py_data);
 		Py_CLEAR(py_data);
 		JUMP_IF_NULL(py_o, error);
@@ -74,12 +92,20 @@ UpcallInfo_obj_from_ccn(enum ccn_upcall_kind upcall_kind,
 			upcall_kind == CCN_UPCALL_INTEREST_TIMED_OUT ||
 			upcall_kind == CCN_UPCALL_CONTENT_UNVERIFIED ||
 			upcall_kind == CCN_UPCALL_CONTENT_BAD) {
+		struct ccn_parsed_interest *pi;
+
 		py_data = CCNObject_New_charbuf(INTEREST, &data);
 		JUMP_IF_NULL(py_data, error);
 		r = ccn_charbuf_append(data, ui->interest_ccnb,
 				ui->pi->offset[CCN_PI_E]);
 		JUMP_IF_NEG_MEM(r, error);
 
+		/* ccn already parsed it for us */
+		pi = malloc(sizeof(*pi));
+		JUMP_IF_NULL_MEM(pi, error);
+		memcpy(pi, ui->pi, sizeof(*pi));
+		_pyccn_interest_set_pi(py_data, pi);
+
 		py_o = Interest_obj_from_ccn(py_data);
 		Py_CLEAR(py_data);
 		JUMP_IF_NULL(py_o, error);
@@ -97,6 +123,174 @@ error:
 	return NULL;
 }
 
+static long long
+now_us(void)
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+
+	return tv.tv_sec * 1000000LL + tv.tv_usec;
+}
+
+static void
+schedule_gettime(const struct ccn_gettime *UNUSED(self),
+		struct ccn_timeval *result)
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	result->s = tv.tv_sec;
+	result->micros = tv.tv_usec;
+}
+
+static struct ccn_gettime g_schedule_clock = {
+	"pyccn", schedule_gettime, 1000000, NULL
+};
+
+/*
+ * Returns how long to wait (in ms) before re-expressing the interest or
+ * -1 if the policy says we should give up
+ */
+static int
+retry_delay(struct retry_state *retry)
+{
+	long long delay;
+	int i;
+
+	if (retry->retries >= retry->max_retries)
+		return -1;
+
+	delay = retry->backoff_ms;
+	for (i = 0; i < retry->retries; i++) {
+		if (retry->max_backoff_ms > 0 && delay >= retry->max_backoff_ms)
+			break;
+		delay *= 2;
+	}
+	if (retry->max_backoff_ms > 0 && delay > retry->max_backoff_ms)
+		delay = retry->max_backoff_ms;
+
+	if (retry->jitter > 0.0 && delay > 0)
+		delay += (long long) (delay * retry->jitter *
+				(2.0 * random() / RAND_MAX - 1.0));
+	if (delay < 0)
+		delay = 0;
+
+	if (retry->deadline_us && now_us() + delay * 1000 >= retry->deadline_us)
+		return -1;
+
+	retry->retries++;
+
+	return delay;
+}
+
+static int
+retry_reexpress(struct ccn_schedule *UNUSED(sched), void *UNUSED(clienth),
+		struct ccn_scheduled_event *ev, int flags)
+{
+	struct pyccn_closure *closure = ev->evdata;
+	struct retry_state *retry = closure->retry;
+	struct ccn_upcall_info info;
+	int r = -1;
+
+	assert(retry->ev == ev);
+	retry->ev = NULL;
+
+	if (!(flags & CCN_SCHEDULE_CANCEL)) {
+		r = ccn_express_interest(retry->handle, retry->name, &closure->closure,
+				retry->templ);
+		debug("re-expressed interest (retry %d): %d\n", retry->retries, r);
+	}
+
+	if (r >= 0) {
+		/* ccn holds the closure again, it'll send its own FINAL */
+		retry->final_deferred = 0;
+		stats_inc(closure->handle_data->stats, reexpressed);
+		return 0;
+	}
+
+	/* we swallowed ccn's FINAL while waiting, now it's time to deliver it */
+	if (retry->final_deferred) {
+		retry->final_deferred = 0;
+		memset(&info, 0, sizeof(info));
+		info.h = retry->handle;
+		closure->closure.p(&closure->closure, CCN_UPCALL_FINAL, &info);
+	}
+
+	return 0;
+}
+
+/*
+ * Delayed retries are run from ccn's scheduler, it's created with the first
+ * one. This runs from an upcall, on the thread that runs ccn, so it doesn't
+ * race with other users of the handle (interests can be submitted from any
+ * thread).
+ */
+static struct ccn_schedule *
+retry_schedule(struct ccn *h, struct handle_data *handle_data)
+{
+	struct ccn_schedule *schedule;
+
+	schedule = ccn_get_schedule(h);
+	if (schedule)
+		return schedule;
+
+	assert(handle_data && !handle_data->schedule);
+	handle_data->schedule = ccn_schedule_create(h, &g_schedule_clock);
+	if (!handle_data->schedule)
+		return NULL;
+	ccn_set_schedule(h, handle_data->schedule);
+	srandom((unsigned) (now_us() ^ getpid()));
+
+	return handle_data->schedule;
+}
+
+/*
+ * Applies the retransmission policy, returns 1 if the upcall was handled
+ * and shouldn't be passed to the application
+ */
+static int
+retry_upcall(struct pyccn_closure *closure, enum ccn_upcall_kind upcall_kind,
+		struct ccn_upcall_info *info, enum ccn_upcall_res *res)
+{
+	struct retry_state *retry = closure->retry;
+	struct ccn_schedule *schedule;
+	int delay;
+
+	if (upcall_kind == CCN_UPCALL_FINAL && retry->ev) {
+		retry->final_deferred = 1;
+		*res = CCN_UPCALL_RESULT_OK;
+		return 1;
+	}
+
+	if (upcall_kind != CCN_UPCALL_INTEREST_TIMED_OUT)
+		return 0;
+
+	/* before retry_delay(), it seeds the jitter */
+	schedule = retry->backoff_ms > 0 ?
+			retry_schedule(info->h, closure->handle_data) : NULL;
+
+	delay = retry_delay(retry);
+	if (delay < 0)
+		return 0;
+
+	if (delay == 0) {
+		*res = CCN_UPCALL_RESULT_REEXPRESS;
+		return 1;
+	}
+
+	retry->ev = schedule ? ccn_schedule_event(schedule, delay * 1000,
+			retry_reexpress, closure, 0) : NULL;
+	if (!retry->ev) {
+		/* better retry now, than not at all */
+		*res = CCN_UPCALL_RESULT_REEXPRESS;
+		return 1;
+	}
+
+	*res = CCN_UPCALL_RESULT_OK;
+	return 1;
+}
+
 static enum ccn_upcall_res
 ccn_upcall_handler(struct ccn_closure *selfp,
 		enum ccn_upcall_kind upcall_kind,
@@ -105,13 +299,45 @@ ccn_upcall_handler(struct ccn_closure *selfp,
 	PyObject *upcall_method = NULL, *py_upcall_info = NULL;
 	PyObject *py_selfp, *py_closure, *arglist, *result;
 	PyGILState_STATE gstate;
+	struct pyccn_closure *closure = (struct pyccn_closure *) selfp;
+	struct pyccn_pit *pit = NULL;
+	struct pyccn_stats *stats;
+	enum ccn_upcall_res res;
+	long long start;
 
 	debug("upcall_handler dispatched kind %d\n", upcall_kind);
 
 	assert(selfp);
 	assert(selfp->data);
+	assert(closure->handle_data);
+
+	stats = closure->handle_data->stats;
+	stats_upcall(stats, upcall_kind);
 
+	if (closure->retry && retry_upcall(closure, upcall_kind, info, &res)) {
+		if (res == CCN_UPCALL_RESULT_REEXPRESS)
+			stats_inc(stats, reexpressed);
+		return res;
+	}
+
+	/* the same request is already being handled by the application */
+	if (upcall_kind == CCN_UPCALL_INTEREST && closure->aggregate &&
+			closure->handle_data->pit) {
+		int r;
+
+		pit = closure->handle_data->pit;
+		r = pit_add(pit, info->interest_ccnb, info->pi, &res);
+		if (r == PIT_AGGREGATED)
+			return res;
+		else if (r < 0)
+			pit = NULL;
+	}
+
+	TRACE_BEGIN("upcall");
+
+	TRACE_BEGIN("gil");
 	gstate = PyGILState_Ensure();
+	TRACE_END("gil");
 
 	/* equivalent of selfp, wrapped into PyCapsule */
 	py_selfp = selfp->data;
@@ -122,7 +348,9 @@ ccn_upcall_handler(struct ccn_closure *selfp,
 	JUMP_IF_NULL(upcall_method, error);
 
 	debug("Generating UpcallInfo\n");
+	TRACE_BEGIN("upcall_info");
 	py_upcall_info = UpcallInfo_obj_from_ccn(upcall_kind, info);
+	TRACE_END("upcall_info");
 	JUMP_IF_NULL(py_upcall_info, error);
 	debug("Done generating UpcallInfo\n");
 
@@ -131,7 +359,11 @@ ccn_upcall_handler(struct ccn_closure *selfp,
 
 	debug("Calling upcall\n");
 
+	TRACE_BEGIN("python");
+	start = now_us();
 	result = PyObject_CallObject(upcall_method, arglist);
+	stats_upcall_latency(stats, now_us() - start);
+	TRACE_END("python");
 
 	Py_CLEAR(upcall_method);
 	Py_DECREF(arglist);
@@ -140,11 +372,20 @@ ccn_upcall_handler(struct ccn_closure *selfp,
 	if (upcall_kind == CCN_UPCALL_FINAL)
 		Py_DECREF(py_selfp);
 
-	long r = _pyccn_Int_AsLong(result);
+	res = _pyccn_Int_AsLong(result);
+	Py_DECREF(result);
+
+	if (res == CCN_UPCALL_RESULT_REEXPRESS)
+		stats_inc(stats, reexpressed);
 
 	PyGILState_Release(gstate);
 
-	return r;
+	if (pit)
+		pit_set_result(pit, info->interest_ccnb, info->pi, res);
+
+	TRACE_END("upcall");
+
+	return res;
 
 error:
 	debug("Error routine called (upcall_kind = %d)\n", upcall_kind);
@@ -158,6 +399,13 @@ error:
 		PyErr_Print();
 
 	PyGILState_Release(gstate);
+
+	/* aggregated duplicates get the same answer */
+	if (pit)
+		pit_set_result(pit, info->interest_ccnb, info->pi,
+				CCN_UPCALL_RESULT_ERR);
+
+	TRACE_END("upcall");
 	return CCN_UPCALL_RESULT_ERR;
 }
 
@@ -203,25 +451,29 @@ _pyccn_cmd_create(PyObject *UNUSED(self), PyObject *UNUSED(args))
 	return CCNObject_New(HANDLE, ccn_handle);
 }
 
-// Second argument to ccn_connect not yet supported
-//
 // arguments:  CObject that is an opaque reference to the ccn handle, generated by _pyccn_ccn_create
+//             optional path of the daemon's unix socket (None for default)
 // returns:    integer, non-negative if ok (file descriptor)
 //
 
 PyObject *
-_pyccn_cmd_connect(PyObject *UNUSED(self), PyObject *py_ccn_handle)
+_pyccn_cmd_connect(PyObject *UNUSED(self), PyObject *args)
 {
+	PyObject *py_ccn_handle;
+	const char *sockname = NULL;
 	struct ccn *handle;
 	int r;
 
+	if (!PyArg_ParseTuple(args, "O|z", &py_ccn_handle, &sockname))
+		return NULL;
+
 	if (!CCNObject_IsValid(HANDLE, py_ccn_handle)) {
 		PyErr_SetString(PyExc_TypeError, "Must pass a CCN Handle");
 		return NULL;
 	}
 	handle = CCNObject_Get(HANDLE, py_ccn_handle);
 
-	r = ccn_connect(handle, NULL);
+	r = ccn_connect(handle, sockname);
 	if (r < 0) {
 		int err = ccn_geterror(handle);
 		return PyErr_Format(g_PyExc_CCNError, "Unable to connect with"
@@ -272,10 +524,33 @@ _pyccn_get_connection_fd(PyObject *UNUSED(self), PyObject *py_handle)
 	return Py_BuildValue("i", ccn_get_connection_fd(handle));
 }
 
+/*
+ * Finishes a message put_many() left half written (see output.c), needs to
+ * be called before ccn writes anything outside of run(). Waits up to
+ * timeoutms (-1 forever) for ccnd to take it, raises IOError after that.
+ */
+static int
+handle_output_sync(struct ccn *handle, struct handle_data *handle_data,
+		int timeoutms)
+{
+	int r, err;
+
+	Py_BEGIN_ALLOW_THREADS
+	r = output_sync(handle_data->output, handle, timeoutms);
+	err = errno;
+	Py_END_ALLOW_THREADS
+
+	if (r < 0)
+		PyErr_Format(PyExc_IOError, "%s [%d]", strerror(err), err);
+
+	return r;
+}
+
 PyObject *
 _pyccn_cmd_process_scheduled_operations(PyObject *UNUSED(self), PyObject *py_handle)
 {
 	struct ccn *handle;
+	struct handle_data *handle_data;
 
 	if (!CCNObject_IsValid(HANDLE, py_handle)) {
 		PyErr_SetString(PyExc_TypeError, "Expected CCN handle");
@@ -283,6 +558,12 @@ _pyccn_cmd_process_scheduled_operations(PyObject *UNUSED(self), PyObject *py_han
 	}
 
 	handle = CCNObject_Get(HANDLE, py_handle);
+	handle_data = PyCapsule_GetContext(py_handle);
+	assert(handle_data);
+
+	/* retries are expressed from here */
+	if (handle_output_sync(handle, handle_data, OUTPUT_SYNC_TIMEOUT) < 0)
+		return NULL;
 
 	return Py_BuildValue("i", ccn_process_scheduled_operations(handle));
 }
@@ -291,6 +572,7 @@ PyObject *
 _pyccn_cmd_output_is_pending(PyObject *UNUSED(self), PyObject *py_handle)
 {
 	struct ccn *handle;
+	struct handle_data *handle_data;
 	PyObject *res;
 
 	if (!CCNObject_IsValid(HANDLE, py_handle)) {
@@ -299,12 +581,124 @@ _pyccn_cmd_output_is_pending(PyObject *UNUSED(self), PyObject *py_handle)
 	}
 
 	handle = CCNObject_Get(HANDLE, py_handle);
+	handle_data = PyCapsule_GetContext(py_handle);
+	assert(handle_data);
 
-	res = ccn_output_is_pending(handle) ? Py_True : Py_False;
+	res = output_is_pending(handle_data->output, handle) ? Py_True : Py_False;
 
 	return Py_INCREF(res), res;
 }
 
+/* bytes of content objects waiting to be sent, safe from any thread */
+PyObject *
+_pyccn_cmd_pending_output_bytes(PyObject *UNUSED(self), PyObject *py_handle)
+{
+	struct handle_data *handle_data;
+
+	if (!CCNObject_IsValid(HANDLE, py_handle)) {
+		PyErr_SetString(PyExc_TypeError, "Expected CCN handle");
+		return NULL;
+	}
+
+	handle_data = PyCapsule_GetContext(py_handle);
+	assert(handle_data);
+
+	return PyLong_FromSize_t(output_pending_bytes(handle_data->output));
+}
+
+/* safe from any thread */
+PyObject *
+_pyccn_cmd_output_is_blocked(PyObject *UNUSED(self), PyObject *py_handle)
+{
+	struct handle_data *handle_data;
+
+	if (!CCNObject_IsValid(HANDLE, py_handle)) {
+		PyErr_SetString(PyExc_TypeError, "Expected CCN handle");
+		return NULL;
+	}
+
+	handle_data = PyCapsule_GetContext(py_handle);
+	assert(handle_data);
+
+	return PyBool_FromLong(output_is_blocked(handle_data->output));
+}
+
+PyObject *
+_pyccn_cmd_set_output_watermarks(PyObject *UNUSED(self), PyObject *args)
+{
+	PyObject *py_handle;
+	struct handle_data *handle_data;
+	Py_ssize_t low, high;
+
+	if (!PyArg_ParseTuple(args, "Onn", &py_handle, &low, &high))
+		return NULL;
+
+	if (!CCNObject_IsValid(HANDLE, py_handle)) {
+		PyErr_SetString(PyExc_TypeError, "Must pass a CCN handle");
+		return NULL;
+	}
+
+	if (low < 0 || high < 0) {
+		PyErr_SetString(PyExc_ValueError, "Watermarks can't be negative");
+		return NULL;
+	}
+	if (high && low > high) {
+		PyErr_SetString(PyExc_ValueError, "Low watermark is above the high"
+				" one");
+		return NULL;
+	}
+
+	handle_data = PyCapsule_GetContext(py_handle);
+	assert(handle_data);
+
+	output_set_watermarks(handle_data->output, low, high);
+
+	Py_RETURN_NONE;
+}
+
+/* callable is called from run() when the output is unblocked */
+PyObject *
+_pyccn_cmd_set_writable_callback(PyObject *UNUSED(self), PyObject *args)
+{
+	PyObject *py_handle, *py_callable;
+	struct handle_data *handle_data;
+
+	if (!PyArg_ParseTuple(args, "OO", &py_handle, &py_callable))
+		return NULL;
+
+	if (!CCNObject_IsValid(HANDLE, py_handle)) {
+		PyErr_SetString(PyExc_TypeError, "Must pass a CCN handle");
+		return NULL;
+	}
+
+	if (py_callable != Py_None && !PyCallable_Check(py_callable)) {
+		PyErr_SetString(PyExc_TypeError, "Callback needs to be callable");
+		return NULL;
+	}
+
+	handle_data = PyCapsule_GetContext(py_handle);
+	assert(handle_data);
+
+	output_set_writable_callback(handle_data->output,
+			py_callable == Py_None ? NULL : py_callable);
+
+	Py_RETURN_NONE;
+}
+
+static struct pyccn_queue *
+handle_queue(struct handle_data *handle_data)
+{
+	assert(handle_data);
+
+	if (!handle_data->queue) {
+		handle_data->queue = queue_create();
+		if (!handle_data->queue)
+			return (void *) PyErr_SetFromErrno(PyExc_IOError);
+	}
+
+	return handle_data->queue;
+}
+
 PyObject *
 _pyccn_cmd_run(PyObject *UNUSED(self), PyObject *args)
 {
@@ -312,6 +706,7 @@ _pyccn_cmd_run(PyObject *UNUSED(self), PyObject *args)
 	PyObject *py_handle;
 	int timeoutms = -1;
 	struct ccn *handle;
+	struct handle_data *handle_data;
 	void *state_slot;
 
 	if (!PyArg_ParseTuple(args, "O|i", &py_handle, &timeoutms))
@@ -322,15 +717,22 @@ _pyccn_cmd_run(PyObject *UNUSED(self), PyObject *args)
 		return NULL;
 	}
 	handle = CCNObject_Get(HANDLE, py_handle);
+	handle_data = PyCapsule_GetContext(py_handle);
+
+	/* we need it to be woken up by other threads */
+	if (!handle_queue(handle_data))
+		return NULL;
 
 	state_slot = _pyccn_run_state_add(handle);
 	if (!state_slot)
 		return NULL;
 
 	Py_BEGIN_ALLOW_THREADS
-	debug("Entering ccn_run()\n");
-	r = ccn_run(handle, timeoutms);
-	debug("Exited ccn_run()\n");
+	debug("Entering queue_run()\n");
+	TRACE_BEGIN("run");
+	r = queue_run(handle, handle_data, timeoutms);
+	TRACE_END("run");
+	debug("Exited queue_run()\n");
 	Py_END_ALLOW_THREADS
 
 	_pyccn_run_state_clear(state_slot);
@@ -355,6 +757,7 @@ _pyccn_cmd_set_run_timeout(PyObject *UNUSED(self), PyObject *args)
 	PyObject *py_handle;
 	int timeoutms = 0;
 	struct ccn *handle;
+	struct handle_data *handle_data;
 
 	if (!PyArg_ParseTuple(args, "O|i", &py_handle, &timeoutms))
 		return NULL;
@@ -364,23 +767,104 @@ _pyccn_cmd_set_run_timeout(PyObject *UNUSED(self), PyObject *args)
 		return NULL;
 	}
 	handle = CCNObject_Get(HANDLE, py_handle);
+	handle_data = PyCapsule_GetContext(py_handle);
 
-	r = ccn_set_run_timeout(handle, timeoutms);
+	/* run() loops in queue_run(), ccn_run() only handles one pass there */
+	if (handle_data->queue)
+		r = queue_set_run_timeout(handle_data->queue, timeoutms);
+	else
+		r = ccn_set_run_timeout(handle, timeoutms);
 
 	return Py_BuildValue("i", r);
 }
 
+/*
+ * Calls callable(*args) on the thread executing run(), or in the next run()
+ * if there's none. Safe to call from any thread.
+ */
 PyObject *
-_pyccn_cmd_express_interest(PyObject *UNUSED(self), PyObject *args)
+_pyccn_cmd_submit_call(PyObject *UNUSED(self), PyObject *args)
+{
+	PyObject *py_handle, *py_callable, *py_args;
+	struct handle_data *handle_data;
+	struct queue_item *item;
+
+	if (!PyArg_ParseTuple(args, "OOO!", &py_handle, &py_callable,
+			&PyTuple_Type, &py_args))
+		return NULL;
+
+	if (!CCNObject_IsValid(HANDLE, py_handle)) {
+		PyErr_SetString(PyExc_TypeError, "Must pass a CCN handle");
+		return NULL;
+	}
+	handle_data = PyCapsule_GetContext(py_handle);
+
+	if (!PyCallable_Check(py_callable)) {
+		PyErr_SetString(PyExc_TypeError, "Argument 2 needs to be callable");
+		return NULL;
+	}
+
+	if (!handle_queue(handle_data))
+		return NULL;
+
+	item = queue_item_new(QUEUE_CALL);
+	if (!item)
+		return PyErr_NoMemory();
+
+	Py_INCREF(py_callable);
+	item->callable = py_callable;
+	Py_INCREF(py_args);
+	item->args = py_args;
+
+	queue_push(handle_data->queue, item);
+
+	Py_RETURN_NONE;
+}
+
+/*
+ * With verification deferred ccn doesn't verify content itself, it's all
+ * passed to closures as CONTENT_UNVERIFIED. Returns the previous setting.
+ */
+PyObject *
+_pyccn_cmd_defer_verification(PyObject *UNUSED(self), PyObject *args)
+{
+	PyObject *py_handle;
+	struct ccn *handle;
+	int defer, r;
+
+	if (!PyArg_ParseTuple(args, "Oi", &py_handle, &defer))
+		return NULL;
+
+	if (!CCNObject_IsValid(HANDLE, py_handle)) {
+		PyErr_SetString(PyExc_TypeError, "Must pass a CCN handle");
+		return NULL;
+	}
+	handle = CCNObject_Get(HANDLE, py_handle);
+
+	r = ccn_defer_verification(handle, defer ? 1 : 0);
+	if (r < 0)
+		return PyErr_Format(g_PyExc_CCNError, "Unable to change deferred"
+				" verification");
+
+	return PyBool_FromLong(r);
+}
+
+static PyObject *
+express_interest(PyObject *args, int submit)
 {
 	PyObject *py_o, *py_ccn, *py_name, *py_closure, *py_templ;
+	PyObject *py_retry = Py_None;
 	int r;
 	struct ccn *handle;
+	struct handle_data *handle_data;
 	struct ccn_charbuf *name, *templ;
 	struct ccn_closure *cl;
+	struct retry_state *retry = NULL;
+	struct queue_item *item;
+	int deadline_ms;
 
-	if (!PyArg_ParseTuple(args, "OOOO", &py_ccn, &py_name, &py_closure,
-			&py_templ))
+	if (!PyArg_ParseTuple(args, "OOOO|O", &py_ccn, &py_name, &py_closure,
+			&py_templ, &py_retry))
 		return NULL;
 
 	if (strcmp(py_ccn->ob_type->tp_name, "CCN")) {
@@ -409,8 +893,12 @@ _pyccn_cmd_express_interest(PyObject *UNUSED(self), PyObject *args)
 	if (!py_o)
 		return NULL;
 	handle = CCNObject_Get(HANDLE, py_o);
+	handle_data = PyCapsule_GetContext(py_o);
 	Py_DECREF(py_o);
 
+	if (submit && !handle_queue(handle_data))
+		return NULL;
+
 	py_o = PyObject_GetAttrString(py_name, "ccn_data");
 	if (!py_o)
 		return NULL;
@@ -426,8 +914,45 @@ _pyccn_cmd_express_interest(PyObject *UNUSED(self), PyObject *args)
 	} else
 		templ = NULL;
 
+	/* retransmission policy: (retries, backoff, max backoff, jitter, deadline) */
+	if (py_retry != Py_None) {
+		retry = calloc(1, sizeof(*retry));
+		JUMP_IF_NULL_MEM(retry, error);
+
+		if (!PyArg_ParseTuple(py_retry, "iiidi:retry policy",
+				&retry->max_retries, &retry->backoff_ms,
+				&retry->max_backoff_ms, &retry->jitter, &deadline_ms))
+			goto error;
+
+		if (retry->max_retries < 0 || retry->backoff_ms < 0 ||
+				retry->jitter < 0.0 || retry->jitter > 1.0) {
+			PyErr_SetString(PyExc_ValueError, "Invalid retry policy");
+			goto error;
+		}
+
+		if (deadline_ms >= 0)
+			retry->deadline_us = now_us() + deadline_ms * 1000LL;
+
+		retry->handle = handle;
+		retry->name = ccn_charbuf_create();
+		JUMP_IF_NULL_MEM(retry->name, error);
+		r = ccn_charbuf_append_charbuf(retry->name, name);
+		JUMP_IF_NEG_MEM(r, error);
+
+		if (templ) {
+			retry->templ = ccn_charbuf_create();
+			JUMP_IF_NULL_MEM(retry->templ, error);
+			r = ccn_charbuf_append_charbuf(retry->templ, templ);
+			JUMP_IF_NEG_MEM(r, error);
+		}
+	}
+
 	// Build the closure
 	py_o = CCNObject_New_Closure(&cl);
+	JUMP_IF_NULL(py_o, error);
+	((struct pyccn_closure *) cl)->handle_data = handle_data;
+	((struct pyccn_closure *) cl)->retry = retry;
+	retry = NULL; /* owned by the closure now */
 	cl->p = ccn_upcall_handler;
 	cl->data = py_o;
 	Py_INCREF(py_closure); /* We don't want py_closure to be dealocated */
@@ -444,6 +969,36 @@ _pyccn_cmd_express_interest(PyObject *UNUSED(self), PyObject *args)
 	PyObject_GC_Track(py_closure);
 #endif
 
+	/* the loop thread will express it, see queue.c */
+	if (submit) {
+		item = queue_item_new(QUEUE_EXPRESS_INTEREST);
+		if (!item) {
+			Py_DECREF(py_o);
+			return PyErr_NoMemory();
+		}
+		item->closure = cl;
+		item->data = ccn_charbuf_create();
+		r = item->data ? ccn_charbuf_append_charbuf(item->data, name) : -1;
+		if (r >= 0 && templ) {
+			item->templ = ccn_charbuf_create();
+			r = item->templ ? ccn_charbuf_append_charbuf(item->templ, templ) : -1;
+		}
+		if (r < 0) {
+			queue_item_free(item);
+			Py_DECREF(py_o);
+			return PyErr_NoMemory();
+		}
+
+		queue_push(handle_data->queue, item);
+
+		Py_RETURN_NONE;
+	}
+
+	if (handle_output_sync(handle, handle_data, OUTPUT_SYNC_TIMEOUT) < 0) {
+		Py_DECREF(py_o);
+		return NULL;
+	}
+
 	r = ccn_express_interest(handle, name, cl, templ);
 	if (r < 0) {
 		int err = ccn_geterror(handle);
@@ -453,6 +1008,7 @@ _pyccn_cmd_express_interest(PyObject *UNUSED(self), PyObject *args)
 				strerror(err), err);
 		return NULL;
 	}
+	stats_inc(handle_data->stats, interests_expressed);
 
 	/*
 	 * We aren't decreasing reference to py_o, because we're expecting
@@ -460,20 +1016,46 @@ _pyccn_cmd_express_interest(PyObject *UNUSED(self), PyObject *args)
 	 */
 
 	Py_RETURN_NONE;
+
+error:
+	if (retry) {
+		ccn_charbuf_destroy(&retry->name);
+		ccn_charbuf_destroy(&retry->templ);
+		free(retry);
+	}
+	return NULL;
 }
 
 PyObject *
-_pyccn_cmd_set_interest_filter(PyObject *UNUSED(self), PyObject *args)
+_pyccn_cmd_express_interest(PyObject *UNUSED(self), PyObject *args)
 {
+	return express_interest(args, 0);
+}
+
+/* same as express_interest, but safe to call while another thread runs */
+PyObject *
+_pyccn_cmd_submit_express_interest(PyObject *UNUSED(self), PyObject *args)
+{
+	return express_interest(args, 1);
+}
+
+static PyObject *
+set_interest_filter(PyObject *args, PyObject *kwds, int submit)
+{
+	static char *kwlist[] = {"handle", "name", "closure", "forw_flags",
+		"aggregate", NULL};
 	PyObject *py_ccn, *py_name, *py_closure, *py_o;
 	int forw_flags = CCN_FORW_ACTIVE | CCN_FORW_CHILD_INHERIT;
+	int aggregate = 0;
 	struct ccn *handle;
+	struct handle_data *handle_data;
 	struct ccn_charbuf *name;
 	struct ccn_closure *closure;
+	struct queue_item *item;
 	int r;
 
-	if (!PyArg_ParseTuple(args, "OOO|i", &py_ccn, &py_name, &py_closure,
-			&forw_flags))
+	if (!PyArg_ParseTupleAndKeywords(args, kwds, "OOO|ii", kwlist, &py_ccn,
+			&py_name, &py_closure, &forw_flags, &aggregate))
 		return NULL;
 
 	if (!CCNObject_IsValid(HANDLE, py_ccn)) {
@@ -492,8 +1074,19 @@ _pyccn_cmd_set_interest_filter(PyObject *UNUSED(self), PyObject *args)
 	}
 
 	handle = CCNObject_Get(HANDLE, py_ccn);
+	handle_data = PyCapsule_GetContext(py_ccn);
+	assert(handle_data);
 	name = CCNObject_Get(NAME, py_name);
 
+	if (aggregate && !handle_data->pit) {
+		handle_data->pit = pit_create();
+		if (!handle_data->pit)
+			return PyErr_NoMemory();
+	}
+
+	if (submit && !handle_queue(handle_data))
+		return NULL;
+
 	/*
 	 * This code it might be confusing so here is what it does:
 	 * 1. we allocate a closure structure and wrap it into PyCapsule, so we can
@@ -507,12 +1100,36 @@ _pyccn_cmd_set_interest_filter(PyObject *UNUSED(self), PyObject *args)
 	 * 5. we add pointer for our closure class (so we can call correct method)
 	 */
 	py_o = CCNObject_New_Closure(&closure);
+	JUMP_IF_NULL(py_o, error);
 	closure->p = ccn_upcall_handler;
 	closure->data = py_o;
+	((struct pyccn_closure *) closure)->handle_data = handle_data;
+	((struct pyccn_closure *) closure)->aggregate = aggregate;
 	Py_INCREF(py_closure);
 	r = PyCapsule_SetContext(py_o, py_closure);
 	assert(r == 0);
 
+	if (submit) {
+		item = queue_item_new(QUEUE_SET_INTEREST_FILTER);
+		JUMP_IF_NULL_MEM(item, error_closure);
+		item->closure = closure;
+		item->forw_flags = forw_flags;
+		item->data = ccn_charbuf_create();
+		r = item->data ? ccn_charbuf_append_charbuf(item->data, name) : -1;
+		if (r < 0) {
+			queue_item_free(item);
+			PyErr_NoMemory();
+			goto error_closure;
+		}
+
+		queue_push(handle_data->queue, item);
+
+		Py_RETURN_NONE;
+	}
+
+	if (handle_output_sync(handle, handle_data, OUTPUT_SYNC_TIMEOUT) < 0)
+		goto error_closure;
+
 	r = ccn_set_interest_filter_with_flags(handle, name, closure, forw_flags);
 	if (r < 0) {
 		int err = ccn_geterror(handle);
@@ -524,6 +1141,26 @@ _pyccn_cmd_set_interest_filter(PyObject *UNUSED(self), PyObject *args)
 	}
 
 	return Py_BuildValue("i", r);
+
+error_closure:
+	Py_DECREF(py_o);
+error:
+	return NULL;
+}
+
+PyObject *
+_pyccn_cmd_set_interest_filter(PyObject *UNUSED(self), PyObject *args,
+		PyObject *kwds)
+{
+	return set_interest_filter(args, kwds, 0);
+}
+
+/* same as set_interest_filter, but safe to call while another thread runs */
+PyObject *
+_pyccn_cmd_submit_set_interest_filter(PyObject *UNUSED(self), PyObject *args,
+		PyObject *kwds)
+{
+	return set_interest_filter(args, kwds, 1);
 }
 
 // Simple get/put
@@ -535,10 +1172,11 @@ _pyccn_cmd_get(PyObject *UNUSED(self), PyObject *args)
 	PyObject *py_co = NULL, *py_o = NULL;
 	PyObject *py_data = NULL;
 	int r, timeout = 3000;
+	long long start, elapsed;
 	struct ccn *handle;
 	struct ccn_charbuf *name, *interest, *data;
-	struct ccn_parsed_ContentObject *pco;
-	struct ccn_indexbuf *comps;
+	struct content_object_data *context;
+	struct handle_data *handle_data;
 
 	if (!PyArg_ParseTuple(args, "OO|Oi", &py_CCN, &py_Name, &py_Interest,
 			&timeout))
@@ -552,6 +1190,7 @@ _pyccn_cmd_get(PyObject *UNUSED(self), PyObject *args)
 		JUMP_IF_NULL(py_o, exit);
 		handle = CCNObject_Get(HANDLE, py_o);
 		JUMP_IF_NULL(handle, exit);
+		handle_data = PyCapsule_GetContext(py_o);
 		Py_CLEAR(py_o);
 	}
 
@@ -582,15 +1221,28 @@ _pyccn_cmd_get(PyObject *UNUSED(self), PyObject *args)
 
 	py_data = CCNObject_New_charbuf(CONTENT_OBJECT, &data);
 	JUMP_IF_NULL(py_data, exit);
-	pco = calloc(1, sizeof(*pco));
-	_pyccn_content_object_set_pco(py_data, pco);
-	JUMP_IF_NULL_MEM(pco, exit);
-	comps = ccn_indexbuf_create();
-	_pyccn_content_object_set_comps(py_data, comps);
-	JUMP_IF_NULL_MEM(comps, exit);
+	context = PyCapsule_GetContext(py_data);
+	assert(context);
+
+	/* the time it takes counts towards the timeout */
+	start = now_us();
+	if (handle_output_sync(handle, handle_data, timeout) < 0)
+		goto exit;
+	if (timeout > 0) {
+		elapsed = (now_us() - start) / 1000;
+		timeout = elapsed < timeout ? timeout - (int) elapsed : 0;
+	}
+
+	stats_inc(handle_data->stats, interests_expressed);
 
 	Py_BEGIN_ALLOW_THREADS
-	r = ccn_get(handle, name, interest, timeout, data, pco, comps, 0);
+	TRACE_BEGIN("get");
+	r = ccn_get(handle, name, interest, timeout, data, &context->pco,
+			&context->comps, 0);
+	TRACE_END("get");
+
+	/* what's queued can follow, errors show up with the next call */
+	(void) output_sync(handle_data->output, handle, 0);
 	Py_END_ALLOW_THREADS
 
 	debug("ccn_get result=%d\n", r);
@@ -601,10 +1253,14 @@ _pyccn_cmd_get(PyObject *UNUSED(self), PyObject *args)
 		int err = ccn_geterror(handle);
 		if (err)
 			py_co = PyErr_Format(PyExc_IOError, "%s [%d]", strerror(err), err);
-		else
+		else {
+			stats_inc(handle_data->stats, timeouts);
 			py_co = (Py_INCREF(Py_None), Py_None); // timeout
-	} else
+		}
+	} else {
+		context->parsed = 1;
 		py_co = ContentObject_obj_from_ccn(py_data);
+	}
 
 exit:
 	Py_XDECREF(py_data);
@@ -612,13 +1268,376 @@ exit:
 	return py_co;
 }
 
-PyObject * // int
-_pyccn_cmd_put(PyObject *UNUSED(self), PyObject *args)
+/* ms, how long ccn_run() goes while our output queue waits to be fed */
+#define GET_MANY_OUTPUT_SLICE 10
+
+/*
+ * State shared by all interests of one get_many() call. It's reference
+ * counted, because ccn can still hold the closures (and send them FINAL)
+ * after the call returned.
+ */
+struct get_many_state {
+	struct ccn *handle;
+	struct pyccn_stats *stats;
+	struct get_many_item *items;
+	int count;
+	int next; /* first item not yet expressed */
+	int outstanding, max_outstanding;
+	int remaining; /* items without an answer or a final timeout */
+	long long deadline_us;
+	int finished; /* caller returned, ignore anything that arrives */
+	int refcount;
+};
+
+struct get_many_item {
+	struct ccn_closure closure;
+	struct get_many_state *state;
+	struct ccn_charbuf *name, *templ; /* borrowed, only used until finished */
+	struct ccn_charbuf *data;
+	struct ccn_parsed_ContentObject pco;
+	struct ccn_indexbuf *comps;
+	int done; /* 1 - got content, -1 - gave up */
+};
+
+static void
+get_many_state_release(struct get_many_state *state)
+{
+	int i;
+
+	if (--state->refcount > 0)
+		return;
+
+	for (i = 0; i < state->count; i++) {
+		ccn_charbuf_destroy(&state->items[i].data);
+		ccn_indexbuf_destroy(&state->items[i].comps);
+	}
+	free(state->items);
+	free(state);
+}
+
+static enum ccn_upcall_res get_many_upcall(struct ccn_closure *selfp,
+		enum ccn_upcall_kind upcall_kind, struct ccn_upcall_info *info);
+
+static void
+get_many_express_next(struct get_many_state *state)
+{
+	struct get_many_item *item;
+	int r;
+
+	while (!state->finished && state->next < state->count &&
+			(state->max_outstanding <= 0 ||
+			state->outstanding < state->max_outstanding) &&
+			now_us() < state->deadline_us) {
+		item = &state->items[state->next++];
+
+		item->closure.p = get_many_upcall;
+		item->closure.data = item;
+		r = ccn_express_interest(state->handle, item->name, &item->closure,
+				item->templ);
+		if (r < 0) {
+			debug("get_many: unable to express interest %d\n",
+					(int) (item - state->items));
+			item->done = -1;
+			state->remaining--;
+			continue;
+		}
+
+		state->refcount++; /* released on FINAL */
+		state->outstanding++;
+		stats_inc(state->stats, interests_expressed);
+	}
+
+	if (state->remaining == 0)
+		ccn_set_run_timeout(state->handle, 0);
+}
+
+static void
+get_many_item_done(struct get_many_item *item, int done)
+{
+	struct get_many_state *state = item->state;
+
+	item->done = done;
+	state->outstanding--;
+	state->remaining--;
+
+	get_many_express_next(state);
+}
+
+static enum ccn_upcall_res
+get_many_upcall(struct ccn_closure *selfp, enum ccn_upcall_kind upcall_kind,
+		struct ccn_upcall_info *info)
+{
+	struct get_many_item *item = selfp->data;
+	struct get_many_state *state = item->state;
+	int r;
+
+	stats_upcall(state->stats, upcall_kind);
+
+	switch (upcall_kind) {
+	case CCN_UPCALL_FINAL:
+		get_many_state_release(state);
+		return CCN_UPCALL_RESULT_OK;
+
+	case CCN_UPCALL_INTEREST_TIMED_OUT:
+		if (state->finished || item->done)
+			return CCN_UPCALL_RESULT_OK;
+		if (now_us() < state->deadline_us) {
+			stats_inc(state->stats, reexpressed);
+			return CCN_UPCALL_RESULT_REEXPRESS;
+		}
+		get_many_item_done(item, -1);
+		return CCN_UPCALL_RESULT_OK;
+
+	case CCN_UPCALL_CONTENT_UNVERIFIED:
+		/* same as ccn_get() */
+		return CCN_UPCALL_RESULT_VERIFY;
+
+	case CCN_UPCALL_CONTENT:
+		if (state->finished || item->done)
+			return CCN_UPCALL_RESULT_OK;
+
+		item->data = ccn_charbuf_create();
+		item->comps = ccn_indexbuf_create();
+		if (!item->data || !item->comps) {
+			get_many_item_done(item, -1);
+			return CCN_UPCALL_RESULT_ERR;
+		}
+
+		r = ccn_charbuf_append(item->data, info->content_ccnb,
+				info->pco->offset[CCN_PCO_E]);
+		if (r >= 0)
+			r = ccn_indexbuf_append(item->comps, info->content_comps->buf,
+					info->content_comps->n);
+		memcpy(&item->pco, info->pco, sizeof(item->pco));
+
+		get_many_item_done(item, r < 0 ? -1 : 1);
+		return r < 0 ? CCN_UPCALL_RESULT_ERR : CCN_UPCALL_RESULT_OK;
+
+	case CCN_UPCALL_CONTENT_BAD:
+		if (!state->finished && !item->done)
+			get_many_item_done(item, -1);
+		return CCN_UPCALL_RESULT_OK;
+
+	default:
+		return CCN_UPCALL_RESULT_ERR;
+	}
+}
+
+/*
+ * Fetches all names (or interests) at once, with at most max_outstanding
+ * of them expressed at the same time. Returns a list in the same order,
+ * with None for anything that didn't arrive within timeoutms.
+ */
+PyObject *
+_pyccn_cmd_get_many(PyObject *UNUSED(self), PyObject *args)
+{
+	PyObject *py_CCN, *py_items, *py_seq = NULL, *py_refs = NULL;
+	PyObject *py_o = NULL, *py_item, *py_name, *py_data;
+	PyObject *py_result = NULL, *py_res = NULL;
+	int timeout = 3000, max_outstanding = 0;
+	int i, r, run_err = 0, err = 0;
+	long long left;
+	struct ccn *handle;
+	struct handle_data *handle_data;
+	struct get_many_state *state = NULL;
+	struct get_many_item *item;
+	struct ccn_charbuf *data;
+	void *state_slot;
+
+	if (!PyArg_ParseTuple(args, "OO|ii", &py_CCN, &py_items, &timeout,
+			&max_outstanding))
+		return NULL;
+
+	if (strcmp(py_CCN->ob_type->tp_name, "CCN")) {
+		PyErr_SetString(PyExc_TypeError, "Must pass a CCN as arg 1");
+		return NULL;
+	}
+
+	py_o = PyObject_GetAttrString(py_CCN, "ccn_data");
+	JUMP_IF_NULL(py_o, exit);
+	handle = CCNObject_Get(HANDLE, py_o);
+	handle_data = PyCapsule_GetContext(py_o);
+	Py_CLEAR(py_o);
+
+	if (_pyccn_run_state_find(handle)) {
+		PyErr_SetString(g_PyExc_CCNError, "get_many() can't be used while"
+				" ccn_run() is executing on the same handle");
+		return NULL;
+	}
+
+	py_seq = PySequence_Fast(py_items, "Must pass a sequence of Names or"
+			" Interests as arg 2");
+	JUMP_IF_NULL(py_seq, exit);
+
+	/* keeps the buffers we borrow alive */
+	py_refs = PyList_New(0);
+	JUMP_IF_NULL(py_refs, exit);
+
+	state = calloc(1, sizeof(*state));
+	JUMP_IF_NULL_MEM(state, exit);
+	state->refcount = 1;
+	state->handle = handle;
+	state->stats = handle_data->stats;
+	state->count = (int) PySequence_Fast_GET_SIZE(py_seq);
+	state->remaining = state->count;
+	state->max_outstanding = max_outstanding;
+
+	if (state->count > 0) {
+		state->items = calloc(state->count, sizeof(*state->items));
+		JUMP_IF_NULL_MEM(state->items, exit);
+	}
+
+	for (i = 0; i < state->count; i++) {
+		item = &state->items[i];
+		item->state = state;
+
+		py_item = PySequence_Fast_GET_ITEM(py_seq, i);
+		if (!strcmp(py_item->ob_type->tp_name, "Interest")) {
+			py_o = PyObject_GetAttrString(py_item, "ccn_data");
+			JUMP_IF_NULL(py_o, exit);
+			item->templ = CCNObject_Get(INTEREST, py_o);
+			r = PyList_Append(py_refs, py_o);
+			Py_CLEAR(py_o);
+			JUMP_IF_NEG(r, exit);
+
+			py_name = PyObject_GetAttrString(py_item, "name");
+			JUMP_IF_NULL(py_name, exit);
+		} else {
+			py_name = py_item;
+			Py_INCREF(py_name);
+		}
+
+		if (strcmp(py_name->ob_type->tp_name, "Name")) {
+			Py_DECREF(py_name);
+			PyErr_Format(PyExc_TypeError, "Item %d isn't a Name or an"
+					" Interest with a Name", i);
+			goto exit;
+		}
+
+		py_o = PyObject_GetAttrString(py_name, "ccn_data");
+		Py_DECREF(py_name);
+		JUMP_IF_NULL(py_o, exit);
+		item->name = CCNObject_Get(NAME, py_o);
+		r = PyList_Append(py_refs, py_o);
+		Py_CLEAR(py_o);
+		JUMP_IF_NEG(r, exit);
+	}
+
+	state->deadline_us = now_us() + timeout * 1000LL;
+	if (handle_output_sync(handle, handle_data, timeout > 0 ? timeout : 0) < 0)
+		goto exit;
+
+	state_slot = _pyccn_run_state_add(handle);
+	JUMP_IF_NULL(state_slot, exit);
+
+	Py_BEGIN_ALLOW_THREADS
+	TRACE_BEGIN("get_many");
+	get_many_express_next(state);
+
+	while (state->remaining > 0) {
+		left = (state->deadline_us - now_us()) / 1000;
+		if (left <= 0)
+			break;
+
+		/* keep queued content objects going out meanwhile */
+		r = output_sync(handle_data->output, handle,
+				left > INT_MAX ? INT_MAX : (int) left);
+		if (r < 0) {
+			/* ran out of time, what didn't arrive is None */
+			if (errno == ETIMEDOUT)
+				break;
+			run_err = 1;
+			err = errno;
+			break;
+		}
+		if (output_is_pending(handle_data->output, handle) &&
+				left > GET_MANY_OUTPUT_SLICE)
+			left = GET_MANY_OUTPUT_SLICE;
+
+		r = ccn_run(handle, left > INT_MAX ? INT_MAX : (int) left);
+		if (r < 0) {
+			run_err = 1;
+			err = ccn_geterror(handle);
+			break;
+		}
+	}
+	state->finished = 1;
+	TRACE_END("get_many");
+	Py_END_ALLOW_THREADS
+
+	_pyccn_run_state_clear(state_slot);
+
+	if (run_err) {
+		if (err)
+			PyErr_Format(g_PyExc_CCNError, "ccn_run() failed: %s [%d]",
+					strerror(err), err);
+		else
+			PyErr_SetString(g_PyExc_CCNError, "ccn_run() failed for an"
+					" unknown reason");
+		goto exit;
+	}
+
+	py_res = PyList_New(state->count);
+	JUMP_IF_NULL(py_res, exit);
+
+	for (i = 0; i < state->count; i++) {
+		item = &state->items[i];
+
+		if (item->done <= 0) {
+			Py_INCREF(Py_None);
+			PyList_SET_ITEM(py_res, i, Py_None);
+			continue;
+		}
+
+		py_data = CCNObject_New_charbuf(CONTENT_OBJECT, &data);
+		JUMP_IF_NULL(py_data, exit);
+
+		r = ccn_charbuf_append_charbuf(data, item->data);
+		if (r < 0) {
+			Py_DECREF(py_data);
+			PyErr_NoMemory();
+			goto exit;
+		}
+
+		r = _pyccn_content_object_set_parsed(py_data, &item->pco,
+				item->comps);
+		if (r < 0) {
+			Py_DECREF(py_data);
+			goto exit;
+		}
+
+		py_o = ContentObject_obj_from_ccn(py_data);
+		Py_DECREF(py_data);
+		JUMP_IF_NULL(py_o, exit);
+		PyList_SET_ITEM(py_res, i, py_o);
+		py_o = NULL;
+	}
+
+	py_result = py_res;
+	py_res = NULL;
+
+exit:
+	if (state) {
+		state->finished = 1;
+		get_many_state_release(state);
+	}
+	Py_XDECREF(py_res);
+	Py_XDECREF(py_o);
+	Py_XDECREF(py_refs);
+	Py_XDECREF(py_seq);
+	return py_result;
+}
+
+static PyObject *
+put(PyObject *args, int submit)
 {
 	PyObject *py_ccn, *py_content_object;
 	PyObject *py_o;
 	struct ccn_charbuf *content_object;
 	struct ccn *handle;
+	struct handle_data *handle_data;
+	struct ccn_parsed_ContentObject *pco;
+	struct queue_item *item;
 	int r;
 
 	if (!PyArg_ParseTuple(args, "OO", &py_ccn, &py_content_object))
@@ -637,28 +1656,393 @@ _pyccn_cmd_put(PyObject *UNUSED(self), PyObject *args)
 	JUMP_IF_NULL(py_o, error);
 
 	handle = CCNObject_Get(HANDLE, py_o);
+	handle_data = PyCapsule_GetContext(py_o);
 	Py_DECREF(py_o);
 	assert(handle);
+	assert(handle_data);
 
 	py_o = PyObject_GetAttrString(py_content_object, "ccn_data");
 	JUMP_IF_NULL(py_o, error);
 
 	content_object = CCNObject_Get(CONTENT_OBJECT, py_o);
-	Py_DECREF(py_o);
 	assert(content_object);
 
-	r = ccn_put(handle, content_object->buf, content_object->length);
+	/* the loop thread will send it, see queue.c */
+	if (submit) {
+		if (!handle_queue(handle_data))
+			goto error_co;
+
+		pco = _pyccn_content_object_get_pco(py_o);
+		JUMP_IF_NULL(pco, error_co);
+
+		item = queue_item_new(QUEUE_PUT);
+		JUMP_IF_NULL_MEM(item, error_co);
+		memcpy(&item->pco, pco, sizeof(item->pco));
+		item->data = ccn_charbuf_create();
+		r = item->data ? ccn_charbuf_append_charbuf(item->data,
+				content_object) : -1;
+		if (r < 0) {
+			queue_item_free(item);
+			PyErr_NoMemory();
+			goto error_co;
+		}
+		Py_DECREF(py_o);
+
+		queue_push(handle_data->queue, item);
+
+		Py_RETURN_NONE;
+	}
+
+	TRACE_BEGIN("put");
+	r = output_put(handle_data->output, handle, content_object->buf,
+			content_object->length);
+	TRACE_END("put");
 	if (r < 0) {
-		int err = ccn_geterror(handle);
+		int err = errno;
+		Py_DECREF(py_o);
 		return PyErr_Format(PyExc_IOError, "%s [%d]", strerror(err), err);
 	}
+	stats_inc(handle_data->stats, puts);
+	stats_add(handle_data->stats, put_bytes, content_object->length);
+
+	/* all interests aggregated for this data are answered now */
+	if (handle_data->pit) {
+		pco = _pyccn_content_object_get_pco(py_o);
+		if (!pco) {
+			Py_DECREF(py_o);
+			return NULL;
+		}
+
+		pit_satisfy(handle_data->pit, content_object->buf,
+				content_object->length, pco);
+	}
+	Py_DECREF(py_o);
 
 	return Py_BuildValue("i", r);
 
+error_co:
+	Py_DECREF(py_o);
+error:
+	return NULL;
+}
+
+/*
+ * Batched put.
+ *
+ * libccn keeps output it couldn't write in a buffer of its own, which only
+ * takes whole messages. So the objects are written with writev() only when
+ * nothing is pending (otherwise they'd overtake what's buffered); a message
+ * that got written only partially is queued with the rest, nothing else is
+ * written until it's finished (see output.c). Whatever didn't fit goes out
+ * as the socket drains.
+ */
+
+/* iovecs per writev(), well below IOV_MAX */
+#define PUT_MANY_IOV 256
+
+/*
+ * Returns number of objects written out completely, -1 on error (errno in
+ * *err). When the socket filled up in the middle of the next object, *partial
+ * is how much of it got written. Runs without the GIL.
+ */
+static Py_ssize_t
+put_many_writev(int fd, struct ccn_charbuf **objects, Py_ssize_t n,
+		size_t *partial, int *err)
+{
+	struct iovec iov[PUT_MANY_IOV];
+	Py_ssize_t i = 0, j, cnt;
+	ssize_t written;
+
+	while (i < n) {
+		cnt = n - i < PUT_MANY_IOV ? n - i : PUT_MANY_IOV;
+		for (j = 0; j < cnt; j++) {
+			iov[j].iov_base = objects[i + j]->buf;
+			iov[j].iov_len = objects[i + j]->length;
+		}
+
+		do
+			written = writev(fd, iov, cnt);
+		while (written < 0 && errno == EINTR);
+
+		if (written < 0) {
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+				return i;
+			*err = errno;
+			return -1;
+		}
+
+		for (j = 0; j < cnt && (size_t) written >= iov[j].iov_len; j++)
+			written -= iov[j].iov_len;
+		i += j;
+
+		if (j == cnt)
+			continue;
+
+		/* socket is full */
+		*partial = written;
+		break;
+	}
+
+	return i;
+}
+
+/* returns (accepted, pending), objects sent and left queued */
+PyObject *
+_pyccn_cmd_put_many(PyObject *UNUSED(self), PyObject *args)
+{
+	PyObject *py_ccn, *py_content_objects, *py_seq = NULL, *py_data = NULL;
+	PyObject *py_o, *py_result = NULL;
+	struct ccn *handle;
+	struct handle_data *handle_data;
+	struct ccn_charbuf **objects = NULL;
+	struct ccn_parsed_ContentObject *pco;
+	Py_ssize_t i, n, sent = 0, pending = 0, first_pending = -1;
+	size_t bytes = 0, partial = 0;
+	int fd, r, err = 0;
+
+	if (!PyArg_ParseTuple(args, "OO", &py_ccn, &py_content_objects))
+		return NULL;
+
+	if (strcmp(py_ccn->ob_type->tp_name, "CCN")) {
+		PyErr_SetString(PyExc_TypeError, "Must pass a CCN as arg 1");
+		return NULL;
+	}
+
+	py_o = PyObject_GetAttrString(py_ccn, "ccn_data");
+	JUMP_IF_NULL(py_o, error);
+	handle = CCNObject_Get(HANDLE, py_o);
+	handle_data = PyCapsule_GetContext(py_o);
+	Py_DECREF(py_o);
+	assert(handle);
+	assert(handle_data);
+
+	py_seq = PySequence_Tuple(py_content_objects);
+	JUMP_IF_NULL(py_seq, error);
+	n = PyTuple_GET_SIZE(py_seq);
+
+	/* encoded objects, referenced while the GIL is released */
+	py_data = PyTuple_New(n);
+	JUMP_IF_NULL(py_data, error);
+
+	objects = calloc(n ? n : 1, sizeof(*objects));
+	JUMP_IF_NULL_MEM(objects, error);
+
+	for (i = 0; i < n; i++) {
+		PyObject *py_co = PyTuple_GET_ITEM(py_seq, i);
+
+		if (strcmp(py_co->ob_type->tp_name, "ContentObject")) {
+			PyErr_Format(PyExc_TypeError, "Item %zd isn't a ContentObject", i);
+			goto error;
+		}
+
+		py_o = PyObject_GetAttrString(py_co, "ccn_data");
+		JUMP_IF_NULL(py_o, error);
+		PyTuple_SET_ITEM(py_data, i, py_o);
+
+		if (!CCNObject_IsValid(CONTENT_OBJECT, py_o)) {
+			PyErr_Format(PyExc_TypeError, "Item %zd isn't encoded", i);
+			goto error;
+		}
+		objects[i] = CCNObject_Get(CONTENT_OBJECT, py_o);
+		bytes += objects[i]->length;
+	}
+
+	fd = ccn_get_connection_fd(handle);
+	if (fd < 0) {
+		PyErr_SetString(g_PyExc_CCNError, "Not connected to ccnd");
+		goto error;
+	}
+
+	TRACE_BEGIN("put_many");
+
+	/*
+	 * from an upcall ccn_run() can write right after we return, so it can't
+	 * be left in the middle of a message
+	 */
+	if (!output_is_pending(handle_data->output, handle) &&
+			!_pyccn_run_state_find(handle)) {
+		Py_BEGIN_ALLOW_THREADS
+		sent = put_many_writev(fd, objects, n, &partial, &err);
+		Py_END_ALLOW_THREADS
+	}
+
+	if (sent < 0) {
+		TRACE_END("put_many");
+		PyErr_Format(PyExc_IOError, "%s [%d]", strerror(err), err);
+		goto error;
+	}
+
+	if (partial > 0) {
+		r = output_put_partial(handle_data->output, handle,
+				objects[sent]->buf, objects[sent]->length, partial);
+		if (r < 0) {
+			TRACE_END("put_many");
+			PyErr_NoMemory();
+			goto error;
+		}
+		first_pending = sent++;
+	}
+
+	for (i = sent; i < n; i++) {
+		r = output_put(handle_data->output, handle, objects[i]->buf,
+				objects[i]->length);
+		if (r < 0) {
+			err = errno;
+			TRACE_END("put_many");
+			PyErr_Format(PyExc_IOError, "%s [%d]", strerror(err), err);
+			goto error;
+		}
+
+		/* everything after the first buffered one is buffered too */
+		if (r > 0 && first_pending < 0)
+			first_pending = i;
+		else if (!r)
+			first_pending = -1; /* all of it got out */
+	}
+
+	if (first_pending >= 0)
+		pending = n - first_pending;
+
+	TRACE_END("put_many");
+
+	stats_add(handle_data->stats, puts, n);
+	stats_add(handle_data->stats, put_bytes, bytes);
+
+	/* all interests aggregated for this data are answered now */
+	if (handle_data->pit)
+		for (i = 0; i < n; i++) {
+			pco = _pyccn_content_object_get_pco(PyTuple_GET_ITEM(py_data, i));
+			JUMP_IF_NULL(pco, error);
+
+			pit_satisfy(handle_data->pit, objects[i]->buf, objects[i]->length,
+					pco);
+		}
+
+	py_result = Py_BuildValue("nn", n - pending, pending);
+
 error:
+	free(objects);
+	Py_XDECREF(py_data);
+	Py_XDECREF(py_seq);
+	return py_result;
+}
+
+PyObject * // int
+_pyccn_cmd_put(PyObject *UNUSED(self), PyObject *args)
+{
+	return put(args, 0);
+}
+
+/* same as put, but safe to call while another thread runs */
+PyObject *
+_pyccn_cmd_submit_put(PyObject *UNUSED(self), PyObject *args)
+{
+	return put(args, 1);
+}
+
+static int
+stats_set_item(PyObject *py_dict, const char *key, unsigned long long value)
+{
+	PyObject *py_o;
+	int r;
+
+	py_o = PyLong_FromUnsignedLongLong(value);
+	if (!py_o)
+		return -1;
+
+	r = PyDict_SetItemString(py_dict, key, py_o);
+	Py_DECREF(py_o);
+
+	return r;
+}
+
+/*
+ * Snapshot of handle's counters as a dict, latency histogram is a list where
+ * item i counts upcalls that took less than 2^i us (the last one the rest)
+ */
+PyObject *
+_pyccn_cmd_get_stats(PyObject *UNUSED(self), PyObject *py_handle)
+{
+	PyObject *py_dict = NULL, *py_list = NULL, *py_o;
+	struct handle_data *handle_data;
+	struct pyccn_stats stats;
+	int i, r;
+
+	if (!CCNObject_IsValid(HANDLE, py_handle)) {
+		PyErr_SetString(PyExc_TypeError, "Must pass a CCN handle");
+		return NULL;
+	}
+	handle_data = PyCapsule_GetContext(py_handle);
+	assert(handle_data);
+
+	stats_snapshot(handle_data->stats, &stats);
+
+	py_dict = PyDict_New();
+	JUMP_IF_NULL(py_dict, error);
+
+#define SET_ITEM(name) \
+do { \
+	r = stats_set_item(py_dict, #name, stats.name); \
+	JUMP_IF_NEG(r, error); \
+} while (0)
+
+	SET_ITEM(interests_expressed);
+	SET_ITEM(reexpressed);
+	SET_ITEM(timeouts);
+	SET_ITEM(puts);
+	SET_ITEM(put_bytes);
+	SET_ITEM(upcalls);
+	SET_ITEM(upcall_latency_sum);
+
+#undef SET_ITEM
+
+	py_list = PyList_New(STATS_UPCALL_KINDS);
+	JUMP_IF_NULL(py_list, error);
+	for (i = 0; i < STATS_UPCALL_KINDS; i++) {
+		py_o = PyLong_FromUnsignedLongLong(stats.upcall_kinds[i]);
+		JUMP_IF_NULL(py_o, error);
+		PyList_SET_ITEM(py_list, i, py_o);
+	}
+	r = PyDict_SetItemString(py_dict, "upcall_kinds", py_list);
+	Py_CLEAR(py_list);
+	JUMP_IF_NEG(r, error);
+
+	py_list = PyList_New(STATS_LATENCY_BUCKETS);
+	JUMP_IF_NULL(py_list, error);
+	for (i = 0; i < STATS_LATENCY_BUCKETS; i++) {
+		py_o = PyLong_FromUnsignedLongLong(stats.upcall_latency[i]);
+		JUMP_IF_NULL(py_o, error);
+		PyList_SET_ITEM(py_list, i, py_o);
+	}
+	r = PyDict_SetItemString(py_dict, "upcall_latency", py_list);
+	Py_CLEAR(py_list);
+	JUMP_IF_NEG(r, error);
+
+	return py_dict;
+
+error:
+	Py_XDECREF(py_list);
+	Py_XDECREF(py_dict);
 	return NULL;
 }
 
+PyObject *
+_pyccn_cmd_reset_stats(PyObject *UNUSED(self), PyObject *py_handle)
+{
+	struct handle_data *handle_data;
+
+	if (!CCNObject_IsValid(HANDLE, py_handle)) {
+		PyErr_SetString(PyExc_TypeError, "Must pass a CCN handle");
+		return NULL;
+	}
+	handle_data = PyCapsule_GetContext(py_handle);
+	assert(handle_data);
+
+	stats_reset(handle_data->stats);
+
+	Py_RETURN_NONE;
+}
+
 PyObject *
 _pyccn_cmd_get_default_key(PyObject *UNUSED(self), PyObject *UNUSED(arg))
 {
@@ -490,266 +490,218 @@ error:
 	return NULL;
 }
 
-PyObject *
-Interest_obj_from_ccn(PyObject *py_interest)
-{
-	struct ccn_charbuf *interest;
-	struct ccn_parsed_interest *pi;
-	PyObject *py_obj_Interest, *py_o;
-	int r;
-
-	debug("Interest_from_ccn_parsed start\n");
-
-	interest = CCNObject_Get(INTEREST, py_interest);
+/*
+ * Decoders of individual fields of received Interest, each one returns
+ * Py_None if the field is not present
+ */
 
-	// 1) Create python object
-	py_obj_Interest = PyObject_CallObject(g_type_Interest, NULL);
-	if (!py_obj_Interest)
-		return NULL;
+struct interest_field;
+typedef PyObject *(*interest_field_decoder)(const struct interest_field *f,
+		PyObject *py_interest, struct ccn_charbuf *interest,
+		struct ccn_parsed_interest *pi);
 
-	pi = _pyccn_interest_get_pi(py_interest);
-	JUMP_IF_NULL(pi, error);
-
-	// 2) Set ccn_data to a cobject pointing to the c struct
-	//    and ensure proper destructor is set up for the c object.
-	r = PyObject_SetAttrString(py_obj_Interest, "ccn_data", py_interest);
-	JUMP_IF_NEG(r, error);
-
-	// 3) Parse c structure and fill python attributes
-	//    using PyObject_SetAttrString
+struct interest_field {
+	const char *name;
+	enum ccn_dtag dtag;
+	enum ccn_parsed_interest_offsetid b, e;
+	interest_field_decoder decode;
+};
 
+static PyObject *
+Interest_name_from_ccn(const struct interest_field *f, PyObject *py_interest,
+		struct ccn_charbuf *interest, struct ccn_parsed_interest *pi)
+{
+	PyObject *py_cname, *py_o;
 	ssize_t len;
-	const unsigned char *blob;
-	size_t blob_size, start, end;
-	struct ccn_charbuf * cb;
-
-	// Best decoding examples are in packet-ccn.c for wireshark plugin?
-
-	//        self.name = None  # Start from None to use for templates?
-	len = pi->offset[CCN_PI_E_Name] - pi->offset[CCN_PI_B_Name];
-	if (len > 0) {
-		PyObject *py_cname;
 
-		py_cname = CCNObject_New_charbuf(NAME, &cb);
-		JUMP_IF_NULL(py_cname, error);
-
-		r = ccn_charbuf_append(cb, interest->buf + pi->offset[CCN_PI_B_Name],
-				len);
-		JUMP_IF_NEG_MEM(r, error);
-
-		py_o = Name_obj_from_ccn(py_cname);
-		Py_DECREF(py_cname);
-		JUMP_IF_NULL(py_o, error);
-
-		r = PyObject_SetAttrString(py_obj_Interest, "name", py_o);
-		Py_DECREF(py_o);
-		JUMP_IF_NEG(r, error);
-	} else {
+	len = pi->offset[f->e] - pi->offset[f->b];
+	if (len <= 0) {
 		PyErr_SetString(g_PyExc_CCNInterestError, "Got interest without a"
 				" name!");
-		goto error;
+		return NULL;
 	}
 
-	//        self.minSuffixComponents = None  # default 0
-	len = pi->offset[CCN_PI_E_MinSuffixComponents] -
-			pi->offset[CCN_PI_B_MinSuffixComponents];
-	if (len > 0) {
-		r = ccn_fetch_tagged_nonNegativeInteger(CCN_DTAG_MinSuffixComponents,
-				interest->buf, pi->offset[CCN_PI_B_MinSuffixComponents],
-				pi->offset[CCN_PI_E_MinSuffixComponents]);
-		if (r < 0) {
-			PyErr_SetString(g_PyExc_CCNInterestError, "Invalid"
-					" MinSuffixComponents value");
-			goto error;
-		}
-
-		py_o = _pyccn_Int_FromLong(r);
-		JUMP_IF_NULL(py_o, error);
-
-		r = PyObject_SetAttrString(py_obj_Interest, "minSuffixComponents",
-				py_o);
-		Py_DECREF(py_o);
-		JUMP_IF_NEG(r, error);
-	}
+	/* the name is shared with the interest instead of copying it */
+	py_cname = CCNObject_New_charbuf_view(NAME, py_interest,
+			interest->buf + pi->offset[f->b], len);
+	if (!py_cname)
+		return NULL;
 
-	//        self.maxSuffixComponents = None  # default infinity
-	len = pi->offset[CCN_PI_E_MaxSuffixComponents] -
-			pi->offset[CCN_PI_B_MaxSuffixComponents];
-	if (len > 0) {
-		r = ccn_fetch_tagged_nonNegativeInteger(CCN_DTAG_MaxSuffixComponents,
-				interest->buf, pi->offset[CCN_PI_B_MaxSuffixComponents],
-				pi->offset[CCN_PI_E_MaxSuffixComponents]);
-		if (r < 0) {
-			PyErr_SetString(g_PyExc_CCNInterestError, "Invalid"
-					" MaxSuffixComponents value");
-			goto error;
-		}
+	py_o = Name_obj_from_ccn(py_cname);
+	Py_DECREF(py_cname);
 
-		py_o = _pyccn_Int_FromLong(r);
-		JUMP_IF_NULL(py_o, error);
+	return py_o;
+}
 
-		r = PyObject_SetAttrString(py_obj_Interest, "maxSuffixComponents",
-				py_o);
-		Py_DECREF(py_o);
-		JUMP_IF_NEG(r, error);
-	}
+static PyObject *
+Interest_int_from_ccn(const struct interest_field *f,
+		PyObject *UNUSED(py_interest), struct ccn_charbuf *interest,
+		struct ccn_parsed_interest *pi)
+{
+	int r;
 
-	//        self.publisherPublicKeyDigest = None   # SHA256 hash
-	// TODO: what is CN_PI_B_PublisherID? -- looks like it is the data including
-	//                                       the tags while PublisherIDKeyDigest
-	//                                       is just the raw digest -- dk
-	start = pi->offset[CCN_PI_B_PublisherID];
-	end = pi->offset[CCN_PI_E_PublisherID];
-	len = end - start;
-	if (len > 0) {
-		r = ccn_ref_tagged_BLOB(CCN_DTAG_PublisherPublicKeyDigest,
-				interest->buf, start, end, &blob, &blob_size);
-		if (r < 0) {
-			PyErr_SetString(g_PyExc_CCNInterestError, "Invalid"
-					" PublisherPublicKeyDigest value");
-			goto error;
-		}
+	if (pi->offset[f->e] <= pi->offset[f->b])
+		Py_RETURN_NONE;
 
-		py_o = PyBytes_FromStringAndSize((const char*) blob, blob_size);
-		JUMP_IF_NULL(py_o, error);
+	r = ccn_fetch_tagged_nonNegativeInteger(f->dtag, interest->buf,
+			pi->offset[f->b], pi->offset[f->e]);
+	if (r < 0)
+		return PyErr_Format(g_PyExc_CCNInterestError, "Invalid %s value",
+			f->name);
 
-		r = PyObject_SetAttrString(py_obj_Interest, "publisherPublicKeyDigest",
-				py_o);
-		Py_DECREF(py_o);
-		JUMP_IF_NEG(r, error);
-	}
+	return _pyccn_Int_FromLong(r);
+}
 
-	//        self.exclude = None
-	len = pi->offset[CCN_PI_E_Exclude] - pi->offset[CCN_PI_B_Exclude];
-	if (len > 0) {
-		PyObject *py_exclusion_filter;
+static PyObject *
+Interest_blob_from_ccn(const struct interest_field *f,
+		PyObject *UNUSED(py_interest), struct ccn_charbuf *interest,
+		struct ccn_parsed_interest *pi)
+{
+	const unsigned char *blob;
+	size_t blob_size;
+	int r;
 
-		py_exclusion_filter = CCNObject_New_charbuf(EXCLUSION_FILTER, &cb);
-		JUMP_IF_NULL(py_exclusion_filter, error);
+	if (pi->offset[f->e] <= pi->offset[f->b])
+		Py_RETURN_NONE;
 
-		r = ccn_charbuf_append(cb, interest->buf + pi->offset[CCN_PI_B_Exclude],
-				len);
-		JUMP_IF_NEG_MEM(r, error);
+	r = ccn_ref_tagged_BLOB(f->dtag, interest->buf, pi->offset[f->b],
+			pi->offset[f->e], &blob, &blob_size);
+	if (r < 0)
+		return PyErr_Format(g_PyExc_CCNInterestError, "Invalid %s value",
+			f->name);
 
-		py_o = ExclusionFilter_obj_from_ccn(py_exclusion_filter);
-		Py_DECREF(py_exclusion_filter);
-		JUMP_IF_NULL(py_o, error);
+	return PyBytes_FromStringAndSize((const char *) blob, blob_size);
+}
 
-		r = PyObject_SetAttrString(py_obj_Interest, "exclude", py_o);
-		Py_DECREF(py_o);
-		JUMP_IF_NEG(r, error);
-	}
+static PyObject *
+Interest_exclude_from_ccn(const struct interest_field *f,
+		PyObject *UNUSED(py_interest), struct ccn_charbuf *interest,
+		struct ccn_parsed_interest *pi)
+{
+	PyObject *py_exclusion_filter, *py_o;
+	struct ccn_charbuf *cb;
+	ssize_t len;
+	int r;
 
-	//        self.childSelector = None
-	len = pi->offset[CCN_PI_E_ChildSelector] -
-			pi->offset[CCN_PI_B_ChildSelector];
-	if (len > 0) {
-		r = ccn_fetch_tagged_nonNegativeInteger(CCN_DTAG_ChildSelector,
-				interest->buf, pi->offset[CCN_PI_B_ChildSelector],
-				pi->offset[CCN_PI_E_ChildSelector]);
-		if (r < 0) {
-			PyErr_SetString(g_PyExc_CCNInterestError, "Invalid"
-					" ChildSelector value");
-			goto error;
-		}
+	len = pi->offset[f->e] - pi->offset[f->b];
+	if (len <= 0)
+		Py_RETURN_NONE;
 
-		py_o = _pyccn_Int_FromLong(r);
-		JUMP_IF_NULL(py_o, error);
+	py_exclusion_filter = CCNObject_New_charbuf(EXCLUSION_FILTER, &cb);
+	if (!py_exclusion_filter)
+		return NULL;
 
-		r = PyObject_SetAttrString(py_obj_Interest, "childSelector", py_o);
-		Py_DECREF(py_o);
-		JUMP_IF_NEG(r, error);
+	r = ccn_charbuf_append(cb, interest->buf + pi->offset[f->b], len);
+	if (r < 0) {
+		Py_DECREF(py_exclusion_filter);
+		return PyErr_NoMemory();
 	}
 
-	//        self.answerOriginKind = None
-	len = pi->offset[CCN_PI_E_AnswerOriginKind] -
-			pi->offset[CCN_PI_B_AnswerOriginKind];
-	if (len > 0) {
-		r = ccn_fetch_tagged_nonNegativeInteger(CCN_DTAG_AnswerOriginKind,
-				interest->buf, pi->offset[CCN_PI_B_AnswerOriginKind],
-				pi->offset[CCN_PI_E_AnswerOriginKind]);
-		if (r < 0) {
-			PyErr_SetString(g_PyExc_CCNInterestError, "Invalid"
-					" AnswerOriginKind value");
-			goto error;
-		}
+	py_o = ExclusionFilter_obj_from_ccn(py_exclusion_filter);
+	Py_DECREF(py_exclusion_filter);
 
-		py_o = _pyccn_Int_FromLong(r);
-		JUMP_IF_NULL(py_o, error);
+	return py_o;
+}
 
-		r = PyObject_SetAttrString(py_obj_Interest, "answerOriginKind", py_o);
-		Py_DECREF(py_o);
-		JUMP_IF_NEG(r, error);
-	}
+static PyObject *
+Interest_lifetime_from_ccn(const struct interest_field *f,
+		PyObject *UNUSED(py_interest), struct ccn_charbuf *interest,
+		struct ccn_parsed_interest *pi)
+{
+	const unsigned char *blob;
+	size_t blob_size;
+	double lifetime;
+	int r;
 
-	//        self.scope  = None
-	len = pi->offset[CCN_PI_E_Scope] - pi->offset[CCN_PI_B_Scope];
-	if (len > 0) {
-		r = ccn_fetch_tagged_nonNegativeInteger(CCN_DTAG_Scope, interest->buf,
-				pi->offset[CCN_PI_B_Scope], pi->offset[CCN_PI_E_Scope]);
-		if (r < 0) {
-			PyErr_SetString(g_PyExc_CCNInterestError, "Invalid"
-					" Scope value");
-			goto error;
-		}
+	if (pi->offset[f->e] <= pi->offset[f->b])
+		Py_RETURN_NONE;
 
-		py_o = _pyccn_Int_FromLong(r);
-		JUMP_IF_NULL(py_o, error);
+	// From packet-ccn.c
+	r = ccn_ref_tagged_BLOB(f->dtag, interest->buf, pi->offset[f->b],
+			pi->offset[f->e], &blob, &blob_size);
+	if (r < 0)
+		return PyErr_Format(g_PyExc_CCNInterestError, "Invalid %s value",
+			f->name);
 
-		r = PyObject_SetAttrString(py_obj_Interest, "scope", py_o);
-		Py_DECREF(py_o);
-		JUMP_IF_NEG(r, error);
-	}
+	/* XXX: probably won't work with bigendian */
+	lifetime = 0.0;
+	for (size_t i = 0; i < blob_size; i++)
+		lifetime = lifetime * 256.0 + (double) blob[i];
+	lifetime /= 4096.0;
 
-	//        self.interestLifetime = None
-	len = pi->offset[CCN_PI_E_InterestLifetime] -
-			pi->offset[CCN_PI_B_InterestLifetime];
-	if (len > 0) {
-		double lifetime;
+	return PyFloat_FromDouble(lifetime);
+}
 
-		// From packet-ccn.c
-		r = ccn_ref_tagged_BLOB(CCN_DTAG_InterestLifetime, interest->buf,
-				pi->offset[CCN_PI_B_InterestLifetime],
-				pi->offset[CCN_PI_E_InterestLifetime], &blob, &blob_size);
-		if (r < 0) {
-			PyErr_SetString(g_PyExc_CCNInterestError, "Invalid"
-					" InterestLifetime value");
-			goto error;
-		}
+// TODO: what is CN_PI_B_PublisherID? -- looks like it is the data including
+//                                       the tags while PublisherIDKeyDigest
+//                                       is just the raw digest -- dk
+static const struct interest_field g_interest_fields[] = {
+	{"name", CCN_DTAG_Name, CCN_PI_B_Name, CCN_PI_E_Name,
+		Interest_name_from_ccn},
+	{"minSuffixComponents", CCN_DTAG_MinSuffixComponents,
+		CCN_PI_B_MinSuffixComponents, CCN_PI_E_MinSuffixComponents,
+		Interest_int_from_ccn},
+	{"maxSuffixComponents", CCN_DTAG_MaxSuffixComponents,
+		CCN_PI_B_MaxSuffixComponents, CCN_PI_E_MaxSuffixComponents,
+		Interest_int_from_ccn},
+	{"publisherPublicKeyDigest", CCN_DTAG_PublisherPublicKeyDigest,
+		CCN_PI_B_PublisherID, CCN_PI_E_PublisherID, Interest_blob_from_ccn},
+	{"exclude", CCN_DTAG_Exclude, CCN_PI_B_Exclude, CCN_PI_E_Exclude,
+		Interest_exclude_from_ccn},
+	{"childSelector", CCN_DTAG_ChildSelector, CCN_PI_B_ChildSelector,
+		CCN_PI_E_ChildSelector, Interest_int_from_ccn},
+	{"answerOriginKind", CCN_DTAG_AnswerOriginKind,
+		CCN_PI_B_AnswerOriginKind, CCN_PI_E_AnswerOriginKind,
+		Interest_int_from_ccn},
+	{"scope", CCN_DTAG_Scope, CCN_PI_B_Scope, CCN_PI_E_Scope,
+		Interest_int_from_ccn},
+	{"interestLifetime", CCN_DTAG_InterestLifetime,
+		CCN_PI_B_InterestLifetime, CCN_PI_E_InterestLifetime,
+		Interest_lifetime_from_ccn},
+	{"nonce", CCN_DTAG_Nonce, CCN_PI_B_Nonce, CCN_PI_E_Nonce,
+		Interest_blob_from_ccn},
+	{NULL, 0, 0, 0, NULL}
+};
 
-		/* XXX: probably won't work with bigendian */
-		lifetime = 0.0;
-		for (size_t i = 0; i < blob_size; i++)
-			lifetime = lifetime * 256.0 + (double) blob[i];
-		lifetime /= 4096.0;
+/*
+ * Only ccn_data is set here, fields listed in Interest._lazy_fields are
+ * decoded by Interest_field_from_ccn once they're accessed
+ */
+PyObject *
+Interest_obj_from_ccn(PyObject *py_interest)
+{
+	struct ccn_parsed_interest *pi;
+	PyObject *py_obj_Interest, *py_o;
+	PyObject *py_lazy;
+	int r;
 
-		py_o = PyFloat_FromDouble(lifetime);
-		JUMP_IF_NULL(py_o, error);
+	debug("Interest_from_ccn_parsed start\n");
 
-		r = PyObject_SetAttrString(py_obj_Interest, "interestLifetime", py_o);
-		Py_DECREF(py_o);
-		JUMP_IF_NEG(r, error);
-	}
+	/* we still want to refuse malformed interests right away */
+	pi = _pyccn_interest_get_pi(py_interest);
+	if (!pi)
+		return NULL;
 
-	//        self.nonce = None
-	len = pi->offset[CCN_PI_E_Nonce] - pi->offset[CCN_PI_B_Nonce];
-	if (len > 0) {
-		r = ccn_ref_tagged_BLOB(CCN_DTAG_Nonce, interest->buf,
-				pi->offset[CCN_PI_B_Nonce], pi->offset[CCN_PI_E_Nonce], &blob,
-				&blob_size);
-		if (r < 0) {
-			PyErr_SetString(g_PyExc_CCNInterestError, "Invalid"
-					" Nonce value");
-			goto error;
-		}
+	// 1) Create python object
+	py_obj_Interest = PyObject_CallObject(g_type_Interest, NULL);
+	if (!py_obj_Interest)
+		return NULL;
 
-		py_o = PyBytes_FromStringAndSize((const char *) blob, blob_size);
-		JUMP_IF_NULL(py_o, error);
+	// 2) Set ccn_data to a cobject pointing to the c struct
+	//    and ensure proper destructor is set up for the c object.
+	r = PyObject_SetAttrString(py_obj_Interest, "ccn_data", py_interest);
+	JUMP_IF_NEG(r, error);
 
-		r = PyObject_SetAttrString(py_obj_Interest, "nonce", py_o);
-		Py_DECREF(py_o);
-		JUMP_IF_NEG(r, error);
-	}
+	// 3) Mark fields to be decoded on first access
+	py_o = PyObject_GetAttrString(py_obj_Interest, "_lazy_fields");
+	JUMP_IF_NULL(py_o, error);
+	py_lazy = PySet_New(py_o);
+	Py_DECREF(py_o);
+	JUMP_IF_NULL(py_lazy, error);
+
+	r = PyObject_SetAttrString(py_obj_Interest, "_lazy", py_lazy);
+	Py_DECREF(py_lazy);
+	JUMP_IF_NEG(r, error);
 
 	r = PyObject_SetAttrString(py_obj_Interest, "ccn_data_dirty", Py_False);
 	JUMP_IF_NEG(r, error);
@@ -843,6 +795,37 @@ _pyccn_cmd_Interest_obj_from_ccn(PyObject *UNUSED(self), PyObject *py_interest)
 	return Interest_obj_from_ccn(py_interest);
 }
 
+PyObject *
+_pyccn_cmd_Interest_field_from_ccn(PyObject *UNUSED(self), PyObject *args)
+{
+	PyObject *py_interest;
+	struct ccn_charbuf *interest;
+	struct ccn_parsed_interest *pi;
+	const struct interest_field *f;
+	const char *field;
+
+	if (!PyArg_ParseTuple(args, "Os", &py_interest, &field))
+		return NULL;
+
+	if (!CCNObject_ReqType(INTEREST, py_interest))
+		return NULL;
+
+	for (f = g_interest_fields; f->name; f++)
+		if (!strcmp(f->name, field))
+			break;
+
+	if (!f->name)
+		return PyErr_Format(PyExc_ValueError, "Unknown Interest field: %s",
+			field);
+
+	interest = CCNObject_Get(INTEREST, py_interest);
+	pi = _pyccn_interest_get_pi(py_interest);
+	if (!pi)
+		return NULL;
+
+	return f->decode(f, py_interest, interest, pi);
+}
+
 PyObject *
 _pyccn_cmd_ExclusionFilter_names_to_ccn(PyObject *UNUSED(self), PyObject *py_names)
 {
@@ -15,6 +15,8 @@ void _pyccn_interest_set_pi(PyObject *py_interest,
 PyObject *_pyccn_cmd_Interest_obj_to_ccn(PyObject *UNUSED(self),
 		PyObject *py_interest);
 PyObject *_pyccn_cmd_Interest_obj_from_ccn(PyObject *UNUSED(self), PyObject *args);
+PyObject *_pyccn_cmd_Interest_field_from_ccn(PyObject *UNUSED(self),
+		PyObject *args);
 PyObject *_pyccn_cmd_ExclusionFilter_names_to_ccn(PyObject *UNUSED(self),
 		PyObject* args);
 PyObject *_pyccn_cmd_ExclusionFilter_obj_from_ccn(PyObject *UNUSED(self),
@@ -64,8 +64,13 @@ Key_to_ccn_keystore(PyObject* py_key)
 //
 //
 
+/*
+ * py_digest (or None) is the PublisherPublicKeyDigest of the key with that
+ * name, for when there's more than one
+ */
 static int
-KeyLocator_name_to_ccn(struct ccn_charbuf *keylocator, PyObject *py_name)
+KeyLocator_name_to_ccn(struct ccn_charbuf *keylocator, PyObject *py_name,
+		PyObject *py_digest)
 {
 	struct ccn_charbuf *name;
 	int r;
@@ -76,6 +81,11 @@ KeyLocator_name_to_ccn(struct ccn_charbuf *keylocator, PyObject *py_name)
 	}
 	name = CCNObject_Get(NAME, py_name);
 
+	if (py_digest != Py_None && !PyBytes_Check(py_digest)) {
+		PyErr_SetString(PyExc_TypeError, "Key digest needs to be bytes");
+		return -1;
+	}
+
 	r = ccn_charbuf_append_tt(keylocator, CCN_DTAG_KeyName, CCN_DTAG);
 	JUMP_IF_NEG_MEM(r, error);
 
@@ -84,6 +94,13 @@ KeyLocator_name_to_ccn(struct ccn_charbuf *keylocator, PyObject *py_name)
 	r = ccn_charbuf_append_charbuf(keylocator, name);
 	JUMP_IF_NEG_MEM(r, error);
 
+	if (py_digest != Py_None) {
+		r = ccnb_append_tagged_blob(keylocator,
+				CCN_DTAG_PublisherPublicKeyDigest, PyBytes_AS_STRING(py_digest),
+				PyBytes_GET_SIZE(py_digest));
+		JUMP_IF_NEG_MEM(r, error);
+	}
+
 	r = ccn_charbuf_append_closer(keylocator); /* </KeyName> */
 	JUMP_IF_NEG_MEM(r, error);
 
@@ -123,18 +140,29 @@ error:
 	return r;
 }
 
+/*
+ * The key is owned by the capsule returned in *py_capsule, which needs to be
+ * held while the key is used (e.g. by signing without the GIL, the Key can
+ * be given a new one meanwhile) and released afterwards
+ */
 struct ccn_pkey *
-Key_to_ccn_private(PyObject *py_key)
+Key_to_ccn_private(PyObject *py_key, PyObject **py_capsule)
 {
 	PyObject *capsule;
-	struct ccn_pkey *key;
 
 	capsule = PyObject_GetAttrString(py_key, "ccn_data_private");
-	assert(capsule);
-	key = CCNObject_Get(PKEY_PRIV, capsule);
-	Py_DECREF(capsule);
+	if (!capsule)
+		return NULL;
+
+	if (!CCNObject_IsValid(PKEY_PRIV, capsule)) {
+		Py_DECREF(capsule);
+		PyErr_SetString(g_PyExc_CCNKeyError, "Key has no private part");
+		return NULL;
+	}
+
+	*py_capsule = capsule;
 
-	return key;
+	return CCNObject_Get(PKEY_PRIV, capsule);
 }
 
 // Can be called directly from c library
@@ -147,7 +175,6 @@ Key_obj_from_ccn(PyObject *py_key_ccn)
 {
 	struct ccn_pkey *key_ccn;
 	PyObject *py_obj_Key;
-	RSA *private_key_rsa = NULL;
 	PyObject *py_private_key_ccn = NULL, *py_public_key_ccn = NULL,
 			*py_public_key_digest = NULL;
 	int public_key_digest_len;
@@ -176,28 +203,21 @@ Key_obj_from_ccn(PyObject *py_key_ccn)
 	// 2) Parse c structure and fill python attributes
 
 	// If this is a private key, split private and public keys
-	// There is probably a less convoluted way to do this than pulling
-	// it out to RSA
 	// Also, create the digest...
-	// These non-ccn functions assume the CCN defaults, RSA + SHA256
-	private_key_rsa = ccn_key_to_rsa(key_ccn);
-	JUMP_IF_NULL(private_key_rsa, error);
-
-	r = ccn_keypair_from_rsa(public_only, private_key_rsa, &py_private_key_ccn,
-			&py_public_key_ccn);
+	// These non-ccn functions assume the CCN default digest, SHA256
+	r = ccn_keypair_from_pkey(public_only, (EVP_PKEY *) key_ccn,
+			&py_private_key_ccn, &py_public_key_ccn);
 	JUMP_IF_NEG(r, error);
 
-	r = create_public_key_digest(private_key_rsa, &py_public_key_digest,
+	r = create_public_key_digest((EVP_PKEY *) key_ccn, &py_public_key_digest,
 			&public_key_digest_len);
-	RSA_free(private_key_rsa);
-	private_key_rsa = NULL;
 	JUMP_IF_NEG(r, error);
 
 	//  ccn_digest has a more convoluted API, with examples
 	// in ccn_client, but *for now* it boils down to the same thing.
 
 	/* type */
-	py_o = PyUnicode_FromString("RSA");
+	py_o = PyUnicode_FromString(key_type_name(key_ccn));
 	JUMP_IF_NULL(py_o, error);
 	r = PyObject_SetAttrString(py_obj_Key, "type", py_o);
 	Py_DECREF(py_o);
@@ -232,7 +252,6 @@ error:
 	Py_XDECREF(py_private_key_ccn);
 	Py_XDECREF(py_public_key_ccn);
 	Py_XDECREF(py_public_key_digest);
-	RSA_free(private_key_rsa);
 	Py_XDECREF(py_obj_Key);
 	return NULL;
 }
@@ -322,7 +341,44 @@ KeyLocator_obj_from_ccn(PyObject *py_keylocator)
 		Py_DECREF(py_name_obj);
 		JUMP_IF_NEG(r, error);
 
-#pragma message "Parse and add digest to the keylocator"
+		/*
+		 * The name can be followed by a PublisherID, only the public key
+		 * digest is supported, the certificate and issuer digests aren't
+		 * used by CCNx
+		 */
+		if (ccn_buf_match_dtag(d, CCN_DTAG_PublisherPublicKeyDigest)) {
+			const unsigned char *digest;
+			size_t digest_size;
+			PyObject *py_digest;
+
+			start = d->decoder.token_index;
+			r = ccn_parse_required_tagged_BLOB(d,
+					CCN_DTAG_PublisherPublicKeyDigest, 16, 64);
+			stop = d->decoder.token_index;
+			if (r < 0) {
+				PyErr_Format(g_PyExc_CCNKeyLocatorError, "Error finding"
+						" CCN_DTAG_PublisherPublicKeyDigest for KeyName"
+						" (decoder state: %d)", d->decoder.state);
+				goto error;
+			}
+
+			r = ccn_ref_tagged_BLOB(CCN_DTAG_PublisherPublicKeyDigest, d->buf,
+					start, stop, &digest, &digest_size);
+			if (r < 0) {
+				PyErr_Format(g_PyExc_CCNKeyLocatorError, "Error getting"
+						" CCN_DTAG_PublisherPublicKeyDigest BLOB for KeyName"
+						" (decoder state: %d)", d->decoder.state);
+				goto error;
+			}
+
+			py_digest = PyBytes_FromStringAndSize((const char *) digest,
+					digest_size);
+			JUMP_IF_NULL(py_digest, error);
+			r = PyObject_SetAttrString(py_KeyLocator_obj, "keyNameDigest",
+					py_digest);
+			Py_DECREF(py_digest);
+			JUMP_IF_NEG(r, error);
+		}
 	} else if (ccn_buf_match_dtag(d, CCN_DTAG_Key)) {
 		const unsigned char *dkey;
 		size_t dkey_size;
@@ -419,8 +475,7 @@ _pyccn_cmd_KeyLocator_to_ccn(PyObject *UNUSED(self), PyObject *args,
 	JUMP_IF_NEG_MEM(r, error);
 
 	if (py_name != Py_None) {
-		//TODO: add digest as well
-		r = KeyLocator_name_to_ccn(keylocator, py_name);
+		r = KeyLocator_name_to_ccn(keylocator, py_name, py_digest);
 		JUMP_IF_NEG(r, error);
 	} else if (py_key != Py_None) {
 		r = KeyLocator_key_to_ccn(keylocator, py_key);
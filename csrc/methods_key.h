@@ -8,7 +8,7 @@
 #ifndef METHODS_KEY_H
 #  define	METHODS_KEY_H
 
-struct ccn_pkey *Key_to_ccn_private(PyObject *py_key);
+struct ccn_pkey *Key_to_ccn_private(PyObject *py_key, PyObject **py_capsule);
 PyObject *Key_obj_from_ccn(PyObject *py_key_ccn);
 PyObject *KeyLocator_obj_from_ccn(PyObject *py_keylocator);
 
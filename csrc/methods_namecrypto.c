@@ -13,6 +13,8 @@
 #include <openssl/err.h>
 
 #include "namecrypto/authentication.h"
+#include "namecrypto/keycache.h"
+#include "namecrypto/replay.h"
 
 #include "pyccn.h"
 #include "util.h"
@@ -42,6 +44,138 @@ error:
 	return NULL;
 }
 
+PyObject *
+_pyccn_cmd_nc_new_verifier(PyObject *UNUSED(self), PyObject *args)
+{
+	unsigned int max_apps = 1024, window = REPLAY_DEFAULT_WINDOW;
+	replay_table *table;
+	PyObject *py_table;
+
+	if (!PyArg_ParseTuple(args, "|II", &max_apps, &window))
+		return NULL;
+
+	if (!max_apps || !window || window > REPLAY_MAX_WINDOW) {
+		PyErr_Format(PyExc_ValueError, "max_apps needs to be positive and"
+				" window between 1 and %d", REPLAY_MAX_WINDOW);
+		return NULL;
+	}
+
+	table = replay_table_create(max_apps, window);
+	if (!table)
+		return PyErr_NoMemory();
+
+	py_table = CCNObject_New(NAMECRYPTO_VERIFIER, table);
+	if (!py_table)
+		replay_table_destroy(table);
+
+	return py_table;
+}
+
+PyObject *
+_pyccn_cmd_nc_verifier_stats(PyObject *UNUSED(self), PyObject *py_verifier)
+{
+	replay_table *table;
+
+	if (!CCNObject_ReqType(NAMECRYPTO_VERIFIER, py_verifier))
+		return NULL;
+
+	table = CCNObject_Get(NAMECRYPTO_VERIFIER, py_verifier);
+
+	return Py_BuildValue("{s:I,s:k}", "apps", replay_table_count(table),
+			"evictions", replay_table_evictions(table));
+}
+
+PyObject *
+_pyccn_cmd_nc_new_key_cache(PyObject *UNUSED(self), PyObject *UNUSED(args))
+{
+	key_cache *cache;
+	PyObject *py_cache;
+
+	cache = key_cache_create();
+	if (!cache)
+		return PyErr_NoMemory();
+
+	py_cache = CCNObject_New(NAMECRYPTO_KEYCACHE, cache);
+	if (!py_cache)
+		key_cache_destroy(cache);
+
+	return py_cache;
+}
+
+PyObject *
+_pyccn_cmd_nc_key_cache_add(PyObject *UNUSED(self), PyObject *args)
+{
+	PyObject *py_cache, *py_pub_key;
+	key_cache *cache;
+	struct ccn_pkey *pub_key;
+	unsigned char keyid[KEYIDLEN];
+	unsigned long err;
+
+	if (!PyArg_ParseTuple(args, "OO", &py_cache, &py_pub_key))
+		return NULL;
+
+	if (!CCNObject_ReqType(NAMECRYPTO_KEYCACHE, py_cache))
+		return NULL;
+
+	if (!CCNObject_ReqType(PKEY_PUB, py_pub_key))
+		return NULL;
+
+	cache = CCNObject_Get(NAMECRYPTO_KEYCACHE, py_cache);
+	pub_key = CCNObject_Get(PKEY_PUB, py_pub_key);
+
+	if (key_cache_add(cache, (EVP_PKEY *) pub_key, keyid) < 0) {
+		err = ERR_get_error();
+		PyErr_Format(g_PyExc_CCNKeyError, "Unable to add key to the cache: %s",
+				ERR_reason_error_string(err));
+		return NULL;
+	}
+
+#if PY_MAJOR_VERSION >= 3
+	return Py_BuildValue("y#", keyid, KEYIDLEN);
+#else
+	return Py_BuildValue("s#", keyid, KEYIDLEN);
+#endif
+}
+
+PyObject *
+_pyccn_cmd_nc_key_cache_remove(PyObject *UNUSED(self), PyObject *args)
+{
+	PyObject *py_cache, *py_keyid;
+	unsigned char *keyid;
+	Py_ssize_t keyid_len;
+
+	if (!PyArg_ParseTuple(args, "OO", &py_cache, &py_keyid))
+		return NULL;
+
+	if (!CCNObject_ReqType(NAMECRYPTO_KEYCACHE, py_cache))
+		return NULL;
+
+	if (PyBytes_AsStringAndSize(py_keyid, (char **) &keyid, &keyid_len) < 0)
+		return NULL;
+
+	if (keyid_len != KEYIDLEN) {
+		PyErr_Format(PyExc_ValueError, "key id needs to be %d bytes long",
+				KEYIDLEN);
+		return NULL;
+	}
+
+	if (key_cache_remove(CCNObject_Get(NAMECRYPTO_KEYCACHE, py_cache),
+			keyid) < 0)
+		Py_RETURN_FALSE;
+
+	Py_RETURN_TRUE;
+}
+
+PyObject *
+_pyccn_cmd_nc_key_cache_len(PyObject *UNUSED(self), PyObject *py_cache)
+{
+	if (!CCNObject_ReqType(NAMECRYPTO_KEYCACHE, py_cache))
+		return NULL;
+
+	return Py_BuildValue("I",
+			key_cache_count(CCNObject_Get(NAMECRYPTO_KEYCACHE, py_cache)));
+}
+
 PyObject *
 _pyccn_cmd_nc_authenticate_command(PyObject *UNUSED(self), PyObject *args)
 {
@@ -84,7 +218,14 @@ _pyccn_cmd_nc_authenticate_command(PyObject *UNUSED(self), PyObject *args)
 		Py_DECREF(py_new_name);
 	JUMP_IF_NEG_MEM(r, error);
 
-	authenticateCommand(auth_state, new_name, appname, appname_len, appkey);
+	r = authenticateCommand(auth_state, new_name, appname, appname_len, appkey);
+	if (r != AUTH_OK) {
+		Py_DECREF(py_new_name);
+		if (r == FAIL_NO_MEMORY)
+			return PyErr_NoMemory();
+		return PyErr_Format(g_PyExc_CCNError, "Unable to authenticate"
+				" the command: %s", retToString(r));
+	}
 
 	return py_new_name;
 
@@ -155,30 +296,37 @@ _pyccn_cmd_nc_verify_command(PyObject *UNUSED(self), PyObject *args,
 {
 	PyObject *py_auth_state, *py_name;
 	unsigned long maxtime_ms;
-	state *auth_state;
+	state *auth_state = NULL;
+	replay_table *table = NULL;
 	struct ccn_charbuf *name;
 	PyObject *py_fixture_key = Py_None, *py_pub_key = Py_None;
-	unsigned char *fixture_key;
-	Py_ssize_t fixture_key_len;
+	PyObject *py_key_cache = Py_None, *py_keyid = Py_None;
+	unsigned char *fixture_key, *keyid;
+	Py_ssize_t fixture_key_len, keyid_len;
 	struct ccn_pkey *pub_key;
 	RSA *rsa_pub_key;
 	int r;
 	unsigned long err;
 
 	static char *kwlist[] = {"state", "name", "maxdiff_ms", "fixture_key",
-		"pub_key", NULL};
+		"pub_key", "key_cache", "key_id", NULL};
 
-	if (!PyArg_ParseTupleAndKeywords(args, kwds, "OOk|OO", kwlist,
-			&py_auth_state, &py_name, &maxtime_ms, &py_fixture_key, &py_pub_key))
+	if (!PyArg_ParseTupleAndKeywords(args, kwds, "OOk|OOOO", kwlist,
+			&py_auth_state, &py_name, &maxtime_ms, &py_fixture_key, &py_pub_key,
+			&py_key_cache, &py_keyid))
 		return NULL;
 
-	if (!CCNObject_ReqType(NAMECRYPTO_STATE, py_auth_state))
+	/* state of a single application, or a verifier table for many */
+	if (CCNObject_IsValid(NAMECRYPTO_VERIFIER, py_auth_state))
+		table = CCNObject_Get(NAMECRYPTO_VERIFIER, py_auth_state);
+	else if (CCNObject_ReqType(NAMECRYPTO_STATE, py_auth_state))
+		auth_state = CCNObject_Get(NAMECRYPTO_STATE, py_auth_state);
+	else
 		return NULL;
 
 	if (!CCNObject_ReqType(NAME, py_name))
 		return NULL;
 
-	auth_state = CCNObject_Get(NAMECRYPTO_STATE, py_auth_state);
 	name = CCNObject_Get(NAME, py_name);
 
 	if (py_fixture_key != Py_None) {
@@ -190,19 +338,50 @@ _pyccn_cmd_nc_verify_command(PyObject *UNUSED(self), PyObject *args,
 		fixture_key_len = 0;
 	}
 
+	if (py_pub_key != Py_None && py_key_cache != Py_None) {
+		PyErr_SetString(PyExc_TypeError, "pub_key and key_cache can't be"
+				" used together");
+		return NULL;
+	}
+
 	if (py_pub_key != Py_None) {
 		if (!CCNObject_ReqType(PKEY_PUB, py_pub_key))
 			return NULL;
 		pub_key = CCNObject_Get(PKEY_PUB, py_pub_key);
 		rsa_pub_key = EVP_PKEY_get1_RSA((EVP_PKEY *) pub_key);
 		JUMP_IF_NULL(rsa_pub_key, openssl_error);
+	} else if (py_key_cache != Py_None) {
+		/* key was already converted when it was added to the cache */
+		if (!CCNObject_ReqType(NAMECRYPTO_KEYCACHE, py_key_cache))
+			return NULL;
+
+		if (PyBytes_AsStringAndSize(py_keyid, (char **) &keyid, &keyid_len) < 0)
+			return NULL;
+
+		if (keyid_len != KEYIDLEN) {
+			PyErr_Format(PyExc_ValueError, "key id needs to be %d bytes long",
+					KEYIDLEN);
+			return NULL;
+		}
+
+		rsa_pub_key = key_cache_get(CCNObject_Get(NAMECRYPTO_KEYCACHE,
+				py_key_cache), keyid);
+		if (!rsa_pub_key)
+			return Py_BuildValue("i", FAIL_VERIFICATION_KEY_NOT_PROVIDED);
 	} else
 		rsa_pub_key = NULL;
 
-	r = verifyCommand(name, fixture_key, fixture_key_len, rsa_pub_key,
-			auth_state, maxtime_ms);
+	if (table) {
+		/* the table has its own lock, verifications can run in parallel */
+		Py_BEGIN_ALLOW_THREADS
+		r = verifyCommandTable(name, fixture_key, fixture_key_len, rsa_pub_key,
+				table, maxtime_ms);
+		Py_END_ALLOW_THREADS
+	} else
+		r = verifyCommand(name, fixture_key, fixture_key_len, rsa_pub_key,
+				auth_state, maxtime_ms);
 
-	if (py_pub_key != Py_None)
+	if (rsa_pub_key)
 		RSA_free(rsa_pub_key);
 
 	if (r == AUTH_OK)
@@ -278,3 +457,126 @@ _pyccn_cmd_nc_app_key(PyObject *UNUSED(self), PyObject *args)
 	return Py_BuildValue("s#", appkey, APPKEYLEN);
 #endif
 }
+
+PyObject *
+_pyccn_cmd_nc_signer_new(PyObject *UNUSED(self), PyObject *args)
+{
+	PyObject *py_appname, *py_appkey, *py_signer;
+	unsigned char *appname, *appkey;
+	Py_ssize_t appname_len, appkey_len;
+	signer *s;
+
+	if (!PyArg_ParseTuple(args, "OO", &py_appname, &py_appkey))
+		return NULL;
+
+	if (PyBytes_AsStringAndSize(py_appname, (char **) &appname, &appname_len) < 0)
+		return NULL;
+
+	if (PyBytes_AsStringAndSize(py_appkey, (char **) &appkey, &appkey_len) < 0)
+		return NULL;
+
+	if (appname_len > 0xffff) {
+		PyErr_SetString(PyExc_ValueError, "application name is too long");
+		return NULL;
+	}
+
+	if (appkey_len != APPKEYLEN) {
+		PyErr_Format(PyExc_ValueError, "key length needs to be %d bytes long", APPKEYLEN);
+		return NULL;
+	}
+
+	s = signer_create(appname, appname_len, appkey);
+	if (!s)
+		return PyErr_NoMemory();
+
+	py_signer = CCNObject_New(NAMECRYPTO_SIGNER, s);
+	if (!py_signer)
+		signer_destroy(s);
+
+	return py_signer;
+}
+
+static PyObject *
+signer_authenticate(signer *s, PyObject *py_name)
+{
+	PyObject *py_new_name;
+	struct ccn_charbuf *name, *new_name;
+	int r;
+
+	if (!CCNObject_ReqType(NAME, py_name))
+		return NULL;
+
+	name = CCNObject_Get(NAME, py_name);
+
+	py_new_name = CCNObject_New_charbuf(NAME, &new_name);
+	JUMP_IF_NULL(py_new_name, error);
+
+	r = ccn_charbuf_append_charbuf(new_name, name);
+	JUMP_IF_NEG_MEM(r, error);
+
+	r = signerAuthenticateCommand(s, new_name);
+	if (r == FAIL_NO_MEMORY) {
+		PyErr_NoMemory();
+		goto error;
+	}
+
+	return py_new_name;
+
+error:
+	Py_XDECREF(py_new_name);
+	return NULL;
+}
+
+PyObject *
+_pyccn_cmd_nc_signer_authenticate(PyObject *UNUSED(self), PyObject *args)
+{
+	PyObject *py_signer, *py_name;
+
+	if (!PyArg_ParseTuple(args, "OO", &py_signer, &py_name))
+		return NULL;
+
+	if (!CCNObject_ReqType(NAMECRYPTO_SIGNER, py_signer))
+		return NULL;
+
+	return signer_authenticate(CCNObject_Get(NAMECRYPTO_SIGNER, py_signer),
+			py_name);
+}
+
+PyObject *
+_pyccn_cmd_nc_signer_authenticate_many(PyObject *UNUSED(self), PyObject *args)
+{
+	PyObject *py_signer, *py_names, *py_seq = NULL, *py_result = NULL;
+	PyObject *py_new_name;
+	signer *s;
+	Py_ssize_t i, n;
+
+	if (!PyArg_ParseTuple(args, "OO", &py_signer, &py_names))
+		return NULL;
+
+	if (!CCNObject_ReqType(NAMECRYPTO_SIGNER, py_signer))
+		return NULL;
+
+	s = CCNObject_Get(NAMECRYPTO_SIGNER, py_signer);
+
+	py_seq = PySequence_Fast(py_names, "names need to be a sequence");
+	JUMP_IF_NULL(py_seq, error);
+
+	n = PySequence_Fast_GET_SIZE(py_seq);
+	py_result = PyList_New(n);
+	JUMP_IF_NULL(py_result, error);
+
+	for (i = 0; i < n; i++) {
+		py_new_name = signer_authenticate(s, PySequence_Fast_GET_ITEM(py_seq, i));
+		JUMP_IF_NULL(py_new_name, error);
+		PyList_SET_ITEM(py_result, i, py_new_name);
+	}
+
+	Py_DECREF(py_seq);
+
+	return py_result;
+
+error:
+	Py_XDECREF(py_result);
+	Py_XDECREF(py_seq);
+	return NULL;
+}
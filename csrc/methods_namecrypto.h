@@ -9,6 +9,12 @@
 #  define	METHODS_NAMECRYPTO_H
 
 PyObject *_pyccn_cmd_nc_new_state(PyObject *self, PyObject *args);
+PyObject *_pyccn_cmd_nc_new_verifier(PyObject *self, PyObject *args);
+PyObject *_pyccn_cmd_nc_verifier_stats(PyObject *self, PyObject *py_verifier);
+PyObject *_pyccn_cmd_nc_new_key_cache(PyObject *self, PyObject *args);
+PyObject *_pyccn_cmd_nc_key_cache_add(PyObject *self, PyObject *args);
+PyObject *_pyccn_cmd_nc_key_cache_remove(PyObject *self, PyObject *args);
+PyObject *_pyccn_cmd_nc_key_cache_len(PyObject *self, PyObject *py_cache);
 PyObject *_pyccn_cmd_nc_authenticate_command(PyObject *self, PyObject *args);
 PyObject *_pyccn_cmd_nc_authenticate_command_sig(PyObject *self,
 		PyObject *args);
@@ -16,6 +22,10 @@ PyObject *_pyccn_cmd_nc_verify_command(PyObject *self, PyObject *args,
 		PyObject *kwds);
 PyObject *_pyccn_cmd_nc_app_id(PyObject *self, PyObject *py_appname);
 PyObject *_pyccn_cmd_nc_app_key(PyObject *self, PyObject *args);
+PyObject *_pyccn_cmd_nc_signer_new(PyObject *self, PyObject *args);
+PyObject *_pyccn_cmd_nc_signer_authenticate(PyObject *self, PyObject *args);
+PyObject *_pyccn_cmd_nc_signer_authenticate_many(PyObject *self,
+		PyObject *args);
 
 #endif	/* METHODS_NAMECRYPTO_H */
 
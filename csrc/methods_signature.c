@@ -40,7 +40,7 @@ append_digest_algorithm(struct ccn_charbuf *signature,
 		assert((Py_ssize_t) strlen(str) == str_len);
 		JUMP_IF_NULL(py_o, error);
 
-		r = ccnb_append_tagged_blob(signature, CCN_DTAG_DigestAlgorithm,
+		r = ccnb_append_tagged_udata(signature, CCN_DTAG_DigestAlgorithm,
 				str, str_len);
 		Py_DECREF(py_o);
 		JUMP_IF_NEG_MEM(r, error);
@@ -197,16 +197,16 @@ Signature_obj_from_ccn(PyObject *py_signature)
 	debug("Is a signature\n");
 	ccn_buf_advance(d);
 
-	/* CCN_DTAG_DigestAlgorithm */
+	/* CCN_DTAG_DigestAlgorithm, an OID string (UDATA, not a BLOB) */
 	start = d->decoder.token_index;
-	ccn_parse_optional_tagged_BLOB(d, CCN_DTAG_DigestAlgorithm, 1, -1);
+	ccn_parse_optional_tagged_UDATA(d, CCN_DTAG_DigestAlgorithm);
 	stop = d->decoder.token_index;
 
-	r = ccn_ref_tagged_BLOB(CCN_DTAG_DigestAlgorithm, d->buf, start, stop,
+	r = ccn_ref_tagged_string(CCN_DTAG_DigestAlgorithm, d->buf, start, stop,
 			&ptr, &size);
 	if (r == 0) {
 		debug("PyObject_SetAttrString digestAlgorithm\n");
-		py_o = PyBytes_FromStringAndSize((const char*) ptr, size);
+		py_o = PyUnicode_FromStringAndSize((const char*) ptr, size);
 		JUMP_IF_NULL(py_o, error);
 		r = PyObject_SetAttrString(py_obj_signature, "digestAlgorithm", py_o);
 		Py_DECREF(py_o);
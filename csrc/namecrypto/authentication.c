@@ -12,12 +12,14 @@
 #include <string.h>
 #include <time.h>
 #include <assert.h>
+#include <pthread.h>
 #include <sys/time.h>
 #include <openssl/sha.h>
 #include <openssl/hmac.h>
 #include <openssl/evp.h>
 #include <openssl/rsa.h>
 #include <openssl/err.h>
+#include <openssl/crypto.h>
 
 #include <arpa/inet.h>
 
@@ -26,12 +28,42 @@
 #include "toolkit.h"
 #include "authentication.h"
 #include "encryption.h"
+#include "replay.h"
 
 //#define AUTHDEBUG
 
-static int verify_update_state_freshness(state * currstate, state * new_state, unsigned long int maxTimeDifferenceMsec);
-static int verifyCommandSymm(unsigned char * authenticator, unsigned int auth_len, unsigned char * command_name, unsigned int command_len, unsigned char * fixtureKey, unsigned int key_len, state * currstate, unsigned long int maxTimeDifferenceMsec);
-static int verifyCommandSig(unsigned char * authenticator, unsigned int auth_len, unsigned char * command_name, unsigned int command_len, state * currstate, RSA * pubKey, unsigned long maxTimeDifferenceMsec);
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+static HMAC_CTX *
+HMAC_CTX_new(void)
+{
+	HMAC_CTX *ctx;
+
+	ctx = malloc(sizeof(*ctx));
+	if (ctx)
+		HMAC_CTX_init(ctx);
+
+	return ctx;
+}
+
+static void
+HMAC_CTX_free(HMAC_CTX *ctx)
+{
+	if (ctx) {
+		HMAC_CTX_cleanup(ctx);
+		free(ctx);
+	}
+}
+#endif
+
+struct signer_st {
+	state st;
+	HMAC_CTX *ctx; // keyed with the app key, only reset for every command
+	unsigned int appname_len;
+	unsigned char appname[];
+};
+
+static int verify_state_freshness(const state * currstate, const state * new_state, unsigned long int maxTimeDifferenceMsec);
+static void update_verified_state(state * currstate, const state * new_state);
 
 char *
 retToString(int r)
@@ -58,6 +90,9 @@ retToString(int r)
 	case FAIL_VERIFICATION_KEY_NOT_PROVIDED:
 		return("The appropriate verification key has not been supplied\n");
 
+	case FAIL_INVALID_AUTHENTICATOR:
+		return("Malformed interest authenticator\n");
+
 	case FAIL_NO_MEMORY:
 		return("malloc() failed");
 
@@ -76,29 +111,12 @@ retToString(int r)
 unsigned char *
 appID(unsigned char *uniqueAppName, unsigned int uniqueAppName_len, unsigned char *appid)
 {
-	unsigned char * s;
+	assert(SHA256_DIGEST_LENGTH == APPIDLEN);
 
-	assert(SHA256_DIGEST_LENGTH >= APPIDLEN);
-
-	if (!(s = (unsigned char *) malloc(SHA256_DIGEST_LENGTH)))
+	if (!appid && !(appid = (unsigned char *) malloc(APPIDLEN)))
 		return NULL;
 
-	SHA256((unsigned char *) uniqueAppName, uniqueAppName_len, s);
-
-	if (!appid) {
-		//appid == NULL
-		unsigned char * tmp;
-		if (!(tmp = (unsigned char *) malloc(APPIDLEN)))
-			return NULL;
-		memcpy(tmp, s, APPIDLEN);
-		free(s);
-		return tmp;
-	} else {
-		//appid != NULL
-		memcpy(appid, s, APPIDLEN);
-		free(s);
-		return appid;
-	}
+	return SHA256((unsigned char *) uniqueAppName, uniqueAppName_len, appid);
 }
 
 /*
@@ -166,10 +184,34 @@ update_state(state * st)
 	}
 }
 
-int
-verify_update_state_freshness(state * currstate, state * new_state, unsigned long int maxDelay)
+static void
+state_to_net(const state * st, state * net_st)
+{
+	net_st->tv_sec = htonl(st->tv_sec);
+	net_st->tv_usec = htonl(st->tv_usec);
+	net_st->seq = htonl(st->seq);
+	net_st->rsvd = htonl(st->rsvd);
+}
+
+//Check if the interest is recent
+static int
+check_time(const state * st, const struct timeval * t_now, unsigned long int maxDelay)
 {
 	long int diff;
+
+	if (maxDelay > 0) {
+		diff = (int) ((t_now->tv_sec - st->tv_sec)*1000000 + t_now->tv_usec - st->tv_usec) / 1000;
+		if (labs(diff) > maxDelay)
+			return FAIL_COMMAND_EXPIRED;
+	}
+
+	return AUTH_OK;
+}
+
+// currstate isn't changed here, only once the command's MAC is verified
+static int
+verify_state_freshness(const state * currstate, const state * new_state, unsigned long int maxDelay)
+{
 	struct timeval t_now;
 
 	if (!currstate || !new_state)
@@ -179,108 +221,215 @@ verify_update_state_freshness(state * currstate, state * new_state, unsigned lon
 	if ((currstate->seq) >= (new_state->seq))
 		return FAIL_DUPLICATE_INTEREST;
 
-	//Check if the interest is recent
 	gettimeofday(&t_now, NULL);
-	if (maxDelay > 0) {
-		diff = (int) ((t_now.tv_sec - new_state->tv_sec)*1000000 + t_now.tv_usec - new_state->tv_usec) / 1000;
-		if (labs(diff) > maxDelay)
-			return FAIL_COMMAND_EXPIRED;
-	}
+	if (check_time(new_state, &t_now, maxDelay) != AUTH_OK)
+		return FAIL_COMMAND_EXPIRED;
 
-	// The state of the interest looks good. Update current application state
+	return AUTH_OK;
+}
+
+// The state of the interest looks good. Update current application state
+static void
+update_verified_state(state * currstate, const state * new_state)
+{
+	struct timeval t_now;
+
+	if (!currstate)
+		return;
+
+	gettimeofday(&t_now, NULL);
 	currstate->seq = new_state->seq;
 	currstate->tv_sec = t_now.tv_sec; // should I set the app state to now or to the time in the accepted interest?
 	currstate->tv_usec = t_now.tv_usec;
+}
+
+/*
+ * Appends the authenticator to commandname, ctx needs to be keyed with the
+ * app key. The MAC is computed straight from the charbuf and the component
+ * is written in place (no scratch copies of the name).
+ */
+static int
+append_authenticator(HMAC_CTX *ctx, state *st, struct ccn_charbuf *commandname, const unsigned char *appname, unsigned int appname_len)
+{
+	unsigned char mac[MACLEN];
+	unsigned char len[2];
+	state net_st;
+	size_t authenticatorlen;
+
+	assert(commandname->length >= 2);
+	assert(commandname->buf[commandname->length - 1] == CCN_CLOSE);
+	assert(appname_len <= 0xffff);
+
+	// update and store the current time in "state"
+	update_state(st);
+	state_to_net(st, &net_st);
+
+	if (!HMAC_Init_ex(ctx, NULL, 0, NULL, NULL)
+			|| !HMAC_Update(ctx, commandname->buf, commandname->length)
+			|| !HMAC_Update(ctx, appname, appname_len)
+			|| !HMAC_Update(ctx, (unsigned char *) &net_st, sizeof(net_st))
+			|| !HMAC_Final(ctx, mac, NULL))
+		return FAIL_NO_MEMORY;
+
+#ifdef AUTHDEBUG
+	printf("\nFunction append_authenticator:\nappname= ");
+	print_hex((unsigned char *) appname, appname_len);
+	printf("\nmac    = ");
+	print_hex(mac, MACLEN);
+	printf("\n");
+#endif
+
+	authenticatorlen = AUTH_MAGIC_LEN + 2 + appname_len + sizeof(net_st) + MACLEN;
+	len[0] = (appname_len >> 8) & 0xff;
+	len[1] = appname_len & 0xff;
+
+	// reopen the name and add (AUTH_MAGIC|appname_len|appname|state|MAC) as its last component
+	if (!ccn_charbuf_reserve(commandname, authenticatorlen + 8))
+		return FAIL_NO_MEMORY;
+	commandname->length--;
+
+	if (ccn_charbuf_append_tt(commandname, CCN_DTAG_Component, CCN_DTAG) < 0
+			|| ccn_charbuf_append_tt(commandname, authenticatorlen, CCN_BLOB) < 0
+			|| ccn_charbuf_append(commandname, SK_AUTH_MAGIC, AUTH_MAGIC_LEN) < 0
+			|| ccn_charbuf_append(commandname, len, 2) < 0
+			|| ccn_charbuf_append(commandname, appname, appname_len) < 0
+			|| ccn_charbuf_append(commandname, &net_st, sizeof(net_st)) < 0
+			|| ccn_charbuf_append(commandname, mac, MACLEN) < 0
+			|| ccn_charbuf_append_closer(commandname) < 0
+			|| ccn_charbuf_append_closer(commandname) < 0)
+		return FAIL_NO_MEMORY;
 
 	return AUTH_OK;
 }
 
+/*
+ * authenticateCommand() keeps an HMAC context per thread, keyed with the app
+ * key it was last called with, so a command only costs resetting it (same as
+ * with a signer)
+ */
+struct auth_ctx {
+	HMAC_CTX *ctx;
+	unsigned char appkey[APPKEYLEN];
+	int keyed;
+};
+
+static pthread_key_t g_auth_ctx_key;
+static pthread_once_t g_auth_ctx_once = PTHREAD_ONCE_INIT;
+static int g_auth_ctx_key_ok;
+
+static void
+auth_ctx_free(void *p)
+{
+	struct auth_ctx *a = p;
+
+	HMAC_CTX_free(a->ctx);
+	OPENSSL_cleanse(a->appkey, sizeof(a->appkey));
+	free(a);
+}
+
+static void
+auth_ctx_key_create(void)
+{
+	g_auth_ctx_key_ok = !pthread_key_create(&g_auth_ctx_key, auth_ctx_free);
+}
+
+static HMAC_CTX *
+auth_ctx_get(const unsigned char *appkey)
+{
+	struct auth_ctx *a;
+
+	pthread_once(&g_auth_ctx_once, auth_ctx_key_create);
+	if (!g_auth_ctx_key_ok)
+		return NULL;
+
+	a = pthread_getspecific(g_auth_ctx_key);
+	if (!a) {
+		if (!(a = (struct auth_ctx *) calloc(1, sizeof(*a))))
+			return NULL;
+		if (!(a->ctx = HMAC_CTX_new()) || pthread_setspecific(g_auth_ctx_key, a)) {
+			HMAC_CTX_free(a->ctx);
+			free(a);
+			return NULL;
+		}
+	}
+
+	if (!a->keyed || memcmp(a->appkey, appkey, APPKEYLEN)) {
+		a->keyed = 0;
+		if (!HMAC_Init_ex(a->ctx, appkey, APPKEYLEN, EVP_sha256(), NULL))
+			return NULL;
+		memcpy(a->appkey, appkey, APPKEYLEN);
+		a->keyed = 1;
+	}
+
+	return a->ctx;
+}
+
 /*
  * commandname is an NDN name of a light including the command
  * e.g. commandname = /ndn/ucla.edu/apps/TV1/room123/light4/switch/on
  * commandname is ccn_charbuf containing a ccnb encoded name with closing 0x00
  * authenticatedCommand = commandname/(AUTH_MAGIC|appname_len|appname|state|MAC(commandname|appname|state))
  * where appname_len is fixed 2 bytes and AUTH_MAGIC is fixed 4 bytes
+ *
+ * Returns AUTH_OK, or FAIL_NO_MEMORY when the authenticator couldn't be
+ * computed or appended
  */
-void
+int
 authenticateCommand(state *st, struct ccn_charbuf *commandname, unsigned char *appname, unsigned int appname_len, unsigned char *appkey)
 {
-	unsigned char mac[MACLEN];
-	unsigned char *m;
-	unsigned char *authenticator;
-	unsigned char *authenticatorwithmagic;
-	int authenticatorlen;
-	long int command_len;
-
-	int state_len = sizeof(state);
+	HMAC_CTX *ctx;
 
-	int appname_offset = 2;
-	int state_offset = appname_offset + appname_len;
-	int mac_offset = state_offset + state_len;
+	if (!(ctx = auth_ctx_get(appkey)))
+		return FAIL_NO_MEMORY;
 
-	// update and store the current time in "state"
-	update_state(st);
-    state net_st;  // Convert 'st' into network byte order
-    net_st.tv_sec = htonl(st->tv_sec);
-    net_st.tv_usec = htonl(st->tv_usec);
-    net_st.seq = htonl(st->seq);
-    net_st.rsvd = htonl(st->rsvd);
-
-	command_len = commandname->length;
-
-	m = (unsigned char *) malloc(command_len + appname_len + state_len);
-
-	memcpy(m, commandname->buf, command_len);
-    memcpy(m + command_len, appname, appname_len);
-	memcpy(m + command_len + appname_len, &net_st, state_len);
-	HMAC(EVP_sha256(), appkey, APPKEYLEN, m, command_len + appname_len + state_len, mac, NULL);
-
-	authenticatorlen = 2 + appname_len + state_len + MACLEN;
-	authenticatorwithmagic = (unsigned char *) malloc(authenticatorlen + AUTH_MAGIC_LEN);
-	
-    // Add AUTH_MAGIC
-    memcpy(authenticatorwithmagic, SK_AUTH_MAGIC, AUTH_MAGIC_LEN);
+	return append_authenticator(ctx, st, commandname, appname, appname_len);
+}
 
-    // Add appname_len
-	authenticator = authenticatorwithmagic + AUTH_MAGIC_LEN;
+/*
+ * Same as authenticateCommand() for many commands of one application, the
+ * HMAC key schedule is computed once in signer_create()
+ */
+signer *
+signer_create(unsigned char *appname, unsigned int appname_len, unsigned char *appkey)
+{
+	signer *s;
 
-	authenticator[0] = (appname_len >> 8) & 0xff;
-	authenticator[1] = appname_len & 0xff;
+	if (!(s = (signer *) malloc(sizeof(*s) + appname_len)))
+		return NULL;
 
-    // Add appname
-	memcpy(authenticator + appname_offset, appname, appname_len);
-	
-    // Add state
-    //memcpy(authenticator + state_offset, st, state_len);
-    memcpy(authenticator + state_offset, &net_st, state_len);
-	
-    // Add MAC signature
-    memcpy(authenticator + mac_offset, mac, MACLEN);
+	s->ctx = HMAC_CTX_new();
+	if (!s->ctx || !HMAC_Init_ex(s->ctx, appkey, APPKEYLEN, EVP_sha256(), NULL)) {
+		HMAC_CTX_free(s->ctx);
+		free(s);
+		return NULL;
+	}
 
-    // Construct authenticated name
-	ccn_name_append(commandname, authenticatorwithmagic, authenticatorlen + AUTH_MAGIC_LEN);
+	state_init(&s->st);
+	s->appname_len = appname_len;
+	memcpy(s->appname, appname, appname_len);
 
+	return s;
+}
 
-#ifdef AUTHDEBUG
-	printf("\nFunction authenticateCommand:\nappname= ");
-	print_hex(appname, appname_len);
-	printf("\nappkey = ");
-	print_hex(appkey, APPKEYLEN);
-	printf("\nmac    = ");
-	print_hex(mac, MACLEN);
-	printf("\nm      = ");
-	print_hex(m, command_len + appname_len + state_len);
-	printf("\n");
-#endif
+void
+signer_destroy(signer *s)
+{
+	if (s) {
+		HMAC_CTX_free(s->ctx);
+		free(s);
+	}
+}
 
-	free(m);
-	free(authenticatorwithmagic);
+int
+signerAuthenticateCommand(signer *s, struct ccn_charbuf *commandname)
+{
+	return append_authenticator(s->ctx, &s->st, commandname, s->appname, s->appname_len);
 }
 
 
 /* return NOT_AUTHENTICATOR if no authenticator, AUTH_SYMMETRIC if symmetric, AUTH_ASYMMETRIC if asymmetric */
 static int
-detect_autenticator(unsigned char * component)
+detect_autenticator(const unsigned char * component)
 {
 	if (!memcmp(component, PK_AUTH_MAGIC, AUTH_MAGIC_LEN))
 		return AUTH_ASYMMETRIC;
@@ -290,190 +439,298 @@ detect_autenticator(unsigned char * component)
 	return NOT_AUTHENTICATOR;
 }
 
+/*
+ * Finds the last authenticator component of name. Nothing is copied,
+ * authenticatorwithmagic points into name and prefix_len is the length of
+ * the name (without its closing 0x00) preceding the authenticator.
+ */
 static int
-extractFromInterest(unsigned char ** authenticatorwithmagic, unsigned int * auth_len, unsigned char ** prefix, unsigned int * prefix_len, struct ccn_charbuf *name)
+extractFromInterest(const unsigned char ** authenticatorwithmagic, size_t * auth_len, size_t * prefix_len, struct ccn_charbuf *name)
 {
-	struct ccn_indexbuf *nix = ccn_indexbuf_create();
-	int num_components, i, atype;
-	size_t len;
-    
-	unsigned char * out;
-    
+	struct ccn_indexbuf *nix;
+	int num_components, i, atype = FAIL_MISSING_AUTHENTICATOR;
+
+	if (!(nix = ccn_indexbuf_create()))
+		return FAIL_NO_MEMORY;
+
 	num_components = ccn_name_split(name, nix);
-    
-	i = num_components - 1;
-	while (i > 0) // The first component cannot be an authenticator
-	{
-		if (ccn_name_comp_get(name->buf, nix, i, (const unsigned char **) &out, &len)) {
-            ccn_indexbuf_destroy(&nix);
-			return FAIL_MISSING_AUTHENTICATOR;
-        }
-		atype = detect_autenticator(out);
-		if (atype != NOT_AUTHENTICATOR) {
-			*authenticatorwithmagic = (unsigned char *) malloc(len);
-			memcpy(*authenticatorwithmagic, out, len);
-			*auth_len = (unsigned int) len;
-            
-			ccn_name_comp_get(name->buf, nix, i - 1, (const unsigned char **) &out, &len);
-			*prefix_len = (unsigned int) (len + (out - name->buf)) + 2;
-            
-#ifdef AUTHDEBUG
-            printf("\nextractFromInterest: len=%lu\n", len);
-            printf("extractFromInterest: out=%p\n", out);
-            printf("extractFromInterest: name->buf=%p\n", name->buf);
-            printf("extractFromInterest: prefix_len=%u\n", *prefix_len);
-#endif
-            
-			*prefix = (unsigned char *) malloc(*prefix_len);
-			memcpy(*prefix, name->buf, *prefix_len - 1);
-            (*prefix)[*prefix_len - 1] = 0x00;  // Put a tailing '0' byte to close the name encoding
-            
-#ifdef AUTHDEBUG
-            printf("extractFromInterest: *prefix=\n");
-            print_hex(*prefix, *prefix_len);
-            printf("\n");
-#endif
-            
-			ccn_indexbuf_destroy(&nix);
-            
-			return atype;
+
+	// The first component cannot be an authenticator
+	for (i = num_components - 1; i > 0; i--) {
+		if (ccn_name_comp_get(name->buf, nix, i, authenticatorwithmagic, auth_len))
+			break;
+		if (*auth_len < AUTH_MAGIC_LEN)
+			continue;
+
+		if (detect_autenticator(*authenticatorwithmagic) != NOT_AUTHENTICATOR) {
+			atype = detect_autenticator(*authenticatorwithmagic);
+			*prefix_len = nix->buf[i];
+			break;
 		}
-		i--;
 	}
-    
+
 	ccn_indexbuf_destroy(&nix);
-    return FAIL_MISSING_AUTHENTICATOR; // No authenticator in the string
+
+	return atype;
 }
 
+/*
+ * Splits authenticator (without magic) into appname and state, returns
+ * FAIL_INVALID_AUTHENTICATOR unless it's followed by exactly sig_len bytes
+ */
+static int
+parse_authenticator(const unsigned char * authenticator, size_t auth_len, size_t sig_len, const unsigned char ** appname, unsigned int * appname_len, state * host_st)
+{
+	state net_st;
 
-/* Determines if an interest is authenticated with symmetric or asymmetric crypto and verifies it accordingly */
-int
-verifyCommand(struct ccn_charbuf *authenticatedname, unsigned char *fixtureKey,
+	if (auth_len < 2)
+		return FAIL_INVALID_AUTHENTICATOR;
+
+	*appname_len = (authenticator[0] << 8) + authenticator[1];
+	if (auth_len != 2 + *appname_len + sizeof(state) + sig_len)
+		return FAIL_INVALID_AUTHENTICATOR;
+
+	*appname = authenticator + 2;
+	memcpy(&net_st, *appname + *appname_len, sizeof(net_st));
+	host_st->tv_sec = ntohl(net_st.tv_sec);
+	host_st->tv_usec = ntohl(net_st.tv_usec);
+	host_st->seq = ntohl(net_st.seq);
+	host_st->rsvd = ntohl(net_st.rsvd);
+
+	return AUTH_OK;
+}
+
+/*
+ * maxTimeDifference is the number of seconds that the command can differ from now.
+ * Full name = commandname/(AUTH_MAGIC|authenticator)
+ * authenticator = appname_len|appname|state|MAC(commandname|appname|state), where appname_len is fixed 2 bytes
+ * commandname is the first command_len bytes of name plus the closing 0x00
+ */
+static int
+verifyCommandSymm(const unsigned char *authenticator, size_t auth_len,
+		const unsigned char *name, size_t command_len,
+		unsigned char *fixtureKey, unsigned int key_len, state *currstate,
+		unsigned long int maxTimeDifferenceMsec)
+{
+	const unsigned char * appname;
+	unsigned int appname_len;
+	state host_st;
+	int r;
+
+	unsigned char app_key[APPKEYLEN];
+	unsigned char app_id[APPIDLEN];
+	unsigned char computed_mac[MACLEN];
+	HMAC_CTX *ctx;
+
+	r = parse_authenticator(authenticator, auth_len, MACLEN, &appname, &appname_len, &host_st);
+	if (r != AUTH_OK)
+		return r;
+
+	// Verify fresnhess of command
+	r = verify_state_freshness(currstate, &host_st, maxTimeDifferenceMsec);
+	if ((r != AUTH_OK) && (r != INFO_STATE_NOT_VERIFIED))
+		return r;
+
+	// Compute appkey
+	appID((unsigned char *) appname, appname_len, app_id);
+	if (!appKey(fixtureKey, key_len, app_id, app_key))
+		return FAIL_NO_MEMORY;
+
+	if (!(ctx = HMAC_CTX_new()))
+		return FAIL_NO_MEMORY;
+
+	r = HMAC_Init_ex(ctx, app_key, APPKEYLEN, EVP_sha256(), NULL)
+		&& HMAC_Update(ctx, name, command_len)
+		&& HMAC_Update(ctx, (const unsigned char *) "", 1)
+		&& HMAC_Update(ctx, appname, appname_len + sizeof(state))
+		&& HMAC_Final(ctx, computed_mac, NULL);
+	HMAC_CTX_free(ctx);
+
+	if (!r)
+		return FAIL_NO_MEMORY;
+
+#ifdef AUTHDEBUG
+	printf("\nFunction verifyCommandSymm:\nappname= ");
+	print_hex((unsigned char *) appname, appname_len);
+	printf("\nappkey = ");
+	print_hex(app_key, APPKEYLEN);
+	printf("\ncmac   = ");
+	print_hex(computed_mac, MACLEN);
+	printf("\n");
+#endif
+
+	if (CRYPTO_memcmp(computed_mac, appname + appname_len + sizeof(state), MACLEN))
+		return FAIL_VERIFICATION_FAILED;
+
+	update_verified_state(currstate, &host_st);
+
+	return AUTH_OK;
+}
+
+/*
+ * The signature is Sig(commandname|appname|state), see authenticateCommandSig()
+ */
+static int
+verifyCommandSig(const unsigned char *authenticator, size_t auth_len,
+		const unsigned char *name, size_t command_len, state *currstate,
+		RSA *pubKey, unsigned long maxTimeDifferenceMsec)
+{
+	const unsigned char * appname;
+	unsigned int appname_len;
+	state host_st;
+	int r;
+
+	unsigned char md[SHA256_DIGEST_LENGTH];
+	SHA256_CTX ctx;
+
+	r = parse_authenticator(authenticator, auth_len, RSA_size(pubKey), &appname, &appname_len, &host_st);
+	if (r != AUTH_OK)
+		return r;
+
+	// Verify fresnhess of command
+	r = verify_state_freshness(currstate, &host_st, maxTimeDifferenceMsec);
+	if ((r != AUTH_OK) && (r != INFO_STATE_NOT_VERIFIED))
+		return r;
+
+	SHA256_Init(&ctx);
+	SHA256_Update(&ctx, name, command_len);
+	SHA256_Update(&ctx, "", 1);
+	SHA256_Update(&ctx, appname, appname_len + sizeof(state));
+	SHA256_Final(md, &ctx);
+
+#ifdef AUTHDEBUG
+	printf("\nFunction verifyCommandSig:\nappname       = ");
+	print_hex((unsigned char *) appname, appname_len);
+	printf("\nmd            = ");
+	print_hex(md, SHA256_DIGEST_LENGTH);
+	printf("\n");
+#endif
+
+	if (!RSA_verify(NID_sha256, md, SHA256_DIGEST_LENGTH, appname + appname_len + sizeof(state), RSA_size(pubKey), pubKey))
+		return FAIL_VERIFICATION_FAILED;
+
+	update_verified_state(currstate, &host_st);
+
+	return AUTH_OK;
+}
+
+static int
+verify(struct ccn_charbuf *authenticatedname, unsigned char *fixtureKey,
 		unsigned int keylen, RSA *pubkey, state *currstate, unsigned long int maxTimeDifferenceMsec)
 {
-	unsigned char * authenticatorwithmagic, * prefix;
-	unsigned int auth_len, prefix_len;
+	const unsigned char * authenticatorwithmagic;
+	size_t auth_len, prefix_len;
 	int ret;
 
-	ret = extractFromInterest(&authenticatorwithmagic, &auth_len, &prefix, &prefix_len, authenticatedname);
-
-	if (FAIL_MISSING_AUTHENTICATOR == ret)
-		return FAIL_MISSING_AUTHENTICATOR; // If the authenticator is not present
+	ret = extractFromInterest(&authenticatorwithmagic, &auth_len, &prefix_len, authenticatedname);
 
 	switch (ret) {
 	case AUTH_ASYMMETRIC:
 		if (!pubkey)
 			return FAIL_VERIFICATION_KEY_NOT_PROVIDED;
 
-		ret = verifyCommandSig(authenticatorwithmagic + AUTH_MAGIC_LEN,
-				auth_len - AUTH_MAGIC_LEN, prefix, prefix_len, currstate, pubkey,
-				maxTimeDifferenceMsec);
-
-		break;
+		return verifyCommandSig(authenticatorwithmagic + AUTH_MAGIC_LEN,
+				auth_len - AUTH_MAGIC_LEN, authenticatedname->buf, prefix_len,
+				currstate, pubkey, maxTimeDifferenceMsec);
 
 	case AUTH_SYMMETRIC:
 		if (!(fixtureKey && keylen))
 			return FAIL_VERIFICATION_KEY_NOT_PROVIDED;
 
-		ret = verifyCommandSymm(authenticatorwithmagic + AUTH_MAGIC_LEN,
-				auth_len - AUTH_MAGIC_LEN, prefix, prefix_len, fixtureKey,
-				keylen, currstate, maxTimeDifferenceMsec);
+		return verifyCommandSymm(authenticatorwithmagic + AUTH_MAGIC_LEN,
+				auth_len - AUTH_MAGIC_LEN, authenticatedname->buf, prefix_len,
+				fixtureKey, keylen, currstate, maxTimeDifferenceMsec);
 
-		break;
+	case FAIL_NO_MEMORY:
+		return FAIL_NO_MEMORY;
 
 	default:
-		ret = FAIL_MISSING_AUTHENTICATOR;
+		return FAIL_MISSING_AUTHENTICATOR; // If the authenticator is not present
 	}
-    
-	free(prefix);
-    free(authenticatorwithmagic);
-    
-    return ret;
 }
 
 /*
- * maxTimeDifference is the number of seconds that the command can differ from now.
- * Full name = commandname/(AUTH_MAGIC|authenticator)
- * authenticator = appname_len|appname|state|MAC(commandname|appname|state), where appname_len is fixed 2 bytes
+ * Determines if an interest is authenticated with symmetric or asymmetric
+ * crypto and verifies it accordingly. currstate is updated only when the
+ * MAC (or signature) is correct.
  */
 int
-verifyCommandSymm(unsigned char *authenticator, unsigned int auth_len,
-        unsigned char *command_name, unsigned int command_len,
-		unsigned char *fixtureKey, unsigned int key_len, state *currstate,
-		unsigned long int maxTimeDifferenceMsec)
+verifyCommand(struct ccn_charbuf *authenticatedname, unsigned char *fixtureKey,
+		unsigned int keylen, RSA *pubkey, state *currstate, unsigned long int maxTimeDifferenceMsec)
 {
-	state * st;
-    state host_st;
+	return verify(authenticatedname, fixtureKey, keylen, pubkey, currstate, maxTimeDifferenceMsec);
+}
 
-	int state_len = sizeof(state);
-	int appname_len;
-	int appname_offset = 2;
-	int state_offset;
-	int mac_offset;
-	int state_ret;
-    int msg_len;
+/*
+ * Like verifyCommand(), but the sequence number is checked against the
+ * application's window in table instead of a single state. The MAC (or
+ * signature) is verified before the table is updated, so forged commands
+ * can't use up sequence numbers.
+ */
+int
+verifyCommandTable(struct ccn_charbuf *authenticatedname, unsigned char *fixtureKey,
+		unsigned int keylen, RSA *pubkey, replay_table *table, unsigned long int maxTimeDifferenceMsec)
+{
+	const unsigned char *authenticator, *appname;
+	size_t auth_len, prefix_len, sig_len;
+	unsigned int appname_len;
+	unsigned char appid[APPIDLEN];
+	state host_st;
+	struct timeval t_now;
+	int atype, r;
 
-	unsigned char * appname;
-	unsigned char app_key[APPKEYLEN];
-	unsigned char * app_id;
-	unsigned char * m;
-	unsigned char * mac;
-	unsigned char computed_mac[MACLEN];
+	atype = extractFromInterest(&authenticator, &auth_len, &prefix_len, authenticatedname);
+	switch (atype) {
+	case AUTH_ASYMMETRIC:
+		if (!pubkey)
+			return FAIL_VERIFICATION_KEY_NOT_PROVIDED;
+		sig_len = RSA_size(pubkey);
+		break;
 
-	appname_len = (authenticator[0] << 8) + authenticator[1];
-	state_offset = appname_offset + appname_len;
-	mac_offset = state_offset + state_len;
-    
-    assert (auth_len == (unsigned int)(mac_offset + MACLEN));
+	case AUTH_SYMMETRIC:
+		if (!(fixtureKey && keylen))
+			return FAIL_VERIFICATION_KEY_NOT_PROVIDED;
+		sig_len = MACLEN;
+		break;
 
-	appname = authenticator + appname_offset;
-	app_id = appID(appname, appname_len, NULL);
-	st = (state *) (authenticator + state_offset);
-    host_st.tv_sec = ntohl(st->tv_sec);
-    host_st.tv_usec = ntohl(st->tv_usec);
-    host_st.seq = ntohl(st->seq);
-    host_st.rsvd = ntohl(st->rsvd);
-	mac = authenticator + mac_offset;
+	case FAIL_NO_MEMORY:
+		return FAIL_NO_MEMORY;
 
-	// Verify fresnhess of command
-	state_ret = verify_update_state_freshness(currstate, &host_st, maxTimeDifferenceMsec);
-	if ((state_ret != AUTH_OK) && (state_ret != INFO_STATE_NOT_VERIFIED))
-		return state_ret;
-    
-	// Compute appkey
-	appKey(fixtureKey, key_len, app_id, app_key);
+	default:
+		return FAIL_MISSING_AUTHENTICATOR;
+	}
 
-    msg_len = command_len + appname_len + state_len;
-	m = (unsigned char *) malloc(msg_len);
-	memcpy(m, command_name, command_len);
-    memcpy(m + command_len, appname, appname_len);
-	memcpy(m + command_len + appname_len, authenticator + state_offset, state_len);
-    
-	HMAC(EVP_sha256(), app_key, APPKEYLEN, m, msg_len, computed_mac, NULL);
+	// appname_len|appname|state|MAC or signature
+	authenticator += AUTH_MAGIC_LEN;
+	auth_len -= AUTH_MAGIC_LEN;
 
-#ifdef AUTHDEBUG
-	printf("\nFunction verifyCommandSymm:\nappname= ");
-	print_hex(appname, appname_len);
-	printf("\nappid  = ");
-	print_hex(app_id, APPIDLEN);
-	printf("\nappkey = ");
-	print_hex(app_key, APPKEYLEN);
-	printf("\nmac    = ");
-	print_hex(mac, MACLEN);
-	printf("\ncmac   = ");
-	print_hex(computed_mac, MACLEN);
-	printf("\nm      = ");
-	print_hex(m, command_len + appname_len + state_len);
-//	printf("\ncommand_len=%d, state_len=%d, struct timeval t=%lu, time_t=%lu, suseconds_t=%lu, currstate->t.tv_sec=%d\n", command_len, state_len, sizeof(struct timeval), sizeof(time_t), sizeof(suseconds_t), currstate->tv_sec);
-    printf("\n");
-#endif
+	r = parse_authenticator(authenticator, auth_len, sig_len, &appname, &appname_len, &host_st);
+	if (r != AUTH_OK)
+		return r;
 
-	free(m);
-	free(app_id);
-	if (memcmp(computed_mac, mac, MACLEN))
-		return FAIL_VERIFICATION_FAILED;
+	gettimeofday(&t_now, NULL);
+	r = check_time(&host_st, &t_now, maxTimeDifferenceMsec);
+	if (r != AUTH_OK)
+		return r;
+
+	appID((unsigned char *) appname, appname_len, appid);
+
+	// cheap rejection of replays, before doing any crypto
+	r = replay_table_check(table, appid, host_st.seq, 0);
+	if (r != AUTH_OK)
+		return r;
+
+	if (atype == AUTH_ASYMMETRIC)
+		r = verifyCommandSig(authenticator, auth_len, authenticatedname->buf,
+				prefix_len, NULL, pubkey, 0);
 	else
-		return AUTH_OK;
+		r = verifyCommandSymm(authenticator, auth_len, authenticatedname->buf,
+				prefix_len, fixtureKey, keylen, NULL, 0);
+	if (r != AUTH_OK)
+		return r;
+
+	// another thread might have accepted the same command in the meantime
+	return replay_table_check(table, appid, host_st.seq, 1);
 }
 
 /*
@@ -539,65 +796,3 @@ authenticateCommandSig(state * st, struct ccn_charbuf * commandname, unsigned ch
 	free(authenticatorwithmagic);
 	free(msg);
 }
-
-int
-verifyCommandSig(unsigned char * authenticator, unsigned int auth_len, unsigned char * command_name, unsigned int command_len, state * currstate, RSA * pubKey, unsigned long maxTimeDifferenceMsec)
-{
-	int state_len = sizeof(state);
-    int state_ret, appname_len;
-	state * st;
-    state host_st;
-    
-	unsigned char * appname;
-	unsigned char * signature;
-	unsigned char * msg;
-	unsigned char * state_s;
-	unsigned char md[SHA256_DIGEST_LENGTH];
-
-	appname_len = authenticator[0] * 256 + authenticator[1];
-	appname = authenticator + 2;
-	state_s = appname + appname_len;
-	signature = state_s + state_len;
-
-    assert (auth_len == (unsigned int)(2 + appname_len + state_len + RSA_size(pubKey)));
-
-	// Verify fresnhess of command
-	st = (state *) (state_s);
-    host_st.tv_sec = ntohl(st->tv_sec);
-    host_st.tv_usec = ntohl(st->tv_usec);
-    host_st.seq = ntohl(st->seq);
-    host_st.rsvd = ntohl(st->rsvd);
-	state_ret = verify_update_state_freshness(currstate, &host_st, maxTimeDifferenceMsec);
-	if ((state_ret != AUTH_OK) && (state_ret != INFO_STATE_NOT_VERIFIED))
-		return state_ret;
-	
-	// Verify RSA signature
-	msg = (unsigned char *) malloc(command_len + appname_len + state_len);
-	memcpy(msg, command_name, command_len);
-	memcpy(msg + command_len, appname, appname_len);
-	memcpy(msg + command_len + appname_len, state_s, state_len);
-
-
-	SHA256(msg, command_len + appname_len + state_len, md);
-
-#ifdef AUTHDEBUG
-	printf("\nFunction verifyCommandSig:\nappname       = ");
-	print_hex(appname, appname_len);
-	printf("\nauthenticator = ");
-	print_hex(authenticator, auth_len - RSA_size(pubKey));
-    printf("\nmsg           = ");
-    print_hex(msg, command_len + appname_len + state_len);
-	printf("\nmd            = ");
-	print_hex(md, SHA256_DIGEST_LENGTH);
-	printf("\n");
-#endif
-    
-	state_ret = RSA_verify(NID_sha256, md, SHA256_DIGEST_LENGTH, signature, RSA_size(pubKey), pubKey);
-
-	free(msg);
-
-	if (state_ret)
-		return AUTH_OK;
-	else
-		return FAIL_VERIFICATION_FAILED;
-}
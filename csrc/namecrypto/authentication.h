@@ -47,6 +47,9 @@ typedef struct state_st {
     u_int32_t rsvd;  // reserved 4 bytes
 } state;
 
+/* application's key and state, kept across many authenticateCommand calls */
+typedef struct signer_st signer;
+
 void state_init(state * st);
 char * retToString(int r);
 
@@ -54,7 +57,12 @@ unsigned char * appID(unsigned char * uniqueAppName, unsigned int uniqueAppName_
 unsigned char * appKey(unsigned char * k, unsigned int keylen, unsigned char * appid, unsigned char * appkey);
 
 // Symmetric
-void authenticateCommand(state * st, struct ccn_charbuf * commandname, unsigned char * appname, unsigned int appname_len, unsigned char * appkey);
+int authenticateCommand(state * st, struct ccn_charbuf * commandname, unsigned char * appname, unsigned int appname_len, unsigned char * appkey);
+
+// Symmetric, with the app key set up once
+signer * signer_create(unsigned char * appname, unsigned int appname_len, unsigned char * appkey);
+void signer_destroy(signer * s);
+int signerAuthenticateCommand(signer * s, struct ccn_charbuf * commandname);
 
 // Public key
 void authenticateCommandSig(state * st, struct ccn_charbuf * commandname, unsigned char * appname, unsigned int appname_len, RSA * app_signing_key);
@@ -62,4 +70,8 @@ void authenticateCommandSig(state * st, struct ccn_charbuf * commandname, unsign
 // Use with both symmetric and asymmetric
 int verifyCommand(struct ccn_charbuf * authenticatedname, unsigned char * fixtureKey, unsigned int keylen, RSA * pubkey, state * currstate, unsigned long int maxTimeDifferenceMsec);
 
+// Same, replay protection for many applications, see replay.h
+typedef struct replay_table_st replay_table;
+int verifyCommandTable(struct ccn_charbuf * authenticatedname, unsigned char * fixtureKey, unsigned int keylen, RSA * pubkey, replay_table * table, unsigned long int maxTimeDifferenceMsec);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,157 @@
+//
+//  keycache.c
+//  namecrypto
+//
+//  Copyright (c) 2026, Regents of the University of California
+//  BSD license, See the COPYING file for more information
+//
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include <openssl/x509.h>
+
+#include <ccn/ccn.h>
+#include <ccn/hashtb.h>
+
+#include "keycache.h"
+
+struct key_cache_entry {
+	RSA *rsa;
+};
+
+struct key_cache_st {
+	pthread_mutex_t lock;
+	struct hashtb *table;
+};
+
+static void
+finalize_entry(struct hashtb_enumerator *e)
+{
+	struct key_cache_entry *entry = e->data;
+
+	RSA_free(entry->rsa);
+}
+
+key_cache *
+key_cache_create(void)
+{
+	struct hashtb_param param = {0};
+	key_cache *cache;
+
+	if (!(cache = (key_cache *) calloc(1, sizeof(*cache))))
+		return NULL;
+
+	param.finalize = finalize_entry;
+	cache->table = hashtb_create(sizeof(struct key_cache_entry), &param);
+	if (!cache->table) {
+		free(cache);
+		return NULL;
+	}
+
+	if (pthread_mutex_init(&cache->lock, NULL)) {
+		hashtb_destroy(&cache->table);
+		free(cache);
+		return NULL;
+	}
+
+	return cache;
+}
+
+void
+key_cache_destroy(key_cache *cache)
+{
+	if (!cache)
+		return;
+
+	hashtb_destroy(&cache->table);
+	pthread_mutex_destroy(&cache->lock);
+	free(cache);
+}
+
+int
+key_cache_add(key_cache *cache, EVP_PKEY *key, unsigned char *keyid)
+{
+	struct hashtb_enumerator ee, *e = &ee;
+	struct key_cache_entry *entry;
+	unsigned char *der = NULL;
+	RSA *rsa;
+	int r, len;
+
+	len = i2d_PUBKEY(key, &der);
+	if (len < 0)
+		return -1;
+
+	SHA256(der, len, keyid);
+	OPENSSL_free(der);
+
+	if (!(rsa = EVP_PKEY_get1_RSA(key)))
+		return -1;
+
+	pthread_mutex_lock(&cache->lock);
+
+	hashtb_start(cache->table, e);
+	r = hashtb_seek(e, keyid, KEYIDLEN, 0);
+	if (r == HT_NEW_ENTRY) {
+		entry = e->data;
+		entry->rsa = rsa;
+		rsa = NULL;
+	}
+	hashtb_end(e);
+
+	pthread_mutex_unlock(&cache->lock);
+
+	// same key was already there
+	RSA_free(rsa);
+
+	return r < 0 ? -1 : 0;
+}
+
+int
+key_cache_remove(key_cache *cache, const unsigned char *keyid)
+{
+	struct hashtb_enumerator ee, *e = &ee;
+	int r;
+
+	pthread_mutex_lock(&cache->lock);
+
+	hashtb_start(cache->table, e);
+	r = hashtb_seek(e, keyid, KEYIDLEN, 0);
+	if (r >= 0)
+		hashtb_delete(e);
+	hashtb_end(e);
+
+	pthread_mutex_unlock(&cache->lock);
+
+	return r == HT_OLD_ENTRY ? 0 : -1;
+}
+
+RSA *
+key_cache_get(key_cache *cache, const unsigned char *keyid)
+{
+	struct key_cache_entry *entry;
+	RSA *rsa = NULL;
+
+	pthread_mutex_lock(&cache->lock);
+
+	entry = hashtb_lookup(cache->table, keyid, KEYIDLEN);
+	if (entry && RSA_up_ref(entry->rsa))
+		rsa = entry->rsa;
+
+	pthread_mutex_unlock(&cache->lock);
+
+	return rsa;
+}
+
+unsigned int
+key_cache_count(key_cache *cache)
+{
+	int n;
+
+	pthread_mutex_lock(&cache->lock);
+	n = hashtb_n(cache->table);
+	pthread_mutex_unlock(&cache->lock);
+
+	return n;
+}
@@ -0,0 +1,38 @@
+//
+//  keycache.h
+//  namecrypto
+//
+//  Copyright (c) 2026, Regents of the University of California
+//  BSD license, See the COPYING file for more information
+//
+
+#ifndef __ndn_keycache__
+#define __ndn_keycache__
+
+#include <openssl/evp.h>
+#include <openssl/rsa.h>
+#include <openssl/sha.h>
+
+// SHA256 of the DER encoded public key, same as publisher public key digest
+#define KEYIDLEN SHA256_DIGEST_LENGTH
+
+/*
+ * Public keys of applications converted to RSA once and looked up by key ID,
+ * so verification with a known key doesn't parse or convert anything.
+ * All functions are thread safe.
+ */
+typedef struct key_cache_st key_cache;
+
+key_cache * key_cache_create(void);
+void key_cache_destroy(key_cache * cache);
+
+// stores ID of the key in keyid (KEYIDLEN bytes), returns 0 or -1 on error
+int key_cache_add(key_cache * cache, EVP_PKEY * key, unsigned char * keyid);
+int key_cache_remove(key_cache * cache, const unsigned char * keyid);
+
+// new reference (release it with RSA_free()) or NULL if the key isn't known
+RSA * key_cache_get(key_cache * cache, const unsigned char * keyid);
+
+unsigned int key_cache_count(key_cache * cache);
+
+#endif
@@ -0,0 +1,238 @@
+//
+//  replay.c
+//  namecrypto
+//
+//  Copyright (c) 2026, Regents of the University of California
+//  BSD license, See the COPYING file for more information
+//
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+#include <pthread.h>
+
+#include <ccn/ccn.h>
+#include <ccn/hashtb.h>
+
+#include "replay.h"
+
+struct replay_entry {
+	unsigned char appid[APPIDLEN]; // to find the entry again when evicting
+	struct replay_entry *prev, *next; // LRU list, head is the most recent
+	u_int32_t top; // highest accepted sequence number
+	uint64_t bits[]; // bit i is set when top - i was accepted
+};
+
+struct replay_table_st {
+	pthread_mutex_t lock;
+	struct hashtb *table;
+	struct replay_entry *head, *tail;
+	unsigned int max_apps;
+	unsigned int words; // window in 64 bit words
+	unsigned long evictions;
+};
+
+replay_table *
+replay_table_create(unsigned int max_apps, unsigned int window)
+{
+	replay_table *t;
+
+	if (!max_apps || !window || window > REPLAY_MAX_WINDOW)
+		return NULL;
+
+	if (!(t = (replay_table *) calloc(1, sizeof(*t))))
+		return NULL;
+
+	t->max_apps = max_apps;
+	t->words = (window + 63) / 64;
+
+	t->table = hashtb_create(sizeof(struct replay_entry) + t->words * sizeof(uint64_t), NULL);
+	if (!t->table) {
+		free(t);
+		return NULL;
+	}
+
+	if (pthread_mutex_init(&t->lock, NULL)) {
+		hashtb_destroy(&t->table);
+		free(t);
+		return NULL;
+	}
+
+	return t;
+}
+
+void
+replay_table_destroy(replay_table *t)
+{
+	if (!t)
+		return;
+
+	hashtb_destroy(&t->table);
+	pthread_mutex_destroy(&t->lock);
+	free(t);
+}
+
+static void
+lru_unlink(replay_table *t, struct replay_entry *entry)
+{
+	if (entry->prev)
+		entry->prev->next = entry->next;
+	else
+		t->head = entry->next;
+
+	if (entry->next)
+		entry->next->prev = entry->prev;
+	else
+		t->tail = entry->prev;
+
+	entry->prev = entry->next = NULL;
+}
+
+static void
+lru_push(replay_table *t, struct replay_entry *entry)
+{
+	entry->prev = NULL;
+	entry->next = t->head;
+	if (t->head)
+		t->head->prev = entry;
+	t->head = entry;
+	if (!t->tail)
+		t->tail = entry;
+}
+
+static void
+evict_lru(replay_table *t)
+{
+	struct hashtb_enumerator ee, *e = &ee;
+	struct replay_entry *victim = t->tail;
+
+	assert(victim);
+	lru_unlink(t, victim);
+
+	hashtb_start(t->table, e);
+	if (hashtb_seek(e, victim->appid, APPIDLEN, 0) == HT_OLD_ENTRY)
+		hashtb_delete(e);
+	hashtb_end(e);
+
+	t->evictions++;
+}
+
+// moves bits n positions up, what falls off the window is lost
+static void
+window_shift(uint64_t *bits, unsigned int words, u_int32_t n)
+{
+	unsigned int q = n / 64, r = n % 64;
+	int i;
+
+	if (n >= words * 64) {
+		memset(bits, 0, words * sizeof(*bits));
+		return;
+	}
+
+	for (i = words - 1; i >= 0; i--) {
+		int src = i - (int) q;
+		uint64_t v = 0;
+
+		if (src >= 0)
+			v = bits[src] << r;
+		if (r && src > 0)
+			v |= bits[src - 1] >> (64 - r);
+
+		bits[i] = v;
+	}
+}
+
+static int
+entry_check(replay_table *t, struct replay_entry *entry, u_int32_t seq, int commit)
+{
+	u_int32_t age;
+
+	if (seq > entry->top) {
+		if (commit) {
+			window_shift(entry->bits, t->words, seq - entry->top);
+			entry->bits[0] |= 1;
+			entry->top = seq;
+		}
+		return AUTH_OK;
+	}
+
+	age = entry->top - seq;
+	if (age >= t->words * 64)
+		return FAIL_DUPLICATE_INTEREST; // too old to tell
+
+	if (entry->bits[age / 64] & ((uint64_t) 1 << (age % 64)))
+		return FAIL_DUPLICATE_INTEREST;
+
+	if (commit)
+		entry->bits[age / 64] |= (uint64_t) 1 << (age % 64);
+
+	return AUTH_OK;
+}
+
+int
+replay_table_check(replay_table *t, const unsigned char *appid, u_int32_t seq, int commit)
+{
+	struct hashtb_enumerator ee, *e = &ee;
+	struct replay_entry *entry;
+	int r;
+
+	pthread_mutex_lock(&t->lock);
+
+	entry = hashtb_lookup(t->table, appid, APPIDLEN);
+	if (entry) {
+		r = entry_check(t, entry, seq, commit);
+		if (commit && r == AUTH_OK) {
+			lru_unlink(t, entry);
+			lru_push(t, entry);
+		}
+		goto exit;
+	}
+
+	// sequence numbers start with 1, like with state_init()
+	r = seq > 0 ? AUTH_OK : FAIL_DUPLICATE_INTEREST;
+	if (!commit || r != AUTH_OK)
+		goto exit;
+
+	if ((unsigned int) hashtb_n(t->table) >= t->max_apps)
+		evict_lru(t);
+
+	hashtb_start(t->table, e);
+	if (hashtb_seek(e, appid, APPIDLEN, 0) == HT_NEW_ENTRY) {
+		entry = e->data;
+		memcpy(entry->appid, appid, APPIDLEN);
+		entry->top = seq;
+		entry->bits[0] = 1;
+		lru_push(t, entry);
+	} else
+		r = FAIL_NO_MEMORY;
+	hashtb_end(e);
+
+exit:
+	pthread_mutex_unlock(&t->lock);
+	return r;
+}
+
+unsigned int
+replay_table_count(replay_table *t)
+{
+	int n;
+
+	pthread_mutex_lock(&t->lock);
+	n = hashtb_n(t->table);
+	pthread_mutex_unlock(&t->lock);
+
+	return n;
+}
+
+unsigned long
+replay_table_evictions(replay_table *t)
+{
+	unsigned long n;
+
+	pthread_mutex_lock(&t->lock);
+	n = t->evictions;
+	pthread_mutex_unlock(&t->lock);
+
+	return n;
+}
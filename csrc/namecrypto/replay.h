@@ -0,0 +1,39 @@
+//
+//  replay.h
+//  namecrypto
+//
+//  Copyright (c) 2026, Regents of the University of California
+//  BSD license, See the COPYING file for more information
+//
+
+#ifndef __ndn_replay__
+#define __ndn_replay__
+
+#include <sys/types.h>
+
+#include "authentication.h"
+
+#define REPLAY_DEFAULT_WINDOW 128
+#define REPLAY_MAX_WINDOW 4096
+
+/*
+ * Sequence numbers accepted from many applications, keyed by app ID. Every
+ * application has a sliding window (a bitmap of the last window sequence
+ * numbers below the highest one seen), so commands arriving out of order are
+ * accepted once. Number of applications is bounded, the least recently used
+ * one is forgotten when the table is full (the command's time stamp check
+ * still applies to it then). All functions are thread safe.
+ *
+ * replay_table is declared in authentication.h
+ */
+
+replay_table * replay_table_create(unsigned int max_apps, unsigned int window);
+void replay_table_destroy(replay_table * table);
+
+// AUTH_OK or FAIL_DUPLICATE_INTEREST, with commit set seq is recorded as seen
+int replay_table_check(replay_table * table, const unsigned char * appid, u_int32_t seq, int commit);
+
+unsigned int replay_table_count(replay_table * table);
+unsigned long replay_table_evictions(replay_table * table);
+
+#endif
@@ -8,12 +8,23 @@
 #include "python_hdr.h"
 #include <ccn/ccn.h>
 #include <ccn/charbuf.h>
+#include <ccn/ccn_private.h>
+#include <ccn/schedule.h>
 #include <ccn/signing.h>
 
 #include <stdlib.h>
 
 #include "pyccn.h"
 #include "objects.h"
+#ifdef NAMECRYPTO
+#  include "namecrypto/authentication.h"
+#  include "namecrypto/keycache.h"
+#  include "namecrypto/replay.h"
+#endif
+#include "output.h"
+#include "pit.h"
+#include "queue.h"
+#include "stats.h"
 #include "util.h"
 
 /*
@@ -38,6 +49,9 @@ static struct type_to_name {
 	{SIGNING_PARAMS, "SigningParams_ccn_data"},
 #ifdef NAMECRYPTO
 	{NAMECRYPTO_STATE, "Namecrypto_state"},
+	{NAMECRYPTO_SIGNER, "Namecrypto_signer"},
+	{NAMECRYPTO_VERIFIER, "Namecrypto_verifier"},
+	{NAMECRYPTO_KEYCACHE, "Namecrypto_key_cache"},
 #endif
 	{0, NULL}
 };
@@ -92,14 +106,21 @@ pyccn_Capsule_Destructor(PyObject *capsule)
 	case CLOSURE:
 	{
 		PyObject *py_obj_closure;
-		struct ccn_closure *p = pointer;
+		struct pyccn_closure *p = pointer;
 
 		py_obj_closure = PyCapsule_GetContext(capsule);
 		assert(py_obj_closure);
 		Py_DECREF(py_obj_closure); /* No longer referencing Closure object */
 
 		/* If we store something else, than ourselves, it probably is a bug */
-		assert(capsule == p->data);
+		assert(capsule == p->closure.data);
+
+		if (p->retry) {
+			assert(!p->retry->ev);
+			ccn_charbuf_destroy(&p->retry->name);
+			ccn_charbuf_destroy(&p->retry->templ);
+			free(p->retry);
+		}
 
 		free(p);
 	}
@@ -111,9 +132,7 @@ pyccn_Capsule_Destructor(PyObject *capsule)
 
 		context = PyCapsule_GetContext(capsule);
 		if (context) {
-			if (context->pco)
-				free(context->pco);
-			ccn_indexbuf_destroy(&context->comps);
+			free(context->comps.buf);
 			free(context);
 		}
 		ccn_charbuf_destroy(&p);
@@ -121,9 +140,28 @@ pyccn_Capsule_Destructor(PyObject *capsule)
 		break;
 	case HANDLE:
 	{
+		struct handle_data *context;
 		struct ccn *p = pointer;
+
+		context = PyCapsule_GetContext(capsule);
+
+		/* cancels pending interest retries, ccn doesn't own the schedule */
+		if (context && context->schedule) {
+			ccn_set_schedule(p, NULL);
+			ccn_schedule_destroy(&context->schedule);
+		}
+
 		ccn_disconnect(p);
 		ccn_destroy(&p);
+
+		/* closures can use it until ccn is destroyed */
+		if (context) {
+			pit_destroy(&context->pit);
+			queue_destroy(&context->queue);
+			output_destroy(&context->output);
+			free(context->stats);
+			free(context);
+		}
 	}
 		break;
 	case INTEREST:
@@ -147,9 +185,22 @@ pyccn_Capsule_Destructor(PyObject *capsule)
 		ccn_pubkey_free(p);
 	}
 		break;
+	case NAME:
+	{
+		struct ccn_charbuf *p = pointer;
+		PyObject *py_owner;
+
+		/* see CCNObject_New_charbuf_view() */
+		py_owner = PyCapsule_GetContext(capsule);
+		if (py_owner) {
+			Py_DECREF(py_owner);
+			free(p);
+		} else
+			ccn_charbuf_destroy(&p);
+	}
+		break;
 	case EXCLUSION_FILTER:
 	case KEY_LOCATOR:
-	case NAME:
 	case SIGNATURE:
 	case SIGNED_INFO:
 	{
@@ -171,6 +222,15 @@ pyccn_Capsule_Destructor(PyObject *capsule)
 	case NAMECRYPTO_STATE:
 		free(pointer);
 		break;
+	case NAMECRYPTO_SIGNER:
+		signer_destroy(pointer);
+		break;
+	case NAMECRYPTO_VERIFIER:
+		replay_table_destroy(pointer);
+		break;
+	case NAMECRYPTO_KEYCACHE:
+		key_cache_destroy(pointer);
+		break;
 #endif
 	default:
 		debug("Got capsule: %s\n", PyCapsule_GetName(capsule));
@@ -204,6 +264,32 @@ CCNObject_New(enum _pyccn_capsules type, void *pointer)
 		}
 		break;
 	}
+	case HANDLE:
+	{
+		struct handle_data *context;
+
+		context = calloc(1, sizeof(*context));
+		JUMP_IF_NULL_MEM(context, error);
+
+		context->stats = calloc(1, sizeof(*context->stats));
+		context->output = output_create();
+		if (!context->stats || !context->output) {
+			output_destroy(&context->output);
+			free(context->stats);
+			free(context);
+			PyErr_NoMemory();
+			goto error;
+		}
+
+		r = PyCapsule_SetContext(capsule, context);
+		if (r < 0) {
+			output_destroy(&context->output);
+			free(context->stats);
+			free(context);
+			goto error;
+		}
+		break;
+	}
 	case INTEREST:
 	{
 		struct interest_data *context;
@@ -275,7 +361,7 @@ CCNObject_Get(enum _pyccn_capsules type, PyObject *capsule)
 PyObject *
 CCNObject_New_Closure(struct ccn_closure **closure)
 {
-	struct ccn_closure *p;
+	struct pyccn_closure *p;
 	PyObject *result;
 
 	p = calloc(1, sizeof(*p));
@@ -289,7 +375,7 @@ CCNObject_New_Closure(struct ccn_closure **closure)
 	}
 
 	if (closure)
-		*closure = p;
+		*closure = &p->closure;
 
 	return result;
 }
@@ -324,3 +410,45 @@ CCNObject_New_charbuf(enum _pyccn_capsules type,
 
 	return py_o;
 }
+
+/*
+ * Creates a read-only charbuf capsule pointing into memory owned by py_owner
+ * (i.e. a Name inside of an Interest), py_owner is kept alive as long as the
+ * returned capsule exists
+ */
+PyObject *
+CCNObject_New_charbuf_view(enum _pyccn_capsules type, PyObject *py_owner,
+		const unsigned char *buf, size_t length)
+{
+	struct ccn_charbuf *p;
+	PyObject *py_o;
+	int r;
+
+	assert(type == NAME);
+	assert(py_owner);
+
+	p = calloc(1, sizeof(*p));
+	if (!p)
+		return PyErr_NoMemory();
+
+	p->buf = (unsigned char *) buf;
+	p->length = length;
+	p->limit = length;
+
+	py_o = CCNObject_New(type, p);
+	if (!py_o) {
+		free(p);
+		return NULL;
+	}
+
+	r = PyCapsule_SetContext(py_o, py_owner);
+	if (r < 0) {
+		/* destructor would try to destroy buffer we don't own */
+		p->buf = NULL;
+		Py_DECREF(py_o);
+		return NULL;
+	}
+	Py_INCREF(py_owner);
+
+	return py_o;
+}
@@ -31,18 +31,60 @@ enum _pyccn_capsules {
 	SIGNING_PARAMS,
 #  ifdef NAMECRYPTO
 	NAMECRYPTO_STATE,
+	NAMECRYPTO_SIGNER,
+	NAMECRYPTO_VERIFIER,
+	NAMECRYPTO_KEYCACHE,
 #  endif
 };
 
+/*
+ * The parsed ContentObject and its component index live in the same
+ * allocation as the capsule's context, they're only valid once parsed is set
+ */
 struct content_object_data {
-	struct ccn_parsed_ContentObject *pco;
-	struct ccn_indexbuf *comps;
+	struct ccn_parsed_ContentObject pco;
+	struct ccn_indexbuf comps;
+	int parsed;
 };
 
 struct interest_data {
 	struct ccn_parsed_interest *pi;
 };
 
+struct handle_data {
+	struct pyccn_pit *pit; /* producer side interest aggregation, see pit.c */
+	struct ccn_schedule *schedule; /* created by us for interest retries */
+	struct pyccn_queue *queue; /* operations from other threads, queue.c */
+	struct pyccn_stats *stats; /* see stats.h */
+	struct pyccn_output *output; /* paced content objects, output.c */
+};
+
+/*
+ * Retransmission policy of an expressed interest, enforced in
+ * ccn_upcall_handler() so the application only sees the final outcome
+ */
+struct retry_state {
+	struct ccn *handle;
+	struct ccn_charbuf *name, *templ; /* what we re-express */
+	struct ccn_scheduled_event *ev; /* pending re-expression */
+	int retries, max_retries;
+	int backoff_ms, max_backoff_ms;
+	double jitter; /* fraction of the delay, 0 - 1 */
+	long long deadline_us; /* absolute, 0 if there's none */
+	int final_deferred; /* ccn sent FINAL while ev was pending */
+};
+
+/*
+ * What we pass to ccn as a closure, pointer to it is what's stored in the
+ * CLOSURE capsule
+ */
+struct pyccn_closure {
+	struct ccn_closure closure; /* needs to be first */
+	struct handle_data *handle_data;
+	int aggregate; /* use handle's PIT */
+	struct retry_state *retry; /* only set with a retransmission policy */
+};
+
 PyObject *CCNObject_New(enum _pyccn_capsules type, void *pointer);
 PyObject *CCNObject_Borrow(enum _pyccn_capsules type, void *pointer);
 int CCNObject_ReqType(enum _pyccn_capsules type, PyObject *capsule);
@@ -52,5 +94,7 @@ void *CCNObject_Get(enum _pyccn_capsules type, PyObject *capsule);
 PyObject *CCNObject_New_Closure(struct ccn_closure **closure);
 PyObject *CCNObject_New_charbuf(enum _pyccn_capsules type,
 		struct ccn_charbuf **p);
+PyObject *CCNObject_New_charbuf_view(enum _pyccn_capsules type,
+		PyObject *py_owner, const unsigned char *buf, size_t length);
 
 #endif	/* OBJECTS_H */
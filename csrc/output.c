@@ -0,0 +1,468 @@
+/*
+ * Copyright (c) 2026, Regents of the University of California
+ * BSD license, See the COPYING file for more information
+ */
+
+/*
+ * Per handle output queue, for pacing producers.
+ *
+ * libccn buffers whatever the socket doesn't take, but doesn't tell how much
+ * that is, so a producer faster than ccnd can only find out that something
+ * is pending. We count what was handed to ccn since its buffer was last
+ * empty; that's exact when it empties and an upper bound in between.
+ * ccn_put() still writes out what it can on every put, as before.
+ *
+ * Messages wait here only behind a message put_many() wrote to the socket
+ * partially. ccn can't write anything until its rest is out, so queue_run()
+ * doesn't call into ccn meanwhile and calls made outside of run() finish it
+ * first with output_sync(), which waits only up to the caller's timeout.
+ *
+ * Once more than the high watermark is pending the output is blocked, when
+ * it drains to the low watermark it's unblocked again and the writable
+ * callback is called from run(). The queue is only used by the thread that
+ * owns the handle, pending byte count and blocked state can be read from
+ * any thread.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "python_hdr.h"
+#include <ccn/ccn.h>
+#include <ccn/ccn_private.h>
+
+#include <assert.h>
+#include <errno.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "output.h"
+#include "trace.h"
+#include "util.h"
+
+struct output_msg {
+	struct output_msg *next;
+	size_t length;
+	size_t sent; /* written directly to the socket, see output_put_partial() */
+	unsigned char buf[];
+};
+
+struct pyccn_output {
+	struct output_msg *head, *tail;
+	size_t queued; /* bytes waiting here */
+	size_t in_ccn; /* handed to ccn since its buffer was empty (upper bound) */
+	size_t pending; /* queued + in_ccn, read from other threads */
+	size_t low, high; /* watermarks, high == 0 never blocks */
+	int blocked;
+	int notify; /* got unblocked, callback wasn't called yet */
+	PyObject *writable; /* accessed only with the GIL held */
+};
+
+static long long
+now_us(void)
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+
+	return tv.tv_sec * 1000000LL + tv.tv_usec;
+}
+
+struct pyccn_output *
+output_create(void)
+{
+	struct pyccn_output *out;
+
+	out = calloc(1, sizeof(*out));
+	if (!out)
+		return NULL;
+
+	out->low = OUTPUT_LOW_WATERMARK;
+	out->high = OUTPUT_HIGH_WATERMARK;
+
+	return out;
+}
+
+/* drops what wasn't sent, needs the GIL */
+void
+output_destroy(struct pyccn_output **out)
+{
+	struct output_msg *msg, *next;
+
+	if (!*out)
+		return;
+
+	for (msg = (*out)->head; msg; msg = next) {
+		next = msg->next;
+		free(msg);
+	}
+
+	Py_CLEAR((*out)->writable);
+	free(*out);
+	*out = NULL;
+}
+
+static void
+output_update(struct pyccn_output *out, struct ccn *h)
+{
+	size_t pending, low, high;
+
+	if (out->in_ccn && !ccn_output_is_pending(h))
+		out->in_ccn = 0;
+
+	pending = out->queued + out->in_ccn;
+	__atomic_store_n(&out->pending, pending, __ATOMIC_RELAXED);
+
+	low = __atomic_load_n(&out->low, __ATOMIC_RELAXED);
+	high = __atomic_load_n(&out->high, __ATOMIC_RELAXED);
+
+	if (!out->blocked && high && pending > high) {
+		__atomic_store_n(&out->blocked, 1, __ATOMIC_RELAXED);
+	} else if (out->blocked && (!high || pending <= low)) {
+		__atomic_store_n(&out->blocked, 0, __ATOMIC_RELAXED);
+		out->notify = 1;
+	}
+}
+
+static struct output_msg *
+output_append(struct pyccn_output *out, const unsigned char *buf,
+		size_t length, size_t sent)
+{
+	struct output_msg *msg;
+
+	msg = malloc(sizeof(*msg) + length);
+	if (!msg) {
+		errno = ENOMEM;
+		return NULL;
+	}
+	msg->next = NULL;
+	msg->length = length;
+	msg->sent = sent;
+	memcpy(msg->buf, buf, length);
+
+	if (out->tail)
+		out->tail->next = msg;
+	else
+		out->head = msg;
+	out->tail = msg;
+	out->queued += length - sent;
+
+	return msg;
+}
+
+static void
+output_pop(struct pyccn_output *out)
+{
+	struct output_msg *msg = out->head;
+
+	out->head = msg->next;
+	if (!out->head)
+		out->tail = NULL;
+	out->queued -= msg->length - msg->sent;
+	free(msg);
+}
+
+/*
+ * Writes the rest of a message put_many() left half written, waiting up to
+ * timeoutms (-1 forever) for the socket. 1 if there's still some left
+ * (timeoutms 0 only), 0 when it's done, -1 on error or when the time ran
+ * out (errno set, ETIMEDOUT)
+ */
+static int
+output_write_partial(struct pyccn_output *out, struct ccn *h, int timeoutms)
+{
+	struct output_msg *msg = out->head;
+	struct pollfd pfd;
+	long long deadline = 0, left;
+	ssize_t r;
+	int fd, wait;
+
+	if (!msg || !msg->sent)
+		return 0;
+
+	if (timeoutms > 0)
+		deadline = now_us() + timeoutms * 1000LL;
+
+	fd = ccn_get_connection_fd(h);
+	if (fd < 0) {
+		errno = ENOTCONN;
+		return -1;
+	}
+
+	while (msg->sent < msg->length) {
+		r = write(fd, msg->buf + msg->sent, msg->length - msg->sent);
+		if (r >= 0) {
+			msg->sent += r;
+			out->queued -= r;
+			continue;
+		}
+
+		if (errno == EINTR)
+			continue;
+		if (errno != EAGAIN && errno != EWOULDBLOCK)
+			return -1;
+		if (!timeoutms)
+			return 1;
+
+		wait = -1;
+		if (timeoutms > 0) {
+			left = (deadline - now_us() + 999) / 1000;
+			if (left <= 0) {
+				errno = ETIMEDOUT;
+				return -1;
+			}
+			wait = (int) left;
+		}
+
+		pfd.fd = fd;
+		pfd.events = POLLOUT;
+		if (poll(&pfd, 1, wait) < 0 && errno != EINTR)
+			return -1;
+	}
+
+	output_pop(out);
+
+	return 0;
+}
+
+/*
+ * Hands queued messages to ccn while its buffer is empty. With push, the
+ * first one is handed to it even if it isn't, ccn_put() then writes out
+ * what it can, which is how ccn's buffer drains outside of ccn_run().
+ */
+static int
+output_feed(struct pyccn_output *out, struct ccn *h, int push)
+{
+	struct output_msg *msg;
+	int pending, r;
+
+	r = output_write_partial(out, h, 0);
+	if (r)
+		return r < 0 ? r : 0;
+
+	while ((msg = out->head)) {
+		pending = ccn_output_is_pending(h);
+		if (pending && !push)
+			break;
+
+		r = ccn_put(h, msg->buf, msg->length);
+		if (r < 0) {
+			errno = ccn_geterror(h);
+			return r;
+		}
+
+		if (!pending)
+			out->in_ccn = 0;
+		out->in_ccn = r > 0 ? out->in_ccn + msg->length : 0;
+		output_pop(out);
+
+		if (pending)
+			push = 0;
+	}
+
+	return 0;
+}
+
+/*
+ * Same as ccn_put(), 0 when the message was written, 1 when it's buffered
+ * and -1 on error, with errno set
+ */
+int
+output_put(struct pyccn_output *out, struct ccn *h, const unsigned char *buf,
+		size_t length)
+{
+	int pending, r;
+
+	if (!out) {
+		r = ccn_put(h, buf, length);
+		if (r < 0)
+			errno = ccn_geterror(h);
+		return r;
+	}
+
+	/* keeps the order, what's queued goes first */
+	if (out->head) {
+		if (!output_append(out, buf, length, 0))
+			return -1;
+
+		r = output_feed(out, h, 1);
+		if (r < 0)
+			return r;
+
+		output_update(out, h);
+
+		return output_is_pending(out, h);
+	}
+
+	pending = ccn_output_is_pending(h);
+	r = ccn_put(h, buf, length);
+	if (r < 0) {
+		errno = ccn_geterror(h);
+		return r;
+	}
+
+	if (!pending)
+		out->in_ccn = 0;
+	out->in_ccn = r > 0 ? out->in_ccn + length : 0;
+
+	output_update(out, h);
+
+	return r;
+}
+
+/*
+ * Queues the rest of a message whose first sent bytes were written directly
+ * to ccn's socket, while nothing else was pending. Until it's finished
+ * nothing else can be written, see output_sync().
+ */
+int
+output_put_partial(struct pyccn_output *out, struct ccn *h,
+		const unsigned char *buf, size_t length, size_t sent)
+{
+	assert(out);
+	assert(!out->head);
+	assert(sent > 0 && sent < length);
+
+	if (!output_append(out, buf, length, sent))
+		return -1;
+
+	output_update(out, h);
+
+	return 0;
+}
+
+/* message is half written, ccn can't write anything until it's finished */
+int
+output_is_partial(struct pyccn_output *out)
+{
+	return out && out->head && out->head->sent;
+}
+
+/*
+ * Called before anything else writes to ccn outside of run(), blocks only to
+ * finish a half written message, for up to timeoutms (-1 forever). Also
+ * feeds ccn, so the output keeps moving when run() isn't called. Fails with
+ * ETIMEDOUT if the message couldn't be finished in time, nothing can be
+ * written to ccn then.
+ */
+int
+output_sync(struct pyccn_output *out, struct ccn *h, int timeoutms)
+{
+	int r;
+
+	if (!out)
+		return 0;
+
+	r = output_write_partial(out, h, timeoutms);
+	if (r > 0) {
+		errno = ETIMEDOUT;
+		r = -1;
+	}
+	if (r < 0)
+		return r;
+
+	r = output_feed(out, h, 0);
+	if (r < 0)
+		return r;
+
+	output_update(out, h);
+
+	return 0;
+}
+
+/*
+ * Passes queued messages to ccn as its buffer empties, calls the writable
+ * callback if the output got unblocked. Runs on the loop thread without the
+ * GIL, returns -1 if ccn failed (errno set).
+ */
+int
+output_flush(struct pyccn_output *out, struct ccn *h)
+{
+	PyGILState_STATE gstate;
+	PyObject *py_callable, *py_result;
+	int r;
+
+	if (!out)
+		return 0;
+
+	r = output_feed(out, h, 0);
+	if (r < 0)
+		return r;
+
+	output_update(out, h);
+
+	if (!out->notify)
+		return 0;
+	out->notify = 0;
+
+	gstate = PyGILState_Ensure();
+
+	py_callable = out->writable;
+	if (py_callable) {
+		/* it can replace itself */
+		Py_INCREF(py_callable);
+
+		TRACE_BEGIN("writable");
+		py_result = PyObject_CallObject(py_callable, NULL);
+		TRACE_END("writable");
+		if (py_result)
+			Py_DECREF(py_result);
+		else
+			PyErr_Print(); /* nobody to raise it to */
+
+		Py_DECREF(py_callable);
+	}
+
+	PyGILState_Release(gstate);
+
+	return 0;
+}
+
+int
+output_is_pending(struct pyccn_output *out, struct ccn *h)
+{
+	return (out && out->head) || ccn_output_is_pending(h);
+}
+
+/* can be called from any thread */
+size_t
+output_pending_bytes(struct pyccn_output *out)
+{
+	return out ? __atomic_load_n(&out->pending, __ATOMIC_RELAXED) : 0;
+}
+
+/* can be called from any thread */
+int
+output_is_blocked(struct pyccn_output *out)
+{
+	return out ? __atomic_load_n(&out->blocked, __ATOMIC_RELAXED) : 0;
+}
+
+/* new values take effect with the next put or flush */
+void
+output_set_watermarks(struct pyccn_output *out, size_t low, size_t high)
+{
+	assert(out);
+	assert(low <= high || !high);
+
+	__atomic_store_n(&out->low, low, __ATOMIC_RELAXED);
+	__atomic_store_n(&out->high, high, __ATOMIC_RELAXED);
+}
+
+/* needs the GIL, callable can be NULL */
+void
+output_set_writable_callback(struct pyccn_output *out, PyObject *callable)
+{
+	PyObject *old;
+
+	assert(out);
+
+	old = out->writable;
+	Py_XINCREF(callable);
+	out->writable = callable;
+	Py_XDECREF(old);
+}
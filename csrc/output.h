@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) 2026, Regents of the University of California
+ * BSD license, See the COPYING file for more information
+ */
+
+#ifndef OUTPUT_H
+#  define	OUTPUT_H
+
+/* defaults, can be changed with output_set_watermarks() */
+#  define OUTPUT_HIGH_WATERMARK (1024 * 1024)
+#  define OUTPUT_LOW_WATERMARK (256 * 1024)
+
+/* how long output_sync() waits for calls that have no timeout of their own */
+#  define OUTPUT_SYNC_TIMEOUT 4000
+
+struct pyccn_output;
+
+struct pyccn_output *output_create(void);
+void output_destroy(struct pyccn_output **out);
+int output_put(struct pyccn_output *out, struct ccn *h,
+		const unsigned char *buf, size_t length);
+int output_put_partial(struct pyccn_output *out, struct ccn *h,
+		const unsigned char *buf, size_t length, size_t sent);
+int output_is_partial(struct pyccn_output *out);
+int output_sync(struct pyccn_output *out, struct ccn *h, int timeoutms);
+int output_flush(struct pyccn_output *out, struct ccn *h);
+int output_is_pending(struct pyccn_output *out, struct ccn *h);
+size_t output_pending_bytes(struct pyccn_output *out);
+int output_is_blocked(struct pyccn_output *out);
+void output_set_watermarks(struct pyccn_output *out, size_t low,
+		size_t high);
+void output_set_writable_callback(struct pyccn_output *out,
+		PyObject *callable);
+
+#endif	/* OUTPUT_H */
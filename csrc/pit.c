@@ -0,0 +1,286 @@
+/*
+ * Copyright (c) 2026, Regents of the University of California
+ * BSD license, See the COPYING file for more information
+ */
+
+/*
+ * Producer side pending interest table.
+ *
+ * When the same (not yet produced) data is requested by many consumers, the
+ * producer gets one upcall for each interest. Filters registered with
+ * aggregation on store interests here, keyed by the interest with
+ * InterestLifetime and Nonce stripped (i.e. name + selectors), only the first
+ * one is passed to Python and the others are answered with the result it
+ * returned. ccnd delivers a single put to every face whose interest it
+ * satisfies, so putting the data once answers all of them; we just retire
+ * the matching entries. Entries also expire after the interest lifetime.
+ */
+
+#include <ccn/ccn.h>
+#include <ccn/hashtb.h>
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+#include "pit.h"
+
+/* how often we walk the table looking for expired entries (us) */
+#define PIT_SWEEP_INTERVAL 1000000LL
+
+/* as defined by ccnx spec */
+#define CCN_INTEREST_LIFETIME_DEFAULT (4 * 1000000LL)
+
+struct pit_entry {
+	struct ccn_parsed_interest pi; /* parsed key (interest without nonce) */
+	long long expiry; /* in us */
+	enum ccn_upcall_res result; /* returned by application on first upcall */
+	int count; /* number of aggregated interests */
+};
+
+struct pyccn_pit {
+	pthread_mutex_t lock;
+	struct hashtb *table;
+	struct ccn_charbuf *key; /* scratch buffer */
+	long long next_sweep;
+};
+
+static long long
+now_us(void)
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+
+	return tv.tv_sec * 1000000LL + tv.tv_usec;
+}
+
+static long long
+interest_lifetime_us(const unsigned char *interest,
+		const struct ccn_parsed_interest *pi)
+{
+	const unsigned char *blob;
+	size_t blob_size;
+	long long lifetime;
+	int r;
+
+	if (pi->offset[CCN_PI_E_InterestLifetime]
+			<= pi->offset[CCN_PI_B_InterestLifetime])
+		return CCN_INTEREST_LIFETIME_DEFAULT;
+
+	r = ccn_ref_tagged_BLOB(CCN_DTAG_InterestLifetime, interest,
+			pi->offset[CCN_PI_B_InterestLifetime],
+			pi->offset[CCN_PI_E_InterestLifetime], &blob, &blob_size);
+	if (r < 0 || blob_size > 6)
+		return CCN_INTEREST_LIFETIME_DEFAULT;
+
+	/* value is in 1/4096 of a second */
+	lifetime = 0;
+	for (size_t i = 0; i < blob_size; i++)
+		lifetime = lifetime * 256 + blob[i];
+
+	return lifetime * 1000000LL / 4096;
+}
+
+/* interest without InterestLifetime and Nonce (they're next to each other) */
+static int
+make_key(struct ccn_charbuf *key, const unsigned char *interest,
+		const struct ccn_parsed_interest *pi)
+{
+	int r;
+
+	key->length = 0;
+
+	r = ccn_charbuf_append(key, interest,
+			pi->offset[CCN_PI_B_InterestLifetime]);
+	if (r < 0)
+		return r;
+
+	return ccn_charbuf_append(key, interest + pi->offset[CCN_PI_E_Nonce],
+			pi->offset[CCN_PI_E] - pi->offset[CCN_PI_E_Nonce]);
+}
+
+/* needs to be called with lock held */
+static void
+pit_sweep(struct pyccn_pit *pit, long long now)
+{
+	struct hashtb_enumerator ee, *e = &ee;
+	struct pit_entry *entry;
+
+	for (hashtb_start(pit->table, e); e->data;) {
+		entry = e->data;
+		if (entry->expiry <= now)
+			hashtb_delete(e);
+		else
+			hashtb_next(e);
+	}
+	hashtb_end(e);
+
+	pit->next_sweep = now + PIT_SWEEP_INTERVAL;
+}
+
+struct pyccn_pit *
+pit_create(void)
+{
+	struct pyccn_pit *pit;
+
+	pit = calloc(1, sizeof(*pit));
+	if (!pit)
+		return NULL;
+
+	pit->table = hashtb_create(sizeof(struct pit_entry), NULL);
+	if (!pit->table)
+		goto error;
+
+	pit->key = ccn_charbuf_create();
+	if (!pit->key)
+		goto error;
+
+	if (pthread_mutex_init(&pit->lock, NULL))
+		goto error;
+
+	return pit;
+
+error:
+	hashtb_destroy(&pit->table);
+	ccn_charbuf_destroy(&pit->key);
+	free(pit);
+	return NULL;
+}
+
+void
+pit_destroy(struct pyccn_pit **pit)
+{
+	struct pyccn_pit *p = *pit;
+
+	if (!p)
+		return;
+
+	pthread_mutex_destroy(&p->lock);
+	hashtb_destroy(&p->table);
+	ccn_charbuf_destroy(&p->key);
+	free(p);
+
+	*pit = NULL;
+}
+
+/*
+ * Returns PIT_NEW if the interest should be passed to the application or
+ * PIT_AGGREGATED (with result set to what the application returned for the
+ * first interest) when the same request is already pending, -1 on error
+ */
+int
+pit_add(struct pyccn_pit *pit, const unsigned char *interest,
+		const struct ccn_parsed_interest *pi, enum ccn_upcall_res *result)
+{
+	struct hashtb_enumerator ee, *e = &ee;
+	struct pit_entry *entry;
+	long long now, expiry;
+	int r, ret = -1;
+
+	assert(pit);
+	assert(result);
+
+	now = now_us();
+	expiry = now + interest_lifetime_us(interest, pi);
+
+	pthread_mutex_lock(&pit->lock);
+
+	if (now >= pit->next_sweep)
+		pit_sweep(pit, now);
+
+	r = make_key(pit->key, interest, pi);
+	if (r < 0)
+		goto exit;
+
+	hashtb_start(pit->table, e);
+	r = hashtb_seek(e, pit->key->buf, pit->key->length, 0);
+	if (r < 0)
+		goto exit_enum;
+
+	entry = e->data;
+	if (r == HT_OLD_ENTRY && entry->expiry > now) {
+		entry->count++;
+		if (expiry > entry->expiry)
+			entry->expiry = expiry;
+		*result = entry->result;
+		ret = PIT_AGGREGATED;
+		goto exit_enum;
+	}
+
+	/* either brand new entry or a stale one we can reuse */
+	r = ccn_parse_interest(e->key, e->keysize, &entry->pi, NULL);
+	if (r < 0) {
+		hashtb_delete(e);
+		goto exit_enum;
+	}
+	entry->expiry = expiry;
+	entry->result = CCN_UPCALL_RESULT_OK;
+	entry->count = 1;
+	ret = PIT_NEW;
+
+exit_enum:
+	hashtb_end(e);
+exit:
+	pthread_mutex_unlock(&pit->lock);
+	return ret;
+}
+
+/* remembers what application returned, so we can reply the same way */
+void
+pit_set_result(struct pyccn_pit *pit, const unsigned char *interest,
+		const struct ccn_parsed_interest *pi, enum ccn_upcall_res result)
+{
+	struct pit_entry *entry;
+
+	pthread_mutex_lock(&pit->lock);
+
+	/* the entry is already gone if application put the data right away */
+	if (make_key(pit->key, interest, pi) >= 0) {
+		entry = hashtb_lookup(pit->table, pit->key->buf, pit->key->length);
+		if (entry)
+			entry->result = result;
+	}
+
+	pthread_mutex_unlock(&pit->lock);
+}
+
+/* retires all entries satisfied by the content object, returns their number */
+int
+pit_satisfy(struct pyccn_pit *pit, const unsigned char *content_object,
+		size_t size, struct ccn_parsed_ContentObject *pco)
+{
+	struct hashtb_enumerator ee, *e = &ee;
+	struct pit_entry *entry;
+	int satisfied = 0;
+
+	pthread_mutex_lock(&pit->lock);
+
+	for (hashtb_start(pit->table, e); e->data;) {
+		entry = e->data;
+		if (ccn_content_matches_interest(content_object, size, 1, pco,
+				e->key, e->keysize, &entry->pi)) {
+			satisfied += entry->count;
+			hashtb_delete(e);
+		} else
+			hashtb_next(e);
+	}
+	hashtb_end(e);
+
+	pthread_mutex_unlock(&pit->lock);
+
+	return satisfied;
+}
+
+int
+pit_size(struct pyccn_pit *pit)
+{
+	int n;
+
+	pthread_mutex_lock(&pit->lock);
+	n = hashtb_n(pit->table);
+	pthread_mutex_unlock(&pit->lock);
+
+	return n;
+}
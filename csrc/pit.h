@@ -0,0 +1,26 @@
+/*
+ * Copyright (c) 2026, Regents of the University of California
+ * BSD license, See the COPYING file for more information
+ */
+
+#ifndef PIT_H
+#  define	PIT_H
+
+enum pit_add_result {
+	PIT_NEW = 0,
+	PIT_AGGREGATED
+};
+
+struct pyccn_pit;
+
+struct pyccn_pit *pit_create(void);
+void pit_destroy(struct pyccn_pit **pit);
+int pit_add(struct pyccn_pit *pit, const unsigned char *interest,
+		const struct ccn_parsed_interest *pi, enum ccn_upcall_res *result);
+void pit_set_result(struct pyccn_pit *pit, const unsigned char *interest,
+		const struct ccn_parsed_interest *pi, enum ccn_upcall_res result);
+int pit_satisfy(struct pyccn_pit *pit, const unsigned char *content_object,
+		size_t size, struct ccn_parsed_ContentObject *pco);
+int pit_size(struct pyccn_pit *pit);
+
+#endif	/* PIT_H */
@@ -23,6 +23,7 @@
 #include "methods_name.h"
 #include "methods_signature.h"
 #include "methods_signedinfo.h"
+#include "trace.h"
 
 #ifdef NAMECRYPTO
 #    include "methods_namecrypto.h"
@@ -58,21 +59,46 @@ PyObject *g_PyExc_CCNContentObjectError;
 
 static PyMethodDef g_module_methods[] = {
 	{"create", _pyccn_cmd_create, METH_NOARGS, NULL},
-	{"connect", _pyccn_cmd_connect, METH_O, NULL},
+	{"connect", _pyccn_cmd_connect, METH_VARARGS, NULL},
 	{"disconnect", _pyccn_cmd_disconnect, METH_O, NULL},
 	{"get_connection_fd", _pyccn_get_connection_fd, METH_O, NULL},
 	{"process_scheduled_operations", _pyccn_cmd_process_scheduled_operations,
 		METH_O, NULL},
 	{"output_is_pending", _pyccn_cmd_output_is_pending, METH_O, NULL},
+	{"pending_output_bytes", _pyccn_cmd_pending_output_bytes, METH_O, NULL},
+	{"output_is_blocked", _pyccn_cmd_output_is_blocked, METH_O, NULL},
+	{"set_output_watermarks", _pyccn_cmd_set_output_watermarks, METH_VARARGS,
+		NULL},
+	{"set_writable_callback", _pyccn_cmd_set_writable_callback, METH_VARARGS,
+		NULL},
 	{"run", _pyccn_cmd_run, METH_VARARGS, NULL},
 	{"set_run_timeout", _pyccn_cmd_set_run_timeout, METH_VARARGS, NULL},
 	{"is_run_executing", _pyccn_cmd_is_run_executing, METH_O, NULL},
 	{"express_interest", _pyccn_cmd_express_interest, METH_VARARGS, NULL},
-	{"set_interest_filter", _pyccn_cmd_set_interest_filter, METH_VARARGS, NULL},
+	{"set_interest_filter", (PyCFunction) _pyccn_cmd_set_interest_filter,
+		METH_VARARGS | METH_KEYWORDS, NULL},
 	{"get", _pyccn_cmd_get, METH_VARARGS, NULL},
+	{"get_many", _pyccn_cmd_get_many, METH_VARARGS, NULL},
 	{"put", _pyccn_cmd_put, METH_VARARGS, NULL},
+	{"put_many", _pyccn_cmd_put_many, METH_VARARGS, NULL},
+	{"submit_express_interest", _pyccn_cmd_submit_express_interest,
+		METH_VARARGS, NULL},
+	{"submit_set_interest_filter",
+		(PyCFunction) _pyccn_cmd_submit_set_interest_filter,
+		METH_VARARGS | METH_KEYWORDS, NULL},
+	{"submit_put", _pyccn_cmd_submit_put, METH_VARARGS, NULL},
+	{"submit_call", _pyccn_cmd_submit_call, METH_VARARGS, NULL},
+	{"defer_verification", _pyccn_cmd_defer_verification, METH_VARARGS,
+		NULL},
+	{"get_stats", _pyccn_cmd_get_stats, METH_O, NULL},
+	{"trace_enable", _pyccn_cmd_trace_enable, METH_O, NULL},
+	{"trace_events", _pyccn_cmd_trace_events, METH_NOARGS, NULL},
+	{"trace_clear", _pyccn_cmd_trace_clear, METH_NOARGS, NULL},
+	{"trace_dropped", _pyccn_cmd_trace_dropped, METH_NOARGS, NULL},
+	{"reset_stats", _pyccn_cmd_reset_stats, METH_O, NULL},
 	{"get_default_key", _pyccn_cmd_get_default_key, METH_NOARGS, NULL},
 	{"generate_RSA_key", _pyccn_cmd_generate_RSA_key, METH_VARARGS, NULL},
+	{"generate_EC_key", _pyccn_cmd_generate_EC_key, METH_VARARGS, NULL},
 	{"PEM_read_key", (PyCFunction) _pyccn_cmd_PEM_read_key,
 		METH_VARARGS | METH_KEYWORDS, NULL},
 	{"PEM_write_key", (PyCFunction) _pyccn_cmd_PEM_write_key,
@@ -88,6 +114,8 @@ static PyMethodDef g_module_methods[] = {
 	{"content_to_bytes", _pyccn_cmd_content_to_bytes, METH_O, NULL},
 	{"verify_content", _pyccn_cmd_verify_content, METH_VARARGS, NULL},
 	{"verify_signature", _pyccn_cmd_verify_signature, METH_VARARGS, NULL},
+	{"verify_ContentObjects", _pyccn_cmd_verify_ContentObjects, METH_VARARGS,
+		NULL},
 #if 0
 	{"_pyccn_ccn_chk_signing_params", _pyccn_ccn_chk_signing_params, METH_VARARGS,
 		""},
@@ -110,14 +138,24 @@ static PyMethodDef g_module_methods[] = {
 	{"name_comps_from_ccn", _pyccn_cmd_name_comps_from_ccn, METH_O, NULL},
 	{"Interest_obj_to_ccn", _pyccn_cmd_Interest_obj_to_ccn, METH_O, NULL},
 	{"Interest_obj_from_ccn", _pyccn_cmd_Interest_obj_from_ccn, METH_O, NULL},
+	{"Interest_field_from_ccn", _pyccn_cmd_Interest_field_from_ccn,
+		METH_VARARGS, NULL},
 	{"encode_ContentObject", _pyccn_cmd_encode_ContentObject, METH_VARARGS,
 		NULL},
+	{"encode_ContentObjects_merkle", _pyccn_cmd_encode_ContentObjects_merkle,
+		METH_VARARGS, NULL},
 	{"ContentObject_obj_from_ccn", _pyccn_cmd_ContentObject_obj_from_ccn,
 		METH_O, NULL},
+	{"ContentObject_field_from_ccn", _pyccn_cmd_ContentObject_field_from_ccn,
+		METH_VARARGS, NULL},
 	{"digest_contentobject", _pyccn_cmd_digest_contentobject, METH_VARARGS,
 		NULL},
 	{"content_matches_interest", _pyccn_cmd_content_matches_interest,
 		METH_VARARGS, NULL},
+	{"content_matches_interests", _pyccn_cmd_content_matches_interests,
+		METH_VARARGS, NULL},
+	{"interests_matching_content", _pyccn_cmd_interests_matching_content,
+		METH_VARARGS, NULL},
 	{"Key_obj_from_ccn", _pyccn_cmd_Key_obj_from_ccn, METH_O, NULL},
 	{"KeyLocator_to_ccn", (PyCFunction) _pyccn_cmd_KeyLocator_to_ccn,
 		METH_VARARGS | METH_KEYWORDS, NULL},
@@ -151,6 +189,18 @@ static PyMethodDef g_module_methods[] = {
 		METH_VARARGS | METH_KEYWORDS, NULL},
 	{"nc_app_id", _pyccn_cmd_nc_app_id, METH_O, NULL},
 	{"nc_app_key", _pyccn_cmd_nc_app_key, METH_VARARGS, NULL},
+	{"nc_new_verifier", _pyccn_cmd_nc_new_verifier, METH_VARARGS, NULL},
+	{"nc_verifier_stats", _pyccn_cmd_nc_verifier_stats, METH_O, NULL},
+	{"nc_new_key_cache", _pyccn_cmd_nc_new_key_cache, METH_NOARGS, NULL},
+	{"nc_key_cache_add", _pyccn_cmd_nc_key_cache_add, METH_VARARGS, NULL},
+	{"nc_key_cache_remove", _pyccn_cmd_nc_key_cache_remove, METH_VARARGS,
+		NULL},
+	{"nc_key_cache_len", _pyccn_cmd_nc_key_cache_len, METH_O, NULL},
+	{"nc_signer_new", _pyccn_cmd_nc_signer_new, METH_VARARGS, NULL},
+	{"nc_signer_authenticate", _pyccn_cmd_nc_signer_authenticate,
+		METH_VARARGS, NULL},
+	{"nc_signer_authenticate_many", _pyccn_cmd_nc_signer_authenticate_many,
+		METH_VARARGS, NULL},
 #endif
 	{NULL, NULL, 0, NULL} /* Sentinel */
 };
@@ -0,0 +1,399 @@
+/*
+ * Copyright (c) 2026, Regents of the University of California
+ * BSD license, See the COPYING file for more information
+ */
+
+/*
+ * Per handle submission queue.
+ *
+ * ccn handles aren't thread safe, so while ccn_run() is executing other
+ * threads can't put or express interests on the same handle. Instead they
+ * push the operation on this queue (a lock-free stack, multiple producers
+ * and a single consumer) and wake the loop through an eventfd (or a pipe,
+ * where eventfd isn't available). queue_run() replaces ccn_run(): it polls
+ * both the ccn connection and the wakeup descriptor, and executes queued
+ * operations on the loop thread.
+ *
+ * QUEUE_CALL calls a Python function on the loop thread, that's how results
+ * computed by worker threads (e.g. content verified in the background) are
+ * handed to closures, which expect to be called from run().
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "python_hdr.h"
+#include <ccn/ccn.h>
+#include <ccn/ccn_private.h>
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <unistd.h>
+#ifdef HAVE_SYS_EVENTFD_H
+#  include <sys/eventfd.h>
+#endif
+
+#include "objects.h"
+#include "output.h"
+#include "pit.h"
+#include "queue.h"
+#include "stats.h"
+#include "trace.h"
+#include "util.h"
+
+struct pyccn_queue {
+	struct queue_item *head; /* newest first */
+	int signalled; /* wakeup is pending, no need to write again */
+	int run_timeout; /* timeout of current queue_run(), -1 forever */
+	int wake_fd[2]; /* both the same with eventfd */
+};
+
+static long long
+now_us(void)
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+
+	return tv.tv_sec * 1000000LL + tv.tv_usec;
+}
+
+struct pyccn_queue *
+queue_create(void)
+{
+	struct pyccn_queue *q;
+
+	q = calloc(1, sizeof(*q));
+	if (!q)
+		return NULL;
+
+	q->run_timeout = -1;
+
+#ifdef HAVE_SYS_EVENTFD_H
+	q->wake_fd[0] = q->wake_fd[1] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (q->wake_fd[0] < 0)
+		goto error;
+#else
+	int i;
+
+	if (pipe(q->wake_fd) < 0)
+		goto error;
+
+	for (i = 0; i < 2; i++)
+		if (fcntl(q->wake_fd[i], F_SETFL, O_NONBLOCK) < 0 ||
+				fcntl(q->wake_fd[i], F_SETFD, FD_CLOEXEC) < 0) {
+			int err = errno;
+
+			close(q->wake_fd[0]);
+			close(q->wake_fd[1]);
+			errno = err;
+			goto error;
+		}
+#endif
+
+	return q;
+
+error:
+	free(q);
+	return NULL;
+}
+
+/* needs the GIL, items can hold closures */
+void
+queue_destroy(struct pyccn_queue **q)
+{
+	struct queue_item *item, *next;
+
+	if (!*q)
+		return;
+
+	for (item = (*q)->head; item; item = next) {
+		next = item->next;
+		if (item->closure)
+			Py_DECREF((PyObject *) item->closure->data);
+		Py_XDECREF(item->callable);
+		Py_XDECREF(item->args);
+		queue_item_free(item);
+	}
+
+	close((*q)->wake_fd[0]);
+	if ((*q)->wake_fd[1] != (*q)->wake_fd[0])
+		close((*q)->wake_fd[1]);
+
+	free(*q);
+	*q = NULL;
+}
+
+struct queue_item *
+queue_item_new(enum queue_op op)
+{
+	struct queue_item *item;
+
+	item = calloc(1, sizeof(*item));
+	if (!item)
+		return NULL;
+
+	item->op = op;
+
+	return item;
+}
+
+void
+queue_item_free(struct queue_item *item)
+{
+	ccn_charbuf_destroy(&item->data);
+	ccn_charbuf_destroy(&item->templ);
+	free(item);
+}
+
+static void
+queue_wakeup(struct pyccn_queue *q)
+{
+#ifdef HAVE_SYS_EVENTFD_H
+	uint64_t one = 1;
+#else
+	char one = 1;
+#endif
+	ssize_t r;
+
+	if (__atomic_exchange_n(&q->signalled, 1, __ATOMIC_ACQ_REL))
+		return;
+
+	/* EAGAIN means the loop has plenty of wakeups pending already */
+	do
+		r = write(q->wake_fd[1], &one, sizeof(one));
+	while (r < 0 && errno == EINTR);
+}
+
+static void
+queue_clear_wakeup(struct pyccn_queue *q)
+{
+	char buf[64];
+	ssize_t r;
+
+	do
+		r = read(q->wake_fd[0], buf, sizeof(buf));
+	while (r > 0 || (r < 0 && errno == EINTR));
+}
+
+/* can be called from any thread */
+void
+queue_push(struct pyccn_queue *q, struct queue_item *item)
+{
+	struct queue_item *head;
+
+	head = __atomic_load_n(&q->head, __ATOMIC_RELAXED);
+	do
+		item->next = head;
+	while (!__atomic_compare_exchange_n(&q->head, &head, item, 1,
+			__ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+	queue_wakeup(q);
+}
+
+/* returns previous timeout, can be called from any thread */
+int
+queue_set_run_timeout(struct pyccn_queue *q, int timeoutms)
+{
+	int old;
+
+	old = __atomic_exchange_n(&q->run_timeout, timeoutms, __ATOMIC_ACQ_REL);
+	queue_wakeup(q);
+
+	return old;
+}
+
+/* calls the Python function, releases the item's references to it */
+static int
+queue_call(struct queue_item *item)
+{
+	PyGILState_STATE gstate;
+	PyObject *py_result;
+
+	gstate = PyGILState_Ensure();
+
+	TRACE_BEGIN("queued_call");
+	py_result = PyObject_CallObject(item->callable, item->args);
+	TRACE_END("queued_call");
+	if (py_result)
+		Py_DECREF(py_result);
+	else
+		PyErr_Print(); /* nobody to raise it to */
+
+	Py_CLEAR(item->callable);
+	Py_CLEAR(item->args);
+
+	PyGILState_Release(gstate);
+
+	return py_result ? 0 : -1;
+}
+
+static int
+queue_execute(struct ccn *h, struct handle_data *handle_data,
+		struct queue_item *item)
+{
+	int r = -1;
+
+	switch (item->op) {
+	case QUEUE_PUT:
+		TRACE_BEGIN("put");
+		r = output_put(handle_data->output, h, item->data->buf,
+				item->data->length);
+		TRACE_END("put");
+		if (r < 0)
+			break;
+		stats_inc(handle_data->stats, puts);
+		stats_add(handle_data->stats, put_bytes, item->data->length);
+		if (handle_data->pit)
+			pit_satisfy(handle_data->pit, item->data->buf, item->data->length,
+					&item->pco);
+		break;
+	case QUEUE_EXPRESS_INTEREST:
+		r = ccn_express_interest(h, item->data, item->closure, item->templ);
+		if (r >= 0)
+			stats_inc(handle_data->stats, interests_expressed);
+		break;
+	case QUEUE_SET_INTEREST_FILTER:
+		r = ccn_set_interest_filter_with_flags(h, item->data, item->closure,
+				item->forw_flags);
+		break;
+	case QUEUE_CALL:
+		r = queue_call(item);
+		break;
+	}
+
+	return r;
+}
+
+/* runs on the loop thread, without the GIL */
+static void
+queue_drain(struct pyccn_queue *q, struct ccn *h,
+		struct handle_data *handle_data)
+{
+	struct queue_item *item, *next, *list = NULL;
+	PyGILState_STATE gstate;
+	int r;
+
+	__atomic_store_n(&q->signalled, 0, __ATOMIC_RELEASE);
+	item = __atomic_exchange_n(&q->head, NULL, __ATOMIC_ACQUIRE);
+
+	/* restore submission order */
+	for (; item; item = next) {
+		next = item->next;
+		item->next = list;
+		list = item;
+	}
+
+	for (item = list; item; item = next) {
+		next = item->next;
+
+		r = queue_execute(h, handle_data, item);
+		debug("queue: executed op %d: %d\n", item->op, r);
+
+		/* ccn didn't take the closure, so it won't ever send FINAL */
+		if (r < 0 && item->closure) {
+			gstate = PyGILState_Ensure();
+			Py_DECREF((PyObject *) item->closure->data);
+			PyGILState_Release(gstate);
+		}
+
+		queue_item_free(item);
+	}
+}
+
+/*
+ * Equivalent of ccn_run(), that also executes operations submitted from other
+ * threads. Timeout can be changed with queue_set_run_timeout().
+ */
+int
+queue_run(struct ccn *h, struct handle_data *handle_data, int timeoutms)
+{
+	struct pyccn_queue *q = handle_data->queue;
+	struct pollfd fds[2];
+	long long start, elapsed;
+	int timeout, wait, partial, r;
+
+	assert(q);
+
+	__atomic_store_n(&q->run_timeout, timeoutms, __ATOMIC_RELEASE);
+	start = now_us();
+
+	for (;;) {
+		/* feeds ccn what it sent meanwhile, might call writable callback */
+		r = output_flush(handle_data->output, h);
+		if (r < 0)
+			return r;
+
+		/* nothing can go to ccn while a message is half written */
+		partial = output_is_partial(handle_data->output);
+		if (!partial) {
+			queue_drain(q, h, handle_data);
+
+			/* returns us until the next scheduled event */
+			wait = ccn_process_scheduled_operations(h);
+			wait = wait < 0 ? -1 : (wait + 999) / 1000;
+		} else
+			wait = -1;
+
+		timeout = __atomic_load_n(&q->run_timeout, __ATOMIC_ACQUIRE);
+		elapsed = (now_us() - start) / 1000;
+		if (timeout >= 0) {
+			long long left = timeout > elapsed ? timeout - elapsed : 0;
+
+			if (wait < 0 || wait > left)
+				wait = (int) left;
+		}
+
+		fds[0].fd = ccn_get_connection_fd(h);
+		if (fds[0].fd < 0)
+			return -1;
+		fds[0].events = partial ? 0 : POLLIN;
+		if (output_is_pending(handle_data->output, h))
+			fds[0].events |= POLLOUT;
+		fds[1].fd = q->wake_fd[0];
+		fds[1].events = POLLIN;
+		fds[0].revents = fds[1].revents = 0;
+
+		r = poll(fds, 2, wait);
+		if (r < 0 && errno != EINTR)
+			return -1;
+
+		if (fds[1].revents)
+			queue_clear_wakeup(q);
+
+		if (fds[0].revents && !partial) {
+			TRACE_BEGIN("ccn_run");
+			r = ccn_run(h, 0);
+			TRACE_END("ccn_run");
+			if (r < 0)
+				return r;
+		}
+
+		timeout = __atomic_load_n(&q->run_timeout, __ATOMIC_ACQUIRE);
+		elapsed = (now_us() - start) / 1000;
+		if (timeout >= 0 && elapsed >= timeout)
+			break;
+	}
+
+	/*
+	 * don't leave anything behind that was submitted before we're done,
+	 * unless ccnd doesn't take a half written message, then it's executed
+	 * by the next run() (the time is up already)
+	 */
+	r = output_sync(handle_data->output, h, 0);
+	if (r < 0 && errno != ETIMEDOUT)
+		return r;
+	if (r == 0)
+		queue_drain(q, h, handle_data);
+	r = output_flush(handle_data->output, h);
+	if (r < 0)
+		return r;
+
+	return 0;
+}
@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) 2026, Regents of the University of California
+ * BSD license, See the COPYING file for more information
+ */
+
+#ifndef QUEUE_H
+#  define	QUEUE_H
+
+enum queue_op {
+	QUEUE_PUT,
+	QUEUE_EXPRESS_INTEREST,
+	QUEUE_SET_INTEREST_FILTER,
+	QUEUE_CALL
+};
+
+/* operation submitted by another thread, all buffers are owned by the item */
+struct queue_item {
+	struct queue_item *next;
+	enum queue_op op;
+	struct ccn_charbuf *data; /* ContentObject to put or the Name */
+	struct ccn_charbuf *templ; /* interest template (can be NULL) */
+	struct ccn_closure *closure; /* holds a reference to its capsule */
+	int forw_flags;
+	struct ccn_parsed_ContentObject pco;
+	PyObject *callable, *args; /* QUEUE_CALL, references held */
+};
+
+struct handle_data;
+struct pyccn_queue;
+
+struct pyccn_queue *queue_create(void);
+void queue_destroy(struct pyccn_queue **q);
+struct queue_item *queue_item_new(enum queue_op op);
+void queue_item_free(struct queue_item *item);
+void queue_push(struct pyccn_queue *q, struct queue_item *item);
+int queue_set_run_timeout(struct pyccn_queue *q, int timeoutms);
+int queue_run(struct ccn *h, struct handle_data *handle_data, int timeoutms);
+
+#endif	/* QUEUE_H */
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2026, Regents of the University of California
+ * BSD license, See the COPYING file for more information
+ */
+
+#include <ccn/ccn.h>
+
+#include <stddef.h>
+
+#include "stats.h"
+
+#define STATS_FIELDS (sizeof(struct pyccn_stats) / sizeof(unsigned long long))
+
+void
+stats_upcall(struct pyccn_stats *stats, enum ccn_upcall_kind kind)
+{
+	if (!stats || kind < 0 || kind >= STATS_UPCALL_KINDS)
+		return;
+
+	stats_inc(stats, upcall_kinds[kind]);
+	if (kind == CCN_UPCALL_INTEREST_TIMED_OUT)
+		stats_inc(stats, timeouts);
+}
+
+void
+stats_upcall_latency(struct pyccn_stats *stats, long long us)
+{
+	int bucket;
+
+	if (!stats)
+		return;
+
+	if (us < 0)
+		us = 0;
+
+	for (bucket = 0; bucket < STATS_LATENCY_BUCKETS - 1; bucket++)
+		if (us < (1LL << bucket))
+			break;
+
+	stats_inc(stats, upcalls);
+	stats_add(stats, upcall_latency_sum, (unsigned long long) us);
+	stats_inc(stats, upcall_latency[bucket]);
+}
+
+/*
+ * The struct is just an array of counters, copy them one by one; the
+ * snapshot isn't atomic as a whole, but each counter is
+ */
+void
+stats_snapshot(struct pyccn_stats *stats, struct pyccn_stats *snapshot)
+{
+	unsigned long long *src = (unsigned long long *) stats;
+	unsigned long long *dst = (unsigned long long *) snapshot;
+	size_t i;
+
+	for (i = 0; i < STATS_FIELDS; i++)
+		dst[i] = __atomic_load_n(&src[i], __ATOMIC_RELAXED);
+}
+
+void
+stats_reset(struct pyccn_stats *stats)
+{
+	unsigned long long *p = (unsigned long long *) stats;
+	size_t i;
+
+	for (i = 0; i < STATS_FIELDS; i++)
+		__atomic_store_n(&p[i], 0, __ATOMIC_RELAXED);
+}
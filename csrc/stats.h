@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2026, Regents of the University of California
+ * BSD license, See the COPYING file for more information
+ */
+
+#ifndef STATS_H
+#  define	STATS_H
+
+/*
+ * Upcall latency histogram, bucket i counts calls that took less than 2^i us,
+ * the last one everything slower (2^22 us is about 4 s)
+ */
+#  define STATS_LATENCY_BUCKETS 24
+
+/* last upcall kind ccn defines is CCN_UPCALL_CONTENT_BAD */
+#  define STATS_UPCALL_KINDS 7
+
+/* per handle counters, updated with relaxed atomics from any thread */
+struct pyccn_stats {
+	unsigned long long interests_expressed;
+	unsigned long long reexpressed;
+	unsigned long long timeouts;
+	unsigned long long puts;
+	unsigned long long put_bytes;
+	unsigned long long upcall_kinds[STATS_UPCALL_KINDS]; /* received from ccn */
+	unsigned long long upcalls; /* passed to Python */
+	unsigned long long upcall_latency_sum; /* us */
+	unsigned long long upcall_latency[STATS_LATENCY_BUCKETS];
+};
+
+#  define stats_add(stats, field, n) \
+do { \
+	if (stats) \
+		__atomic_fetch_add(&(stats)->field, (n), __ATOMIC_RELAXED); \
+} while (0)
+
+#  define stats_inc(stats, field) stats_add(stats, field, 1)
+
+void stats_upcall(struct pyccn_stats *stats, enum ccn_upcall_kind kind);
+void stats_upcall_latency(struct pyccn_stats *stats, long long us);
+void stats_snapshot(struct pyccn_stats *stats, struct pyccn_stats *snapshot);
+void stats_reset(struct pyccn_stats *stats);
+
+#endif	/* STATS_H */
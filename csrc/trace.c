@@ -0,0 +1,283 @@
+/*
+ * Copyright (c) 2026, Regents of the University of California
+ * BSD license, See the COPYING file for more information
+ */
+
+/*
+ * Event tracing.
+ *
+ * Begin/end events from the hot paths are stored in a ring buffer owned by
+ * the thread that emitted them, so writers never contend. A thread gets a
+ * ring on its first event and gives it back when it exits, its events stay
+ * there. A ring given back is reused by the next thread that starts tracing
+ * once its events were read (or cleared); until then new threads get new
+ * rings, up to TRACE_MAX_RINGS. Past that the given back ring with the
+ * fewest unread events is reused and they're counted as dropped.
+ *
+ * Old events are overwritten when a ring fills up. Reading them while other
+ * threads keep tracing can return an event that is being overwritten, which
+ * is fine for diagnostics.
+ */
+
+#define PY_SSIZE_T_CLEAN 1
+#include "python_hdr.h"
+#include <ccn/ccn.h>
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+#include "trace.h"
+#include "util.h"
+
+/* events per thread */
+#define TRACE_RING_SIZE 16384
+
+/* rings kept for exited threads' unread events, about 400 KiB each */
+#define TRACE_MAX_RINGS 32
+
+struct trace_record {
+	const char *name;
+	long long ts; /* us */
+	char phase;
+};
+
+struct trace_ring {
+	struct trace_ring *next;
+	int tid;
+	int in_use; /* owned by a thread, protected by g_rings_lock */
+	unsigned long long head; /* total number of events written */
+	unsigned long long tail; /* events before it were cleared */
+	unsigned long long read; /* events before it were returned */
+	struct trace_record records[TRACE_RING_SIZE];
+};
+
+int g_trace_enabled;
+
+static __thread struct trace_ring *t_ring;
+static struct trace_ring *g_rings;
+static int g_nrings;
+static unsigned long long g_dropped; /* unread events of reused rings */
+static pthread_mutex_t g_rings_lock = PTHREAD_MUTEX_INITIALIZER;
+static int g_next_tid;
+static pthread_key_t g_ring_key; /* gives the ring back on thread exit */
+static pthread_once_t g_ring_key_once = PTHREAD_ONCE_INIT;
+static int g_ring_key_ok;
+
+static long long
+now_us(void)
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+
+	return tv.tv_sec * 1000000LL + tv.tv_usec;
+}
+
+static void
+ring_release(void *p)
+{
+	struct trace_ring *ring = p;
+
+	pthread_mutex_lock(&g_rings_lock);
+	ring->in_use = 0;
+	pthread_mutex_unlock(&g_rings_lock);
+}
+
+static void
+ring_key_create(void)
+{
+	g_ring_key_ok = !pthread_key_create(&g_ring_key, ring_release);
+}
+
+/* first event that wasn't cleared or overwritten */
+static unsigned long long
+ring_first(struct trace_ring *ring, unsigned long long head)
+{
+	unsigned long long first;
+
+	first = head > TRACE_RING_SIZE ? head - TRACE_RING_SIZE : 0;
+	if (first < ring->tail)
+		first = ring->tail;
+
+	return first;
+}
+
+/* events of a ring given back that weren't read, needs g_rings_lock */
+static unsigned long long
+ring_unread(struct trace_ring *ring)
+{
+	unsigned long long first;
+
+	first = ring_first(ring, ring->head);
+	if (first < ring->read)
+		first = ring->read;
+
+	return ring->head - first;
+}
+
+/* a ring some exited thread gave back, preferably one that was read */
+static struct trace_ring *
+ring_acquire(void)
+{
+	struct trace_ring *ring, *p;
+	unsigned long long unread = 0, n;
+
+	pthread_once(&g_ring_key_once, ring_key_create);
+	if (!g_ring_key_ok)
+		return NULL;
+
+	pthread_mutex_lock(&g_rings_lock);
+	ring = NULL;
+	for (p = g_rings; p; p = p->next) {
+		if (p->in_use)
+			continue;
+
+		n = ring_unread(p);
+		if (!ring || n < unread) {
+			ring = p;
+			unread = n;
+		}
+		if (!n)
+			break;
+	}
+
+	/* keeps unread events while there's room for another ring */
+	if (ring && unread && g_nrings < TRACE_MAX_RINGS)
+		ring = NULL;
+
+	if (ring) {
+		g_dropped += unread;
+		ring->tail = ring->read = ring->head;
+	} else {
+		ring = calloc(1, sizeof(*ring));
+		if (!ring) {
+			pthread_mutex_unlock(&g_rings_lock);
+			return NULL;
+		}
+		ring->next = g_rings;
+		g_rings = ring;
+		g_nrings++;
+	}
+	ring->tid = ++g_next_tid;
+	ring->in_use = 1;
+	pthread_mutex_unlock(&g_rings_lock);
+
+	if (pthread_setspecific(g_ring_key, ring)) {
+		ring_release(ring);
+		return NULL;
+	}
+
+	return ring;
+}
+
+void
+trace_event(const char *name, char phase)
+{
+	struct trace_ring *ring = t_ring;
+	struct trace_record *record;
+	unsigned long long head;
+
+	if (!ring) {
+		ring = t_ring = ring_acquire();
+		if (!ring)
+			return;
+	}
+
+	head = ring->head;
+	record = &ring->records[head % TRACE_RING_SIZE];
+	record->name = name;
+	record->ts = now_us();
+	record->phase = phase;
+
+	__atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+}
+
+PyObject *
+_pyccn_cmd_trace_enable(PyObject *UNUSED(self), PyObject *py_enable)
+{
+	int enable;
+
+	enable = PyObject_IsTrue(py_enable);
+	if (enable < 0)
+		return NULL;
+
+	__atomic_store_n(&g_trace_enabled, enable, __ATOMIC_RELAXED);
+
+	Py_RETURN_NONE;
+}
+
+/*
+ * Returns recorded events as a list of (name, phase, timestamp in us,
+ * thread id) tuples, ordered by thread and time
+ */
+PyObject *
+_pyccn_cmd_trace_events(PyObject *UNUSED(self), PyObject *UNUSED(args))
+{
+	PyObject *py_list, *py_o;
+	struct trace_ring *ring;
+	struct trace_record record;
+	unsigned long long i, head, first;
+	int r;
+
+	py_list = PyList_New(0);
+	if (!py_list)
+		return NULL;
+
+	pthread_mutex_lock(&g_rings_lock);
+	for (ring = g_rings; ring; ring = ring->next) {
+		head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+		first = ring_first(ring, head);
+
+		for (i = first; i < head; i++) {
+			record = ring->records[i % TRACE_RING_SIZE];
+
+			py_o = Py_BuildValue("(ss#Li)", record.name, &record.phase,
+					(Py_ssize_t) 1, record.ts, ring->tid);
+			if (!py_o)
+				goto error;
+
+			r = PyList_Append(py_list, py_o);
+			Py_DECREF(py_o);
+			if (r < 0)
+				goto error;
+		}
+
+		/* it can be reused once its thread exits */
+		ring->read = head;
+	}
+	pthread_mutex_unlock(&g_rings_lock);
+
+	return py_list;
+
+error:
+	pthread_mutex_unlock(&g_rings_lock);
+	Py_DECREF(py_list);
+	return NULL;
+}
+
+PyObject *
+_pyccn_cmd_trace_clear(PyObject *UNUSED(self), PyObject *UNUSED(args))
+{
+	struct trace_ring *ring;
+
+	pthread_mutex_lock(&g_rings_lock);
+	for (ring = g_rings; ring; ring = ring->next)
+		ring->tail = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+	pthread_mutex_unlock(&g_rings_lock);
+
+	Py_RETURN_NONE;
+}
+
+/* number of events of exited threads that were dropped before being read */
+PyObject *
+_pyccn_cmd_trace_dropped(PyObject *UNUSED(self), PyObject *UNUSED(args))
+{
+	unsigned long long dropped;
+
+	pthread_mutex_lock(&g_rings_lock);
+	dropped = g_dropped;
+	pthread_mutex_unlock(&g_rings_lock);
+
+	return PyLong_FromUnsignedLongLong(dropped);
+}
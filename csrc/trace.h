@@ -0,0 +1,32 @@
+/*
+ * Copyright (c) 2026, Regents of the University of California
+ * BSD license, See the COPYING file for more information
+ */
+
+#ifndef TRACE_H
+#  define	TRACE_H
+
+extern int g_trace_enabled;
+
+void trace_event(const char *name, char phase);
+
+/*
+ * name needs to be a string literal (only the pointer is stored); when
+ * tracing is off all it costs is a load and a (predicted) branch
+ */
+#  define TRACE_EVENT(name, phase) \
+do { \
+	if (__builtin_expect(__atomic_load_n(&g_trace_enabled, \
+			__ATOMIC_RELAXED), 0)) \
+		trace_event(name, phase); \
+} while (0)
+
+#  define TRACE_BEGIN(name) TRACE_EVENT(name, 'B')
+#  define TRACE_END(name) TRACE_EVENT(name, 'E')
+
+PyObject *_pyccn_cmd_trace_enable(PyObject *self, PyObject *py_enable);
+PyObject *_pyccn_cmd_trace_events(PyObject *self, PyObject *args);
+PyObject *_pyccn_cmd_trace_clear(PyObject *self, PyObject *args);
+PyObject *_pyccn_cmd_trace_dropped(PyObject *self, PyObject *args);
+
+#endif	/* TRACE_H */
@@ -14,6 +14,7 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "pyccn.h"
 #include "util.h"
@@ -85,6 +86,49 @@ _pyccn_unicode_to_utf8(PyObject *string, char **buffer, Py_ssize_t *length)
 	return py_utf8;
 }
 
+/*
+ * Content can be any object exporting a contiguous buffer (bytes, bytearray,
+ * memoryview, mmap, array, numpy arrays...), it's read in place. None is
+ * empty content. The view needs to be released with PyBuffer_Release().
+ */
+int
+_pyccn_content_get_buffer(PyObject *py_content, Py_buffer *view)
+{
+	if (py_content == Py_None) {
+		memset(view, 0, sizeof(*view));
+		return 0;
+	}
+
+	/* has no single encoding, Python code converts it to UTF-8 */
+	if (PyUnicode_Check(py_content)) {
+		PyErr_SetString(PyExc_TypeError, "content needs to be encoded");
+		return -1;
+	}
+
+#if PY_MAJOR_VERSION < 3
+	/* objects that only have the old buffer interface */
+	if (!PyObject_CheckBuffer(py_content)) {
+		const void *buf;
+		Py_ssize_t len;
+
+		if (PyObject_AsReadBuffer(py_content, &buf, &len) < 0)
+			return -1;
+
+		return PyBuffer_FillInfo(view, py_content, (void *) buf, len, 1,
+				PyBUF_SIMPLE);
+	}
+#endif
+
+	if (!PyObject_CheckBuffer(py_content)) {
+		PyErr_Format(PyExc_TypeError, "content needs to be bytes or support"
+				" the buffer protocol, not %.200s",
+				Py_TYPE(py_content)->tp_name);
+		return -1;
+	}
+
+	return PyObject_GetBuffer(py_content, view, PyBUF_SIMPLE);
+}
+
 FILE *
 _pyccn_open_file_handle(PyObject *py_file, const char *mode)
 {
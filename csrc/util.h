@@ -26,12 +26,19 @@ void panic(const char *message);
 void print_object(const PyObject *object);
 PyObject *_pyccn_unicode_to_utf8(PyObject *string, char **buffer,
 		Py_ssize_t *length);
+int _pyccn_content_get_buffer(PyObject *py_content, Py_buffer *view);
 FILE *_pyccn_open_file_handle(PyObject *py_file, const char *mode);
 int _pyccn_close_file_handle(FILE *fh);
 void *_pyccn_run_state_add(struct ccn *handle);
 struct pyccn_run_state *_pyccn_run_state_find(struct ccn *handle);
 void _pyccn_run_state_clear(void *handle);
 
+/*
+ * digesting less than this is cheaper than giving up the GIL (hashlib uses
+ * the same threshold)
+ */
+#  define GIL_MINSIZE 2048
+
 #  if DEBUG_MSG
 #    define debug(...) fprintf(stderr, __VA_ARGS__)
 #  else
@@ -6,19 +6,128 @@
 #
 
 from . import _pyccn
-import select, time
+from .Closure import Closure as _Closure, RESULT_OK, UPCALL_FINAL, \
+	UPCALL_CONTENT, UPCALL_CONTENT_UNVERIFIED, UPCALL_CONTENT_BAD
+from .ContentObject import DIGEST_SHA256, HMAC_SHA256
+import collections, select, time
 import threading
 #import dummy_threading as threading
 
+# Content verification off the network thread, see CCN.setVerifier().
+#
+# Worker threads check signatures with a KeyChain (which runs the crypto
+# without the GIL), the result is delivered to the closure on the thread
+# executing run() through the handle's submission queue, so closures are
+# called from the same thread as before. Only content signed with the
+# publisher's key is delivered as UPCALL_CONTENT, digest-only and HMAC
+# objects are always bad.
+class _VerifyPool(object):
+	def __init__(self, handle, keychain, threads):
+		self.handle = handle
+		self.keychain = keychain
+		self.verified = 0
+		self.bad = 0
+
+		self._jobs = collections.deque()
+		self._cond = threading.Condition()
+		self._running = True
+
+		self._workers = [threading.Thread(target = self._work,
+			name = "pyccn-verify-%d" % i) for i in range(threads)]
+		for t in self._workers:
+			t.daemon = True
+			t.start()
+
+	def submit(self, closure, upcallInfo):
+		with self._cond:
+			self._jobs.append((closure, upcallInfo))
+			self._cond.notify()
+
+	def _work(self):
+		while True:
+			with self._cond:
+				while self._running and not self._jobs:
+					self._cond.wait()
+				if not self._jobs:
+					return
+				closure, upcallInfo = self._jobs.popleft()
+
+			co = upcallInfo.ContentObject
+			try:
+				ok = co.digestAlgorithm not in (DIGEST_SHA256, HMAC_SHA256) \
+					and self.keychain.verify(co)
+			except Exception:
+				ok = False
+
+			with self._cond:
+				if ok:
+					self.verified += 1
+				else:
+					self.bad += 1
+
+			co.verified = ok
+			kind = UPCALL_CONTENT if ok else UPCALL_CONTENT_BAD
+			_pyccn.submit_call(self.handle.ccn_data, closure._deliver,
+				(kind, upcallInfo))
+
+	# objects already submitted are still verified and delivered
+	def close(self):
+		with self._cond:
+			self._running = False
+			self._cond.notify_all()
+
+		for t in self._workers:
+			t.join()
+
+# Sends unverified content to the pool, the application's closure sees only
+# CONTENT or CONTENT_BAD. FINAL is held back until everything was delivered.
+class _VerifyingClosure(_Closure):
+	def __init__(self, closure, pool):
+		_Closure.__init__(self)
+		self.closure = closure
+		self.pool = pool
+		self.pending = 0
+		self.final_deferred = False
+		self.final_info = None
+
+	def upcall(self, kind, upcallInfo):
+		if kind == UPCALL_CONTENT_UNVERIFIED:
+			self.pending += 1
+			self.pool.submit(self, upcallInfo)
+			return RESULT_OK
+
+		if kind == UPCALL_FINAL and self.pending:
+			self.final_deferred = True
+			self.final_info = upcallInfo
+			return RESULT_OK
+
+		return self.closure.upcall(kind, upcallInfo)
+
+	# on the loop thread, the interest was consumed by then so the upcall's
+	# result (e.g. RESULT_REEXPRESS) can't be acted on anymore
+	def _deliver(self, kind, upcallInfo):
+		self.pending -= 1
+		try:
+			self.closure.upcall(kind, upcallInfo)
+		finally:
+			if not self.pending and self.final_deferred:
+				self.final_deferred = False
+				self.closure.upcall(UPCALL_FINAL, self.final_info)
+
 # Fronts ccn
 
 # ccn_handle is opaque to c struct
 
 class CCN(object):
-	def __init__(self):
+	# sockname is the path of ccnd's unix socket, by default libccn's
+	# (which honors CCN_LOCAL_PORT)
+	def __init__(self, sockname = None):
 		self._handle_lock = threading.Lock()
+		self._state = threading.Condition() # guards _loop_thread
+		self._loop_thread = None
+		self._verifier = None
 		self.ccn_data = _pyccn.create()
-		_pyccn.connect(self.ccn_data)
+		_pyccn.connect(self.ccn_data, sockname)
 
 	def _acquire_lock(self, tag):
 		if not _pyccn.is_run_executing(self.ccn_data):
@@ -29,9 +138,28 @@ class CCN(object):
 	def _release_lock(self, tag):
 		if not _pyccn.is_run_executing(self.ccn_data):
 #			print("%s: releasing lock" % tag)
-			self._handle_lock.release()
+			with self._state:
+				self._handle_lock.release()
+				self._state.notify_all()
 #			print("%s: lock released" % tag)
 
+	# True when run() is executing in a different thread, the operation then
+	# needs to be submitted to the loop thread (handles aren't thread safe).
+	# Otherwise the lock is acquired as with _acquire_lock(). Both are decided
+	# under _state, so run() can't start in between; while the lock is busy
+	# we wait on _state instead, to see run() starting meanwhile.
+	def _lock_or_submit(self, tag):
+		with self._state:
+			while True:
+				loop_thread = self._loop_thread
+				if loop_thread is not None and \
+						loop_thread is not threading.current_thread():
+					return True
+				if _pyccn.is_run_executing(self.ccn_data) or \
+						self._handle_lock.acquire(False):
+					return False
+				self._state.wait()
+
 	def fileno(self):
 		return _pyccn.get_connection_fd(self.ccn_data)
 
@@ -43,33 +171,111 @@ class CCN(object):
 		assert not _pyccn.is_run_executing(self.ccn_data), "Command should be called when ccn_run is not running"
 		return _pyccn.output_is_pending(self.ccn_data)
 
+	# bytes of put ContentObjects that ccnd's socket didn't take yet, from
+	# any thread; exact once libccn's buffer empties, an upper bound before
+	def pending_output_bytes(self):
+		return _pyccn.pending_output_bytes(self.ccn_data)
+
+	# True once more than the high watermark is pending, until it drains to
+	# the low one; producers should hold off with puts meanwhile
+	def output_is_blocked(self):
+		return _pyccn.output_is_blocked(self.ccn_data)
+
+	# in bytes, defaults are 256 KiB and 1 MiB, high of 0 never blocks
+	def setOutputWatermarks(self, low, high):
+		_pyccn.set_output_watermarks(self.ccn_data, low, high)
+
+	# callback() is called from run() each time blocked output drained to the
+	# low watermark, None removes it
+	def setWritableCallback(self, callback):
+		_pyccn.set_writable_callback(self.ccn_data, callback)
+
 	def run(self, timeoutms):
 		assert not _pyccn.is_run_executing(self.ccn_data), "Command should be called when ccn_run is not running"
+		# set first, other threads submit from now on and the queue is
+		# executed once run() gets the lock
+		with self._state:
+			self._loop_thread = threading.current_thread()
+			self._state.notify_all()
 		self._handle_lock.acquire()
 		try:
 			_pyccn.run(self.ccn_data, timeoutms)
 		finally:
-			self._handle_lock.release()
+			with self._state:
+				self._loop_thread = None
+				self._handle_lock.release()
+				self._state.notify_all()
 
 	def setRunTimeout(self, timeoutms):
 		_pyccn.set_run_timeout(self.ccn_data, timeoutms)
 
+	# Verifies content received for expressInterest() closures on worker
+	# threads with keychain (a KeyChain) instead of in ccn on the
+	# network thread. Closures are called with UPCALL_CONTENT or
+	# UPCALL_CONTENT_BAD once the signature was checked, from run() as usual.
+	# The keychain should fetch keys with its own handle, not this one.
+	# setVerifier(None) goes back to ccn's verification.
+	def setVerifier(self, keychain, threads = 2):
+		if self._verifier:
+			self._verifier.close()
+			self._verifier = None
+
+		if keychain is None:
+			_pyccn.defer_verification(self.ccn_data, False)
+			return
+
+		self._verifier = _VerifyPool(self, keychain, threads)
+		_pyccn.defer_verification(self.ccn_data, True)
+
+	# number of objects that passed and failed verification by the verifier
+	def verifierStats(self):
+		if not self._verifier:
+			return None
+		return {"verified": self._verifier.verified,
+			"bad": self._verifier.bad}
+
 	# Application-focused methods
 	#
-	def expressInterest(self, name, closure, template = None):
-		self._acquire_lock("expressInterest")
+	# retry is an optional RetryPolicy, see Closure.py
+	def expressInterest(self, name, closure, template = None, retry = None):
+		retry = None if retry is None else retry._to_ccn()
+
+		if self._verifier:
+			closure = _VerifyingClosure(closure, self._verifier)
+
+		if self._lock_or_submit("expressInterest"):
+			if retry is None:
+				return _pyccn.submit_express_interest(self, name, closure,
+					template)
+			return _pyccn.submit_express_interest(self, name, closure,
+				template, retry)
+
 		try:
-			return _pyccn.express_interest(self, name, closure, template)
+			if retry is None:
+				return _pyccn.express_interest(self, name, closure, template)
+			return _pyccn.express_interest(self, name, closure, template,
+				retry)
 		finally:
 			self._release_lock("expressInterest")
 
-	def setInterestFilter(self, name, closure, flags = None):
-		self._acquire_lock("setInterestFilter")
+	# with aggregate set, identical interests (same name and selectors) that
+	# arrive while the first one is still pending aren't passed to the closure
+	# again, they're answered by the same put()
+	def setInterestFilter(self, name, closure, flags = None, aggregate = False):
+		if self._lock_or_submit("setInterestFilter"):
+			if flags is None:
+				return _pyccn.submit_set_interest_filter(self.ccn_data,
+					name.ccn_data, closure, aggregate = aggregate)
+			return _pyccn.submit_set_interest_filter(self.ccn_data,
+				name.ccn_data, closure, flags, aggregate)
+
 		try:
 			if flags is None:
-				return _pyccn.set_interest_filter(self.ccn_data, name.ccn_data, closure)
+				return _pyccn.set_interest_filter(self.ccn_data, name.ccn_data, closure,
+					aggregate = aggregate)
 			else:
-				return _pyccn.set_interest_filter(self.ccn_data, name.ccn_data, closure, flags)
+				return _pyccn.set_interest_filter(self.ccn_data, name.ccn_data, closure,
+					flags, aggregate)
 		finally:
 			self._release_lock("setInterestFilter")
 
@@ -84,13 +290,51 @@ class CCN(object):
 		finally:
 			self._release_lock("get")
 
+	# Blocking! Fetches all names (or interests) concurrently, results are
+	# in the same order with None for what didn't arrive within timeoutms
+	def get_many(self, names, timeoutms = 3000, max_outstanding = None):
+		self._acquire_lock("get_many")
+		try:
+			return _pyccn.get_many(self, names, timeoutms,
+				max_outstanding or 0)
+		finally:
+			self._release_lock("get_many")
+
+	# when run() is executing in another thread, expressInterest(),
+	# setInterestFilter() and put() don't wait for it, the operation is queued
+	# and executed by the loop thread (they return None then)
 	def put(self, contentObject):
-		self._acquire_lock("put")
+		if self._lock_or_submit("put"):
+			return _pyccn.submit_put(self, contentObject)
+
 		try:
 			return _pyccn.put(self, contentObject)
 		finally:
 			self._release_lock("put")
 
+	# Sends all contentObjects, with a single gathered write when ccnd's socket
+	# takes them. Returns (accepted, pending), pending are left buffered and
+	# go out from run() as the socket drains. From another thread while run()
+	# executes they're all queued for the loop thread, so all pending.
+	def put_many(self, contentObjects):
+		if self._lock_or_submit("put_many"):
+			contentObjects = list(contentObjects)
+			for co in contentObjects:
+				_pyccn.submit_put(self, co)
+			return (0, len(contentObjects))
+
+		try:
+			return _pyccn.put_many(self, contentObjects)
+		finally:
+			self._release_lock("put_many")
+
+	# counters kept by the C module, see utils.stats_to_prometheus()
+	def stats(self):
+		return _pyccn.get_stats(self.ccn_data)
+
+	def resetStats(self):
+		_pyccn.reset_stats(self.ccn_data)
+
 	@staticmethod
 	def getDefaultKey():
 		return _pyccn.get_default_key()
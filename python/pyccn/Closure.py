@@ -56,3 +56,35 @@ class UpcallInfo(object):
 		ret += "\nmatchedComps = %s" % self.matchedComps
 		ret += "\nContentObject: %s" % str(self.ContentObject)
 		return ret
+
+# Retransmission policy for CCN.expressInterest(), applied in C so the
+# closure only sees the final outcome: INTEREST_TIMED_OUT is passed to
+# upcall() once the retries are used up or the next one wouldn't start
+# before the deadline.
+#
+# retries      - how many times to re-express the interest
+# backoffms    - delay before the first retry, doubled with every next one
+#                (0 re-expresses immediately)
+# maxBackoffms - cap on the delay (None for no cap)
+# jitter       - randomize each delay by up to +/- this fraction (0 - 1)
+# deadlinems   - no retries are started after this time from expressing
+#                the interest (None for no deadline)
+class RetryPolicy(object):
+	def __init__(self, retries = 3, backoffms = 0, maxBackoffms = None,
+			jitter = 0.0, deadlinems = None):
+		self.retries = retries
+		self.backoffms = backoffms
+		self.maxBackoffms = maxBackoffms
+		self.jitter = jitter
+		self.deadlinems = deadlinems
+
+	def _to_ccn(self):
+		return (self.retries, self.backoffms,
+			0 if self.maxBackoffms is None else self.maxBackoffms,
+			float(self.jitter),
+			-1 if self.deadlinems is None else self.deadlinems)
+
+	def __repr__(self):
+		return "RetryPolicy(retries = %r, backoffms = %r, maxBackoffms = %r, " \
+			"jitter = %r, deadlinems = %r)" % (self.retries, self.backoffms,
+			self.maxBackoffms, self.jitter, self.deadlinems)
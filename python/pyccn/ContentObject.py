@@ -18,7 +18,18 @@ CONTENT_KEY = ContentType.new_flag('CONTENT_KEY', 0x28463F)
 CONTENT_LINK = ContentType.new_flag('CONTENT_LINK', 0x2C834A)
 CONTENT_NACK = ContentType.new_flag('CONTENT_NACK', 0x34008A)
 
+# values of ContentObject.digestAlgorithm for objects that aren't signed with
+# a private key: DIGEST_SHA256 only detects corruption, HMAC_SHA256 is keyed
+# by a secret shared between publisher and consumer
+DIGEST_SHA256 = "2.16.840.1.101.3.4.2.1"
+HMAC_SHA256 = "1.2.840.113549.2.9"
+
 class ContentObject(object):
+	# objects coming from ccn have these decoded from ccn_data on first access
+	_lazy_fields = ('name', 'content', 'signedInfo', 'signature',
+		'digestAlgorithm')
+	_lazy = None
+
 	def __init__(self, name = None, content = None, signed_info = None):
 		self.name = name
 		self.content = content
@@ -40,7 +51,10 @@ class ContentObject(object):
 	# a CCN handle is not required to create the content object
 	# thus there is no access to the ccn library keystore.
 	#
-	def sign(self, key):
+	# with digestAlgorithm set to HMAC_SHA256 the key is the shared secret
+	# (bytes), with DIGEST_SHA256 it isn't used
+	#
+	def sign(self, key = None):
 		self.ccn_data = _pyccn.encode_ContentObject(self, self.name.ccn_data, \
 			self.content, self.signedInfo.ccn_data, key)
 		self.ccn_data_dirty = False
@@ -48,19 +62,40 @@ class ContentObject(object):
 	def digest(self):
 		return _pyccn.digest_contentobject(self.ccn_data)
 
+	# objects signed with DIGEST_SHA256 or HMAC_SHA256 never verify here
 	def verify_content(self, handle):
 		return _pyccn.verify_content(handle.ccn_data, self.ccn_data)
 
-	def verify_signature(self, key):
-		return _pyccn.verify_signature(self.ccn_data, key.ccn_data_public)
+	# key is a Key, or the shared secret for HMAC_SHA256 signed objects; a
+	# DIGEST_SHA256 object is checked only when no key is given, with a Key
+	# neither of them verifies
+	def verify_signature(self, key = None):
+		if hasattr(key, 'ccn_data_public'):
+			key = key.ccn_data_public
+		return _pyccn.verify_signature(self.ccn_data, key)
 
 	def matchesInterest(self, interest):
 		return _pyccn.content_matches_interest(self.ccn_data, interest.ccn_data)
 
+	# returns indices of interests (list of Interest objects) matching this object
+	def matchesInterests(self, interests):
+		return _pyccn.content_matches_interests(self.ccn_data, interests)
+
+	# same as above, but returns the matching interests themselves
+	def matchingInterests(self, interests):
+		return _pyccn.interests_matching_content(self.ccn_data, interests)
+
 	def __setattr__(self, name, value):
+		if name in ContentObject._lazy_fields:
+			lazy = object.__getattribute__(self, '_lazy')
+			if lazy:
+				lazy.discard(name)
+
 		if name == 'name' or name == 'content' or name == 'signedInfo' or name == 'digestAlgorithm':
 			self.ccn_data_dirty = True
 
+		# buffers (bytearray, memoryview, mmap...) are kept without copying
+		# and read in place by sign(), so they shouldn't change before that
 		if name == 'content':
 			object.__setattr__(self, name, _pyccn.content_to_bytes(value))
 		else:
@@ -71,6 +106,13 @@ class ContentObject(object):
 			if object.__getattribute__(self, 'ccn_data_dirty'):
 				raise _pyccn.CCNContentObjectError("Call sign() to finalize \
 					before accessing ccn_data for a ContentObject")
+		elif name in ContentObject._lazy_fields:
+			lazy = object.__getattribute__(self, '_lazy')
+			if lazy and name in lazy:
+				ccn_data = object.__getattribute__(self, 'ccn_data')
+				value = _pyccn.ContentObject_field_from_ccn(ccn_data, name)
+				object.__setattr__(self, name, value)
+				lazy.discard(name)
 		return object.__getattribute__(self, name)
 
 	# Where do we support versioning and segmentation?
@@ -101,6 +143,24 @@ class ContentObject(object):
 
 		return "pyccn.ContentObject(%s)" % ", ".join(args)
 
+# Signs all objects with a single signature, each of them gets the path to
+# the root of a Merkle hash tree built over all of them as the witness, so
+# it still can be verified on its own with verify_signature()
+def sign_aggregated(objects, key):
+	parts = [(co.name.ccn_data, co.content, co.signedInfo.ccn_data)
+		for co in objects]
+	encoded = _pyccn.encode_ContentObjects_merkle(parts, key)
+
+	for co, ccn_data in zip(objects, encoded):
+		co.ccn_data = ccn_data
+		co.ccn_data_dirty = False
+
+# True if all objects were signed by key with sign_aggregated() at once,
+# costs a single signature verification
+def verify_aggregated(objects, key):
+	return _pyccn.verify_ContentObjects([co.ccn_data for co in objects],
+		key.ccn_data_public)
+
 class Signature(object):
 	def __init__(self):
 		self.digestAlgorithm = None
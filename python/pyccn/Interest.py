@@ -30,6 +30,12 @@ AOK_EXPIRE = AOKType.new_flag('AOK_EXPIRE', 0x10) # Mark as stale (requires scop
 AOK_DEFAULT = AOK_CS | AOK_NEW
 
 class Interest(object):
+	# received interests have these decoded from ccn_data on first access
+	_lazy_fields = ('name', 'minSuffixComponents', 'maxSuffixComponents',
+		'publisherPublicKeyDigest', 'exclude', 'childSelector',
+		'answerOriginKind', 'scope', 'interestLifetime', 'nonce')
+	_lazy = None
+
 	def __init__(self, name = None, minSuffixComponents = None, \
 				 maxSuffixComponents = None, publisherPublicKeyDigest = None, \
 				 exclude = None, childSelector = None, answerOriginKind = None, \
@@ -51,12 +57,24 @@ class Interest(object):
 		self.ccn_data = None  # backing charbuf
 
 	def __setattr__(self, name, value):
+		if name in Interest._lazy_fields:
+			lazy = object.__getattribute__(self, '_lazy')
+			if lazy:
+				lazy.discard(name)
+
 		if name != "ccn_data_dirty":
 			self.ccn_data_dirty = True
 		object.__setattr__(self, name, value)
 
 	def __getattribute__(self, name):
-		if name == "ccn_data":
+		if name in Interest._lazy_fields:
+			lazy = object.__getattribute__(self, '_lazy')
+			if lazy and name in lazy:
+				ccn_data = object.__getattribute__(self, 'ccn_data')
+				value = _pyccn.Interest_field_from_ccn(ccn_data, name)
+				object.__setattr__(self, name, value)
+				lazy.discard(name)
+		elif name == "ccn_data":
 			# force refresh if components changed
 			if object.__getattribute__(self, 'name') and self.name.ccn_data_dirty:
 				self.ccn_data_dirty = True
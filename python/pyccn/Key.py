@@ -24,6 +24,10 @@ class Key(object):
 	def generateRSA(self, numbits):
 		_pyccn.generate_RSA_key(self, numbits)
 
+	# ECDSA key, curve is an OpenSSL curve name (prime256v1 is NIST P-256)
+	def generateEC(self, curve = "prime256v1"):
+		_pyccn.generate_EC_key(self, curve)
+
 	def privateToDER(self):
 		if not self.ccn_data_private:
 			raise _pyccn.CCNKeyError("Key is not private")
@@ -82,6 +86,7 @@ class KeyLocator(object):
 		#if multiple set, checking order is: keyName, key, certificate
 		self.key = arg if type(arg) is Key else None
 		self.keyName = arg if type(arg) is Name.Name else None
+		self.keyNameDigest = None # publicKeyID of the publisher of the key
 		self.certificate = None
 
 		# pyccn
@@ -98,7 +103,7 @@ class KeyLocator(object):
 			if object.__getattribute__(self, 'ccn_data_dirty'):
 				if object.__getattribute__(self, 'keyName'):
 					self.ccn_data = _pyccn.KeyLocator_to_ccn(
-						name=self.keyName.ccn_data)
+						name=self.keyName.ccn_data, digest=self.keyNameDigest)
 				elif object.__getattribute__(self, 'key'):
 					self.ccn_data = _pyccn.KeyLocator_to_ccn(
 						key=self.key.ccn_data_public)
@@ -0,0 +1,230 @@
+#
+# Copyright (c) 2026, Regents of the University of California
+# BSD license, See the COPYING file for more information
+#
+
+# Public keys of publishers, for verifying content from many of them:
+#
+#	chain = KeyChain(handle)
+#	co = handle.get(name)
+#	if chain.verify(co):
+#		...
+#
+# A KeyLocator either carries the key itself or names it (KeyName), then the
+# key is fetched with the handle. Keys are kept in an LRU cache by their
+# publicKeyID, so each publisher's key is fetched and parsed once. Names that
+# couldn't be fetched are remembered for negative_ttl seconds, and concurrent
+# lookups of the same name share a single fetch.
+#
+# The chain only checks that a key matches the publisherPublicKeyDigest it
+# was looked up with; whether the publisher is trusted is up to the caller.
+# Objects signed with DIGEST_SHA256 or HMAC_SHA256 never verify, they carry
+# no signature made with the publisher's key.
+
+import collections, threading, time
+
+from .ContentObject import DIGEST_SHA256, HMAC_SHA256
+from .Interest import Interest
+from .Key import Key
+
+__all__ = ['KeyChain']
+
+_timer = getattr(time, "perf_counter", time.time)
+
+class _Fetch(object):
+	def __init__(self):
+		self.done = threading.Event()
+		self.key = None
+
+class KeyChain(object):
+	# handle is a CCN used to fetch keys by name (without it only embedded and
+	# added keys are found), keys are trusted keys to start with
+	def __init__(self, handle = None, capacity = 1024, negative_ttl = 60.0,
+			timeoutms = 3000, keys = ()):
+		if capacity < 1:
+			raise ValueError("capacity needs to be at least 1")
+
+		self.handle = handle
+		self.capacity = capacity
+		self.negative_ttl = negative_ttl
+		self.timeoutms = timeoutms
+
+		self._lock = threading.Lock()
+		self._keys = collections.OrderedDict() # publicKeyID -> (Key, name)
+		self._names = {}    # name -> publicKeyID of the key fetched from it
+		self._missing = {}  # fetch -> time when it can be retried
+		self._fetching = {} # fetch -> _Fetch
+
+		self._stats = dict.fromkeys(("hits", "misses", "fetches",
+			"fetch_failures", "coalesced", "negative_hits", "evictions"), 0)
+
+		for key in keys:
+			self.add(key)
+
+	def __len__(self):
+		with self._lock:
+			return len(self._keys)
+
+	def _store(self, key, name = None):
+		self._keys.pop(key.publicKeyID, None)
+		self._keys[key.publicKeyID] = (key, name)
+		if name is not None:
+			self._names[name] = key.publicKeyID
+
+		while len(self._keys) > self.capacity:
+			key_id, (old, old_name) = self._keys.popitem(last = False)
+			if old_name is not None and self._names.get(old_name) == key_id:
+				del self._names[old_name]
+			self._stats["evictions"] += 1
+
+	# caller holds the lock, marks the entry as recently used
+	def _cached(self, key_id):
+		entry = self._keys.pop(key_id, None)
+		if entry is None:
+			return None
+		self._keys[key_id] = entry
+		return entry[0]
+
+	def add(self, key):
+		with self._lock:
+			self._store(key)
+
+	def remove(self, publicKeyID):
+		with self._lock:
+			entry = self._keys.pop(publicKeyID, None)
+			if entry and entry[1] is not None and \
+					self._names.get(entry[1]) == publicKeyID:
+				del self._names[entry[1]]
+
+	# cached key with given publicKeyID, never fetches
+	def find(self, publicKeyID):
+		with self._lock:
+			return self._cached(publicKeyID)
+
+	def clear(self):
+		with self._lock:
+			self._keys.clear()
+			self._names.clear()
+			self._missing.clear()
+
+	# public key (Key) given by keyLocator and/or publicKeyID (the signer's
+	# publisherPublicKeyDigest), None when it's unknown or can't be fetched
+	def resolve(self, keyLocator = None, publicKeyID = None):
+		name = None
+		if keyLocator is not None and keyLocator.key is None and \
+				keyLocator.keyName is not None:
+			name = str(keyLocator.keyName)
+
+		with self._lock:
+			key = None
+			if publicKeyID is not None:
+				key = self._cached(publicKeyID)
+			elif name is not None and name in self._names:
+				key = self._cached(self._names[name])
+
+			if key is not None:
+				self._stats["hits"] += 1
+				return key
+			self._stats["misses"] += 1
+
+		if keyLocator is None:
+			return None
+
+		if keyLocator.key is not None:
+			key = keyLocator.key
+			if publicKeyID is not None and key.publicKeyID != publicKeyID:
+				return None
+			self.add(key)
+			return key
+
+		if name is None or self.handle is None:
+			return None
+
+		return self._fetch(keyLocator, name, publicKeyID)
+
+	def _fetch(self, keyLocator, name, publicKeyID):
+		fetch_id = (name, keyLocator.keyNameDigest, publicKeyID)
+
+		with self._lock:
+			retry = self._missing.get(fetch_id)
+			if retry is not None:
+				if retry > _timer():
+					self._stats["negative_hits"] += 1
+					return None
+				del self._missing[fetch_id]
+
+			fetch = self._fetching.get(fetch_id)
+			if fetch is not None:
+				self._stats["coalesced"] += 1
+				owner = False
+			else:
+				fetch = self._fetching[fetch_id] = _Fetch()
+				self._stats["fetches"] += 1
+				owner = True
+
+		if not owner:
+			fetch.done.wait()
+			return fetch.key
+
+		try:
+			key = self._fetch_key(keyLocator, publicKeyID)
+		except Exception:
+			key = None
+
+		with self._lock:
+			del self._fetching[fetch_id]
+			if key is None:
+				self._stats["fetch_failures"] += 1
+				if self.negative_ttl > 0:
+					now = _timer()
+					if len(self._missing) >= self.capacity:
+						self._missing = dict((f, t) for f, t in
+							self._missing.items() if t > now)
+					self._missing[fetch_id] = now + self.negative_ttl
+			else:
+				self._store(key, name)
+
+		fetch.key = key
+		fetch.done.set()
+
+		return key
+
+	def _fetch_key(self, keyLocator, publicKeyID):
+		template = None
+		if keyLocator.keyNameDigest is not None:
+			template = Interest(
+				publisherPublicKeyDigest = keyLocator.keyNameDigest)
+
+		co = self.handle.get(keyLocator.keyName, template, self.timeoutms)
+		if co is None or not co.content:
+			return None
+
+		key = Key()
+		key.fromDER(public = co.content)
+		if publicKeyID is not None and key.publicKeyID != publicKeyID:
+			return None
+
+		return key
+
+	# key of the publisher of ContentObject co
+	def lookup(self, co):
+		si = co.signedInfo
+		return self.resolve(si.keyLocator, si.publisherPublicKeyDigest)
+
+	# True if co has a valid signature made by its publisher's key
+	def verify(self, co):
+		# anyone can make these, whatever key the KeyLocator names
+		if co.digestAlgorithm in (DIGEST_SHA256, HMAC_SHA256):
+			return False
+
+		key = self.lookup(co)
+		if key is None:
+			return False
+		return co.verify_signature(key)
+
+	def stats(self):
+		with self._lock:
+			result = dict(self._stats)
+			result["keys"] = len(self._keys)
+			result["missing"] = len(self._missing)
+		return result
@@ -0,0 +1,242 @@
+#
+# Copyright (c) 2026, Regents of the University of California
+# BSD license, See the COPYING file for more information
+#
+
+# Keys generated ahead of time, for when a fresh key is needed on a latency
+# sensitive path (e.g. per session keys):
+#
+#	pool = KeyPool({("RSA", 2048): 8, ("EC", "prime256v1"): 16})
+#	key = pool.get(("RSA", 2048))
+#	...
+#	pool.close()
+#
+# Worker threads keep every key type topped up to its target level, key
+# generation runs without the GIL so they don't hold up the application.
+# When a type runs out get() generates the key itself, so it's never slower
+# than generating the key directly; stats() tells how often that happened.
+# A type whose generation fails MAX_FAILURES times in a row isn't refilled
+# any more, fill() raises the last error instead of waiting for it.
+
+import collections, threading, time
+
+from .Key import Key
+
+__all__ = ['KeyPool']
+
+_timer = getattr(time, "perf_counter", time.time)
+
+# number of recent get() wait times kept for the percentiles
+WAIT_SAMPLES = 1024
+
+# consecutive generation failures after which workers give up on a key type
+MAX_FAILURES = 5
+
+def _generate(spec):
+	kind, param = spec
+	key = Key()
+	if kind == "RSA":
+		key.generateRSA(param)
+	elif kind == "EC":
+		key.generateEC(param)
+	else:
+		raise ValueError("unknown key type: %r" % kind)
+	return key
+
+def _percentile(values, p):
+	if not values:
+		return None
+	values = sorted(values)
+	return values[int(round(p / 100.0 * (len(values) - 1)))]
+
+class _Level(object):
+	def __init__(self, target):
+		self.target = target
+		self.keys = collections.deque()
+		self.generating = 0
+		self.generated = 0
+		self.handed_out = 0
+		self.misses = 0
+		self.waits = collections.deque(maxlen = WAIT_SAMPLES)
+		self.failures = 0
+		self.error = None # set when workers gave up on this type
+
+	# how far below the target, counting keys that are on the way
+	def shortage(self):
+		return self.target - len(self.keys) - self.generating
+
+class KeyPool(object):
+	# specs maps (type, parameter) to the number of keys to keep ready, type
+	# is "RSA" (parameter is the size in bits) or "EC" (curve name)
+	def __init__(self, specs = None, threads = 1):
+		if specs is None:
+			specs = {("RSA", 2048): 4}
+		elif not specs:
+			raise ValueError("need at least one key type")
+
+		self._levels = {}
+		for spec, target in specs.items():
+			if spec[0] not in ("RSA", "EC"):
+				raise ValueError("unknown key type: %r" % (spec[0],))
+			if target < 0:
+				raise ValueError("target level can't be negative")
+			self._levels[tuple(spec)] = _Level(target)
+
+		self._default = tuple(next(iter(specs))) if len(specs) == 1 else None
+		self._cond = threading.Condition()
+		self._running = True
+		self.errors = 0
+
+		self._workers = [threading.Thread(target = self._work,
+			name = "pyccn-keypool-%d" % i) for i in range(threads)]
+		for t in self._workers:
+			t.daemon = True
+			t.start()
+
+	def __enter__(self):
+		return self
+
+	def __exit__(self, *exc):
+		self.close()
+
+	def _level(self, spec):
+		if spec is None:
+			if self._default is None:
+				raise ValueError("key type needs to be given, the pool has"
+					" more than one")
+			spec = self._default
+
+		try:
+			return tuple(spec), self._levels[tuple(spec)]
+		except KeyError:
+			raise ValueError("pool has no keys of type %r" % (spec,))
+
+	# the key type furthest below its target
+	def _next_spec(self):
+		best, best_shortage = None, 0
+		for spec, level in self._levels.items():
+			if level.error is not None:
+				continue
+			shortage = level.shortage()
+			if shortage > best_shortage:
+				best, best_shortage = spec, shortage
+		return best
+
+	def _work(self):
+		while True:
+			with self._cond:
+				spec = self._next_spec()
+				while self._running and spec is None:
+					self._cond.wait()
+					spec = self._next_spec()
+
+				if not self._running:
+					return
+
+				level = self._levels[spec]
+				level.generating += 1
+
+			try:
+				key, error = _generate(spec), None
+			except Exception as e:
+				key, error = None, e
+
+			with self._cond:
+				level.generating -= 1
+				if key is None:
+					self.errors += 1
+					level.failures += 1
+					if level.failures >= MAX_FAILURES:
+						level.error = error
+				else:
+					level.keys.append(key)
+					level.generated += 1
+					level.failures = 0
+				self._cond.notify_all()
+
+			# don't spin when generation keeps failing
+			if key is None:
+				time.sleep(0.1)
+
+	# returns a key that wasn't handed out before, spec can be omitted when
+	# the pool holds only one type
+	def get(self, spec = None):
+		spec, level = self._level(spec)
+		start = _timer()
+
+		with self._cond:
+			if level.keys:
+				key = level.keys.popleft()
+			else:
+				key = None
+				level.misses += 1
+
+			# a worker refills what was just taken
+			self._cond.notify_all()
+
+		if key is None:
+			key = _generate(spec)
+
+		wait = _timer() - start
+		with self._cond:
+			level.handed_out += 1
+			level.waits.append(wait)
+
+		return key
+
+	# blocks until every key type reached its target level, False on timeout
+	# or when the pool gets closed; raises the generation error of a type the
+	# workers gave up on
+	def fill(self, timeout = None):
+		deadline = None if timeout is None else _timer() + timeout
+
+		with self._cond:
+			while any(len(l.keys) < l.target for l in self._levels.values()):
+				if not self._running:
+					return False
+
+				for level in self._levels.values():
+					if level.error is not None and len(level.keys) < level.target:
+						raise level.error
+
+				if deadline is None:
+					self._cond.wait()
+				else:
+					remaining = deadline - _timer()
+					if remaining <= 0:
+						return False
+					self._cond.wait(remaining)
+
+		return True
+
+	def stats(self):
+		result = {}
+
+		with self._cond:
+			for (kind, param), level in self._levels.items():
+				waits = list(level.waits)
+				result["%s-%s" % (kind, param)] = {
+					"target": level.target,
+					"available": len(level.keys),
+					"generating": level.generating,
+					"generated": level.generated,
+					"handed_out": level.handed_out,
+					"misses": level.misses,
+					"failed": level.error is not None,
+					"wait_ms": dict((name, None if not waits else
+						_percentile(waits, p) * 1000.0) for name, p in
+						(("p50", 50), ("p90", 90), ("p99", 99), ("max", 100)))
+				}
+
+		return result
+
+	# stops the workers, keys left in the pool are dropped
+	def close(self):
+		with self._cond:
+			self._running = False
+			for level in self._levels.values():
+				level.keys.clear()
+			self._cond.notify_all()
+
+		for t in self._workers:
+			t.join()
@@ -10,6 +10,27 @@ from . import _pyccn, Name
 def new_state():
 	return _pyccn.nc_new_state()
 
+# replaces state in verify_command() when commands from many applications
+# are verified, for each one it remembers which of the last window sequence
+# numbers were seen (so commands can arrive out of order), max_apps most
+# recently seen applications are kept
+def new_verifier(max_apps = 1024, window = 128):
+	return _pyccn.nc_new_verifier(max_apps, window)
+
+def verifier_stats(verifier):
+	return _pyccn.nc_verifier_stats(verifier)
+
+# public keys converted once for verify_command(..., key_cache = cache,
+# key_id = id), key_cache_add() returns the id (same as Key.publicKeyID)
+def new_key_cache():
+	return _pyccn.nc_new_key_cache()
+
+def key_cache_add(cache, key):
+	return _pyccn.nc_key_cache_add(cache, key.ccn_data_public)
+
+def key_cache_remove(cache, key_id):
+	return _pyccn.nc_key_cache_remove(cache, key_id)
+
 def generate_application_key(fixture_key, app_name):
 	app_id = _pyccn.nc_app_id(app_name)
 	app_key = _pyccn.nc_app_key(fixture_key, app_id)
@@ -27,3 +48,23 @@ def verify_command(state, name, max_time, **args):
 	if args.has_key('pub_key'): # TODO: use magic bytes to detect signature type, instead of asking caller to explicitly specify key type
 		args['pub_key'] = args['pub_key'].ccn_data_public
 	return _pyccn.nc_verify_command(state, name.ccn_data, max_time, **args)
+
+# Keeps the application's key set up between commands, for applications
+# authenticating many of them (it has its own state)
+class Signer(object):
+	def __init__(self, app_name, app_key):
+		self.app_name = app_name
+		self.ccn_data = _pyccn.nc_signer_new(app_name, app_key)
+
+	@classmethod
+	def from_fixture_key(cls, fixture_key, app_name):
+		return cls(app_name, generate_application_key(fixture_key, app_name))
+
+	def authenticate(self, name):
+		signed_name = _pyccn.nc_signer_authenticate(self.ccn_data, name.ccn_data)
+		return Name(ccn_data = signed_name)
+
+	def authenticate_many(self, names):
+		signed_names = _pyccn.nc_signer_authenticate_many(self.ccn_data,
+			[name.ccn_data for name in names])
+		return [Name(ccn_data = signed_name) for signed_name in signed_names]
@@ -5,7 +5,8 @@
 #             Jeff Burke <jburke@ucla.edu>
 #
 
-__all__ = ['CCN', 'Closure', 'ContentObject', 'Interest', 'Key', 'Name']
+__all__ = ['CCN', 'Closure', 'ContentObject', 'Interest', 'Key', 'KeyChain',
+	'KeyPool', 'Name']
 
 import sys as _sys
 
@@ -15,6 +16,8 @@ try:
 	from pyccn.ContentObject import *
 	from pyccn.Interest import *
 	from pyccn.Key import *
+	from pyccn.KeyChain import *
+	from pyccn.KeyPool import *
 	from pyccn.Name import *
 	from pyccn import NameCrypto
 except ImportError:
@@ -0,0 +1,320 @@
+#
+# Copyright (c) 2026, Regents of the University of California
+# BSD license, See the COPYING file for more information
+#
+
+# Microbenchmarks of the codec and crypto paths of the C module.
+#
+#	python -m pyccn.bench [--json results.json] [--filter name] [--min-time s]
+#	                      [--threads 1,2,4,8]
+#
+# For every case it reports ops/s and the Python allocations per operation
+# (blocks still allocated afterwards and, with tracemalloc, bytes allocated
+# at peak). Allocations made by ccn and OpenSSL with malloc() aren't seen.
+#
+# With --threads every case is instead run from that many threads at once,
+# reporting the total ops/s and speedup over a single thread. Crypto runs
+# without the GIL, so signing and verification should scale with cores.
+#
+# "import pyccn" is the time a fresh interpreter needs to import the package,
+# less the interpreter's own startup; it's what every short lived tool pays.
+
+from __future__ import print_function
+
+import gc, json, platform, subprocess, sys, threading, time
+
+import pyccn
+from pyccn import _pyccn
+
+try:
+	import tracemalloc
+except ImportError:
+	tracemalloc = None
+
+_timer = getattr(time, "perf_counter", time.time)
+
+URI = "/ndn/ucla.edu/apps/bench/video/%FD%04%F0%E1%22%1C/%00%2A"
+PAYLOAD_SIZES = (0, 100, 1024, 8192)
+# number of objects signed at once with a Merkle tree
+AGGREGATE_SIZES = (16, 256)
+# (label, generator) of signing keys to compare
+KEYS = (("rsa1024", lambda k: k.generateRSA(1024)),
+	("rsa2048", lambda k: k.generateRSA(2048)),
+	("ec256", lambda k: k.generateEC("prime256v1")))
+
+def _allocated_blocks():
+	f = getattr(sys, "getallocatedblocks", None)
+	return f() if f else None
+
+def measure(name, fn, min_time = 0.5):
+	fn() # warm up, lazy initialization shouldn't count
+
+	# find number of iterations that takes at least min_time
+	n = 1
+	while True:
+		start = _timer()
+		for i in range(n):
+			fn()
+		elapsed = _timer() - start
+		if elapsed >= min_time:
+			break
+		n = n * 2 if elapsed < min_time / 10 else int(n * min_time / elapsed) + 1
+
+	result = {
+		"name": name,
+		"iterations": n,
+		"seconds": elapsed,
+		"ops_per_sec": n / elapsed,
+		"ns_per_op": elapsed * 1e9 / n,
+		"blocks_per_op": None,
+		"peak_bytes_per_op": None
+	}
+
+	# retained allocations: anything leaking shows up here
+	m = min(n, 1000)
+	gc.collect()
+	before = _allocated_blocks()
+	if before is not None:
+		for i in range(m):
+			fn()
+		gc.collect()
+		result["blocks_per_op"] = float(_allocated_blocks() - before) / m
+
+	if tracemalloc:
+		tracemalloc.start()
+		fn()
+		result["peak_bytes_per_op"] = tracemalloc.get_traced_memory()[1]
+		tracemalloc.stop()
+
+	return result
+
+def _run_python(code):
+	start = _timer()
+	subprocess.check_call([sys.executable, "-c", code])
+	return _timer() - start
+
+def _median(values):
+	values = sorted(values)
+	return values[len(values) // 2]
+
+# import time of the package in a new interpreter, over a bare interpreter
+def measure_import(runs = 15):
+	_run_python("import pyccn") # warm up the disk cache and .pyc files
+
+	base = _median([_run_python("pass") for i in range(runs)])
+	total = _median([_run_python("import pyccn") for i in range(runs)])
+
+	return {
+		"name": "import pyccn",
+		"iterations": runs,
+		"seconds": total,
+		"interpreter_seconds": base,
+		"ns_per_op": max(total - base, 0.0) * 1e9
+	}
+
+# total rate of fn called in a loop from given number of threads
+def measure_threads(name, fn, threads, min_time = 0.5):
+	fn()
+
+	stop = threading.Event()
+	counts = [0] * threads
+
+	def worker(i):
+		n = 0
+		while not stop.is_set():
+			fn()
+			n += 1
+		counts[i] = n
+
+	workers = [threading.Thread(target = worker, args = (i,))
+		for i in range(threads)]
+
+	start = _timer()
+	for t in workers:
+		t.start()
+	time.sleep(min_time)
+	stop.set()
+	for t in workers:
+		t.join()
+	elapsed = _timer() - start
+
+	return {
+		"name": name,
+		"threads": threads,
+		"iterations": sum(counts),
+		"seconds": elapsed,
+		"ops_per_sec": sum(counts) / elapsed
+	}
+
+def _content_object(key, size):
+	co = pyccn.ContentObject(pyccn.Name(URI), b"\x5a" * size)
+	co.signedInfo.publisherPublicKeyDigest = key.publicKeyID
+	co.sign(key)
+	return co
+
+def cases():
+	name = pyccn.Name(URI)
+	name_ccn = name.ccn_data
+	comps = name.components
+
+	yield "name_from_uri", lambda: _pyccn.name_from_uri(URI)
+	yield "name_to_uri", lambda: _pyccn.name_to_uri(name_ccn)
+	yield "name_comps_to_ccn", lambda: _pyccn.name_comps_to_ccn(comps)
+	yield "name_comps_from_ccn", lambda: _pyccn.name_comps_from_ccn(name_ccn)
+
+	exclude = pyccn.ExclusionFilter()
+	exclude.add_names([pyccn.Name([b"%03d" % i]) for i in range(10)])
+	interest = pyccn.Interest(name = name, minSuffixComponents = 1,
+		maxSuffixComponents = 3, childSelector = 1, scope = 2,
+		interestLifetime = 4.0, exclude = exclude)
+	interest_ccn = interest.ccn_data
+
+	def interest_from_ccn_all():
+		i = _pyccn.Interest_obj_from_ccn(interest_ccn)
+		for field in pyccn.Interest._lazy_fields:
+			getattr(i, field)
+
+	yield "Interest_obj_to_ccn", lambda: _pyccn.Interest_obj_to_ccn(interest)
+	yield "Interest_obj_from_ccn", \
+		lambda: _pyccn.Interest_obj_from_ccn(interest_ccn)
+	yield "Interest_obj_from_ccn[all fields]", interest_from_ccn_all
+
+	for count in (10, 100):
+		names = sorted(pyccn.Name([b"%05d" % i]) for i in range(count))
+		yield "ExclusionFilter_names_to_ccn[%d]" % count, \
+			lambda names = names: _pyccn.ExclusionFilter_names_to_ccn(names)
+
+	for label, generate in KEYS:
+		key = pyccn.Key()
+		generate(key)
+
+		for size in PAYLOAD_SIZES:
+			co = _content_object(key, size)
+			args = (co, co.name.ccn_data, co.content, co.signedInfo.ccn_data, key)
+			yield "encode_ContentObject[%s,%dB]" % (label, size), \
+				lambda args = args: _pyccn.encode_ContentObject(*args)
+
+		co = _content_object(key, 1024)
+		yield "verify_signature[%s,1024B]" % label, \
+			lambda co = co, key = key: \
+				_pyccn.verify_signature(co.ccn_data, key.ccn_data_public)
+
+		# per object cost is ops/s * count
+		for count in AGGREGATE_SIZES:
+			objs = [_content_object(key, 1024) for i in range(count)]
+			parts = [(co.name.ccn_data, co.content, co.signedInfo.ccn_data)
+				for co in objs]
+			yield "encode_ContentObjects_merkle[%s,%dx1024B]" % (label, count), \
+				lambda parts = parts, key = key: \
+					_pyccn.encode_ContentObjects_merkle(parts, key)
+
+			pyccn.sign_aggregated(objs, key)
+			data = [co.ccn_data for co in objs]
+			yield "verify_ContentObjects[%s,%dx1024B]" % (label, count), \
+				lambda data = data, key = key: \
+					_pyccn.verify_ContentObjects(data, key.ccn_data_public)
+
+	# signatures without a private key
+	for label, alg, secret in (("sha256", pyccn.DIGEST_SHA256, None),
+			("hmac-sha256", pyccn.HMAC_SHA256, b"\x42" * 32)):
+		co = pyccn.ContentObject(pyccn.Name(URI), b"\x5a" * 1024)
+		co.digestAlgorithm = alg
+		co.sign(secret)
+		args = (co, co.name.ccn_data, co.content, co.signedInfo.ccn_data, secret)
+		yield "encode_ContentObject[%s,1024B]" % label, \
+			lambda args = args: _pyccn.encode_ContentObject(*args)
+		yield "verify_signature[%s,1024B]" % label, \
+			lambda co = co, secret = secret: \
+				_pyccn.verify_signature(co.ccn_data, secret)
+
+	for size in PAYLOAD_SIZES:
+		co = _content_object(key, size)
+		yield "digest_contentobject[%dB]" % size, \
+			lambda co = co: _pyccn.digest_contentobject(co.ccn_data)
+
+def run_threads(filter = None, min_time = 0.5, threads = (1, 2, 4),
+		out = sys.stdout):
+	results = []
+	for name, fn in cases():
+		if filter and filter not in name:
+			continue
+
+		base = None
+		for n in threads:
+			r = measure_threads(name, fn, n, min_time)
+			if base is None:
+				base = r["ops_per_sec"]
+			r["speedup"] = r["ops_per_sec"] / base
+			results.append(r)
+			print("%-40s %3d threads %12.0f ops/s %6.2fx" % (name, n,
+				r["ops_per_sec"], r["speedup"]), file = out)
+
+	return results
+
+def run_single(filter = None, min_time = 0.5, out = sys.stdout):
+	results = []
+	for name, fn in cases():
+		if filter and filter not in name:
+			continue
+
+		r = measure(name, fn, min_time)
+		results.append(r)
+		print("%-40s %12.0f ops/s %10.0f ns/op %s" % (name, r["ops_per_sec"],
+			r["ns_per_op"], "" if r["blocks_per_op"] is None else
+			"%6.2f blocks/op" % r["blocks_per_op"]), file = out)
+
+	return results
+
+def run(filter = None, min_time = 0.5, out = sys.stdout, threads = None):
+	results = []
+	if not filter or filter in "import pyccn":
+		r = measure_import()
+		results.append(r)
+		print("%-40s %12.1f ms (interpreter %.1f ms)" % (r["name"],
+			r["ns_per_op"] / 1e6, r["interpreter_seconds"] * 1e3), file = out)
+
+	if threads:
+		results += run_threads(filter, min_time, threads, out)
+	else:
+		results += run_single(filter, min_time, out)
+
+	return {
+		"python": platform.python_version(),
+		"implementation": platform.python_implementation(),
+		"machine": platform.machine(),
+		"system": platform.platform(),
+		"time": time.time(),
+		"min_time": min_time,
+		"threads": threads,
+		"results": results
+	}
+
+def main(argv = None):
+	import argparse
+
+	parser = argparse.ArgumentParser(prog = "python -m pyccn.bench",
+		description = "Benchmarks of PyCCN's C module")
+	parser.add_argument("--json", metavar = "FILE",
+		help = "write results to FILE as JSON ('-' for stdout)")
+	parser.add_argument("--filter", metavar = "TEXT",
+		help = "only run cases whose name contains TEXT")
+	parser.add_argument("--min-time", type = float, default = 0.5,
+		metavar = "SECONDS", help = "minimum run time of each case")
+	parser.add_argument("--threads", metavar = "N,N,...",
+		type = lambda s: [int(n) for n in s.split(",")],
+		help = "measure scaling with these numbers of threads instead")
+	args = parser.parse_args(argv)
+
+	report = run(args.filter, args.min_time,
+		sys.stderr if args.json == "-" else sys.stdout, args.threads)
+
+	if args.json == "-":
+		json.dump(report, sys.stdout, indent = 1)
+	elif args.json:
+		with open(args.json, "w") as f:
+			json.dump(report, f, indent = 1)
+
+	return 0
+
+if __name__ == "__main__":
+	sys.exit(main())
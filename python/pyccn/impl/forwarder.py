@@ -0,0 +1,370 @@
+#
+# Copyright (c) 2026, Regents of the University of California
+# BSD license, See the COPYING file for more information
+#
+
+# Minimal stand-in for ccnd, enough to run producers and consumers on one
+# machine without the daemon:
+#
+#	fwd = Forwarder()
+#	fwd.start()
+#	handle = pyccn.CCN(fwd.sockname)
+#
+# It accepts libccn clients on a unix socket and speaks the ccnb face
+# protocol (Interests and ContentObjects back to back). Prefixes registered
+# by setInterestFilter() (selfreg) are used for forwarding, interests with
+# no registered prefix are flooded to all other faces. Content goes back
+# along the PIT, names are matched by prefix only (no selectors, no implicit
+# digest) and there is no content store, so put() works only as an answer
+# to a pending interest.
+
+import os, select, shutil, socket, tempfile, threading, time
+
+import pyccn
+from pyccn import _pyccn
+
+DTAG_NAME           = 14
+DTAG_COMPONENT      = 15
+DTAG_CONTENT        = 19
+DTAG_INTEREST       = 26
+DTAG_CONTENT_OBJECT = 64
+
+TT_TAG   = 1
+TT_DTAG  = 2
+TT_ATTR  = 3
+TT_DATTR = 4
+TT_BLOB  = 5
+TT_UDATA = 6
+
+# interests answered by the forwarder itself
+LOCALHOST = b'\xc1.M.S.localhost'
+SELFREG = b'selfreg'
+
+INTEREST_LIFETIME = 4.0
+
+def _header(buf, pos):
+	value = 0
+	while pos < len(buf):
+		c = buf[pos]
+		pos += 1
+		if c & 0x80:
+			return c & 0x7, (value << 4) | ((c >> 3) & 0xf), pos
+		value = (value << 7) | c
+	return None
+
+# returns offset just past the element starting at pos, or None when buf
+# doesn't contain all of it yet
+def element_end(buf, pos = 0):
+	depth = 0
+	while pos < len(buf):
+		if buf[pos] == 0:
+			if depth == 0:
+				raise ValueError("unexpected closer")
+			depth -= 1
+			pos += 1
+			if depth == 0:
+				return pos
+			continue
+
+		h = _header(buf, pos)
+		if h is None:
+			return None
+		tt, value, pos = h
+
+		if tt == TT_BLOB or tt == TT_UDATA:
+			pos += value
+			if depth == 0:
+				return pos if pos <= len(buf) else None
+		elif tt == TT_DTAG:
+			depth += 1
+		elif tt == TT_TAG:
+			pos += value + 1
+			depth += 1
+		elif tt == TT_ATTR:
+			pos += value + 1
+		elif tt != TT_DATTR:
+			raise ValueError("unsupported ccnb element type %d" % tt)
+	return None
+
+def element_dtag(buf, pos = 0):
+	tt, value, pos = _header(buf, pos)
+	return value if tt == TT_DTAG else None
+
+# position of the first child of element at pos with given dtag
+def find_child(buf, pos, dtag):
+	tt, value, pos = _header(buf, pos)
+	if tt != TT_DTAG:
+		raise ValueError("expected a DTAG")
+
+	while buf[pos] != 0:
+		tt, value, start = _header(buf, pos)
+		if tt == TT_DTAG and value == dtag:
+			return pos
+		pos = element_end(buf, pos)
+
+	raise ValueError("element %d not found" % dtag)
+
+def blob_value(buf, pos):
+	tt, value, pos = _header(buf, pos)
+	if buf[pos] == 0:
+		return b''
+	tt, length, pos = _header(buf, pos)
+	return bytes(buf[pos:pos + length])
+
+# name of an Interest or ContentObject as tuple of components
+def name_components(buf, pos = 0):
+	pos = find_child(buf, pos, DTAG_NAME)
+	tt, value, pos = _header(buf, pos)
+
+	comps = []
+	while buf[pos] != 0:
+		comps.append(blob_value(buf, pos))
+		pos = element_end(buf, pos)
+
+	return tuple(comps)
+
+class Face(object):
+	def __init__(self, faceid, sock):
+		self.id = faceid
+		self.sock = sock
+		self.inbuf = bytearray()
+		self.outbuf = bytearray()
+
+	def __repr__(self):
+		return "<Face %d>" % self.id
+
+class Forwarder(threading.Thread):
+	def __init__(self, sockname = None, key = None):
+		threading.Thread.__init__(self, name = "pyccn-forwarder")
+		self.daemon = True
+
+		self._tmpdir = None
+		if sockname is None:
+			self._tmpdir = tempfile.mkdtemp(prefix = "pyccn-fwd-")
+			sockname = os.path.join(self._tmpdir, "ccnd.sock")
+		self.sockname = sockname
+
+		if key is None:
+			key = pyccn.Key()
+			key.generateRSA(1024)
+		self.key = key
+		self.ccndid = key.publicKeyID
+
+		self._listener = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+		self._listener.bind(sockname)
+		self._listener.listen(64)
+		self._listener.setblocking(False)
+		self._wake_r, self._wake_w = os.pipe()
+
+		self.faces = {} # fd -> Face
+		self.fib = {} # prefix -> set of faces
+		self.pit = {} # name -> {face: expiry}
+		self._next_faceid = 1
+		self.running = False
+
+		self.interests = 0
+		self.contents = 0
+		self.dropped = 0
+
+	def run(self):
+		self.running = True
+		last_purge = time.time()
+
+		while self.running:
+			wlist = [f.sock for f in self.faces.values() if f.outbuf]
+			rlist = [self._listener, self._wake_r]
+			rlist.extend(f.sock for f in self.faces.values())
+
+			r, w, x = select.select(rlist, wlist, [], 1.0)
+
+			for s in r:
+				if s is self._listener:
+					self._accept()
+				elif s is self._wake_r:
+					os.read(self._wake_r, 64)
+				else:
+					self._receive(self.faces.get(s.fileno()))
+
+			for s in w:
+				face = self.faces.get(s.fileno())
+				if face:
+					self._flush(face)
+
+			now = time.time()
+			if now - last_purge >= 1.0:
+				self._purge_pit(now)
+				last_purge = now
+
+		for face in list(self.faces.values()):
+			self._close(face)
+		self._listener.close()
+		os.close(self._wake_r)
+		os.close(self._wake_w)
+		if self._tmpdir:
+			shutil.rmtree(self._tmpdir, True)
+
+	def stop(self):
+		self.running = False
+		os.write(self._wake_w, b'x')
+		self.join()
+
+	def _accept(self):
+		try:
+			sock, addr = self._listener.accept()
+		except socket.error:
+			return
+
+		sock.setblocking(False)
+		face = Face(self._next_faceid, sock)
+		self._next_faceid += 1
+		self.faces[sock.fileno()] = face
+
+	def _close(self, face):
+		del self.faces[face.sock.fileno()]
+		face.sock.close()
+
+		for faces in self.fib.values():
+			faces.discard(face)
+		for entry in self.pit.values():
+			entry.pop(face, None)
+
+	def _receive(self, face):
+		if face is None:
+			return
+
+		try:
+			data = face.sock.recv(65536)
+		except socket.error:
+			data = None
+
+		if not data:
+			self._close(face)
+			return
+
+		face.inbuf.extend(data)
+		buf = face.inbuf
+
+		pos = 0
+		try:
+			while pos < len(buf):
+				end = element_end(buf, pos)
+				if end is None:
+					break
+				self._dispatch(face, bytes(buf[pos:end]))
+				pos = end
+		except (ValueError, IndexError, TypeError):
+			# framing is lost, nothing else to do with this face
+			self._close(face)
+			return
+
+		del buf[:pos]
+
+	def _send(self, face, message):
+		face.outbuf.extend(message)
+		self._flush(face)
+
+	def _flush(self, face):
+		try:
+			n = face.sock.send(face.outbuf)
+		except socket.error:
+			return
+		del face.outbuf[:n]
+
+	def _dispatch(self, face, message):
+		dtag = element_dtag(bytearray(message))
+
+		if dtag == DTAG_INTEREST:
+			self._on_interest(face, message)
+		elif dtag == DTAG_CONTENT_OBJECT:
+			self._on_content(face, message)
+		else:
+			self.dropped += 1
+
+	def _on_interest(self, face, message):
+		self.interests += 1
+		name = name_components(bytearray(message))
+
+		if name[:1] == (LOCALHOST,) or name[:2] == (b'ccnx', self.ccndid):
+			self._local_interest(face, name)
+			return
+
+		now = time.time()
+		entry = self.pit.setdefault(name, {})
+		pending = [f for f, expiry in entry.items() if expiry > now]
+		entry[face] = now + INTEREST_LIFETIME
+
+		# same interest is already on its way (unless it's a retransmission)
+		if pending and face not in pending:
+			return
+
+		for f in self._next_hops(name):
+			if f is not face:
+				self._send(f, message)
+
+	def _next_hops(self, name):
+		for i in range(len(name), -1, -1):
+			faces = self.fib.get(name[:i])
+			if faces:
+				return list(faces)
+		return list(self.faces.values())
+
+	def _on_content(self, face, message):
+		self.contents += 1
+		name = name_components(bytearray(message))
+		now = time.time()
+
+		faces = set()
+		for i in range(len(name) + 1):
+			entry = self.pit.pop(name[:i], None)
+			if entry:
+				faces.update(f for f, expiry in entry.items() if expiry > now)
+
+		if not faces:
+			self.dropped += 1
+			return
+
+		for f in faces:
+			if f is not face and f.sock.fileno() in self.faces:
+				self._send(f, message)
+
+	def _purge_pit(self, now):
+		for name in list(self.pit.keys()):
+			entry = self.pit[name]
+			for f in [f for f, expiry in entry.items() if expiry <= now]:
+				del entry[f]
+			if not entry:
+				del self.pit[name]
+
+	# ccnd's key (libccn asks for it to learn ccndid) and selfreg, the
+	# ForwardingEntry is sent back as is
+	def _local_interest(self, face, name):
+		if name[:1] == (LOCALHOST,):
+			content = self.key.publicToDER()
+			content_type = pyccn.CONTENT_KEY
+		elif len(name) == 4 and name[2] == SELFREG:
+			co = bytearray(name[3])
+			content = blob_value(co, find_child(co, 0, DTAG_CONTENT))
+			prefix = name_components(bytearray(content))
+			self.fib.setdefault(prefix, set()).add(face)
+			content_type = pyccn.CONTENT_DATA
+		else:
+			self.dropped += 1
+			return
+
+		si = pyccn.SignedInfo(self.key.publicKeyID,
+			pyccn.KeyLocator(self.key), type = content_type)
+		co = pyccn.ContentObject(pyccn.Name(list(name)), content, si)
+		co.sign(self.key)
+		self._send(face, _pyccn.dump_charbuf(co.ccn_data))
+
+if __name__ == '__main__':
+	import sys
+
+	fwd = Forwarder(sys.argv[1] if len(sys.argv) > 1 else None)
+	print(fwd.sockname)
+	sys.stdout.flush()
+
+	try:
+		fwd.run()
+	except KeyboardInterrupt:
+		pass
@@ -24,7 +24,25 @@ class Wrapper(object):
 
 		return co
 
+def _byte_view(data):
+	try:
+		view = memoryview(data)
+	except TypeError:
+		return data # e.g. mmap on Python 2
+
+	if view.ndim == 1 and view.itemsize == 1:
+		return view
+	elif hasattr(view, "cast"):
+		return view.cast("B")
+
+	return data
+
 def segmenter(data, wrapper = None, chunk_size = 4096):
+	# wrapped chunks are only read by sign(), slices of a memoryview spare
+	# copying them out of data (e.g. a large mmap)
+	if wrapper is not None:
+		data = _byte_view(data)
+
 	segment = 0
 	segments = math.ceil(len(data) / float(chunk_size))
 
@@ -0,0 +1,284 @@
+#
+# Copyright (c) 2026, Regents of the University of California
+# BSD license, See the COPYING file for more information
+#
+
+# End-to-end throughput of a producer/consumer pair on one machine, going
+# through the forwarder stand-in in pyccn.impl.forwarder (no ccnd needed):
+#
+#	python -m pyccn.throughput [--count N] [--window W] [--json FILE]
+#
+# Paths measured:
+#	get      - blocking get() one name at a time, answered by put()
+#	express  - expressInterest() with W interests outstanding, answered by
+#	           a setInterestFilter() closure
+#	segments - segmented fetch of a blob with get_many()
+#
+# Content is signed before the clock starts, so RSA isn't part of the
+# numbers (see pyccn.bench for that).
+
+from __future__ import print_function
+
+import json, platform, sys, threading, time
+
+import pyccn
+from pyccn.impl import segmenting
+from pyccn.impl.forwarder import Forwarder
+
+_timer = getattr(time, "perf_counter", time.time)
+
+PREFIX = "/pyccn/throughput"
+
+def percentile(values, p):
+	if not values:
+		return None
+	values = sorted(values)
+	i = int(round(p / 100.0 * (len(values) - 1)))
+	return values[i]
+
+def report(path, count, elapsed, rtts, nbytes, timeouts):
+	return {
+		"path": path,
+		"count": count,
+		"timeouts": timeouts,
+		"seconds": elapsed,
+		"interests_per_sec": count / elapsed if elapsed else None,
+		"mbps": nbytes * 8 / elapsed / 1e6 if elapsed else None,
+		"rtt_ms": dict(("p%d" % p, None if not rtts else
+			percentile(rtts, p) * 1000.0) for p in (50, 90, 99, 100))
+	}
+
+class Producer(pyccn.Closure):
+	def __init__(self, sockname):
+		self.handle = pyccn.CCN(sockname)
+		self.objects = {}
+		self.running = False
+		self.thread = None
+
+	def add(self, co):
+		self.objects[str(co.name)] = co
+
+	def upcall(self, kind, info):
+		if kind != pyccn.UPCALL_INTEREST:
+			return pyccn.RESULT_OK
+
+		co = self.objects.get(str(info.Interest.name))
+		if co is None:
+			return pyccn.RESULT_OK
+
+		self.handle.put(co)
+		return pyccn.RESULT_INTEREST_CONSUMED
+
+	def start(self):
+		self.handle.setInterestFilter(pyccn.Name(PREFIX), self)
+		self.running = True
+		self.thread = threading.Thread(target = self._loop)
+		self.thread.daemon = True
+		self.thread.start()
+
+	def _loop(self):
+		while self.running:
+			self.handle.run(100)
+
+	def stop(self):
+		self.running = False
+		self.thread.join()
+
+class Consumer(pyccn.Closure):
+	def __init__(self, handle, names, window, timeoutms):
+		self.handle = handle
+		self.names = names
+		self.window = window
+		self.template = pyccn.Interest(interestLifetime = timeoutms / 1000.0)
+		self.next = 0
+		self.done = 0
+		self.sent = {}
+		self.rtts = []
+		self.nbytes = 0
+		self.timeouts = 0
+
+	def _express(self):
+		if self.next >= len(self.names):
+			return
+
+		name = self.names[self.next]
+		self.next += 1
+		self.sent[str(name)] = _timer()
+		self.handle.expressInterest(name, self, self.template)
+
+	def upcall(self, kind, info):
+		if kind == pyccn.UPCALL_FINAL:
+			return pyccn.RESULT_OK
+
+		if kind == pyccn.UPCALL_INTEREST_TIMED_OUT:
+			self.timeouts += 1
+			self.sent.pop(str(info.Interest.name), None)
+		elif kind in (pyccn.UPCALL_CONTENT, pyccn.UPCALL_CONTENT_UNVERIFIED):
+			start = self.sent.pop(str(info.ContentObject.name), None)
+			if start is not None:
+				self.rtts.append(_timer() - start)
+			self.nbytes += len(info.ContentObject.content)
+		else:
+			return pyccn.RESULT_OK
+
+		self.done += 1
+		self._express()
+		return pyccn.RESULT_OK
+
+	def run(self):
+		for i in range(self.window):
+			self._express()
+
+		while self.done < len(self.names):
+			self.handle.run(100)
+
+def _sign(key, name, payload, signed_info):
+	co = pyccn.ContentObject(name, payload, signed_info)
+	co.sign(key)
+	return co
+
+def run_get(producer, consumer, key, si, count, payload, timeoutms):
+	names = [pyccn.Name("%s/get/%d" % (PREFIX, i)) for i in range(count)]
+	for name in names:
+		producer.add(_sign(key, name, payload, si))
+
+	rtts = []
+	nbytes = timeouts = 0
+	start = _timer()
+	for name in names:
+		t = _timer()
+		co = consumer.get(name, timeoutms = timeoutms)
+		if co is None:
+			timeouts += 1
+			continue
+		rtts.append(_timer() - t)
+		nbytes += len(co.content)
+	elapsed = _timer() - start
+
+	return report("get", count, elapsed, rtts, nbytes, timeouts)
+
+def run_express(producer, consumer, key, si, count, payload, window,
+		timeoutms):
+	names = [pyccn.Name("%s/express/%d" % (PREFIX, i)) for i in range(count)]
+	for name in names:
+		producer.add(_sign(key, name, payload, si))
+
+	c = Consumer(consumer, names, window, timeoutms)
+	start = _timer()
+	c.run()
+	elapsed = _timer() - start
+
+	return report("express", count, elapsed, c.rtts, c.nbytes, c.timeouts)
+
+def run_segments(producer, consumer, key, size, chunk, window, timeoutms):
+	name = pyccn.Name("%s/segments" % PREFIX)
+	wrapper = segmenting.Wrapper(name, key)
+	for co in segmenting.segmenter(b"\x5a" * size, wrapper, chunk):
+		producer.add(co)
+
+	names = [name + pyccn.Name.num2seg(i)
+		for i in range((size + chunk - 1) // chunk)]
+
+	start = _timer()
+	result = consumer.get_many(names, timeoutms, window)
+	elapsed = _timer() - start
+
+	nbytes = sum(len(co.content) for co in result if co is not None)
+	timeouts = sum(1 for co in result if co is None)
+
+	return report("segments", len(names), elapsed, [], nbytes, timeouts)
+
+def run(count = 2000, payload_size = 1024, window = 16, blob_size = 4 << 20,
+		chunk = 4096, timeoutms = 4000, paths = None, out = sys.stdout):
+	fwd = Forwarder()
+	fwd.start()
+
+	key = pyccn.Key()
+	key.generateRSA(1024)
+	si = pyccn.SignedInfo(key.publicKeyID, pyccn.KeyLocator(key))
+	payload = b"\x5a" * payload_size
+
+	producer = Producer(fwd.sockname)
+	producer.start()
+	consumer = pyccn.CCN(fwd.sockname)
+
+	# wait until the producer is reachable
+	warmup = pyccn.Name("%s/warmup" % PREFIX)
+	producer.add(_sign(key, warmup, payload, si))
+	if consumer.get(warmup, timeoutms = 10000) is None:
+		raise RuntimeError("producer isn't reachable through the forwarder")
+
+	results = []
+	try:
+		if not paths or "get" in paths:
+			results.append(run_get(producer, consumer, key, si, count,
+				payload, timeoutms))
+		if not paths or "express" in paths:
+			results.append(run_express(producer, consumer, key, si, count,
+				payload, window, timeoutms))
+		if not paths or "segments" in paths:
+			results.append(run_segments(producer, consumer, key, blob_size,
+				chunk, window, timeoutms))
+	finally:
+		producer.stop()
+		fwd.stop()
+
+	for r in results:
+		rtt = r["rtt_ms"]
+		print("%-10s %8.0f interests/s %8.2f Mbps  rtt p50 %s p99 %s  "
+			"timeouts %d" % (r["path"], r["interests_per_sec"], r["mbps"],
+			"-" if rtt["p50"] is None else "%.3fms" % rtt["p50"],
+			"-" if rtt["p99"] is None else "%.3fms" % rtt["p99"],
+			r["timeouts"]), file = out)
+
+	return {
+		"python": platform.python_version(),
+		"system": platform.platform(),
+		"time": time.time(),
+		"count": count,
+		"payload": payload_size,
+		"window": window,
+		"blob_size": blob_size,
+		"chunk": chunk,
+		"forwarder": {"interests": fwd.interests, "contents": fwd.contents,
+			"dropped": fwd.dropped},
+		"results": results
+	}
+
+def main(argv = None):
+	import argparse
+
+	parser = argparse.ArgumentParser(prog = "python -m pyccn.throughput",
+		description = "Producer/consumer throughput through a local forwarder")
+	parser.add_argument("--count", type = int, default = 2000,
+		help = "interests sent by the get and express paths")
+	parser.add_argument("--payload", type = int, default = 1024,
+		help = "content size in bytes for the get and express paths")
+	parser.add_argument("--window", type = int, default = 16,
+		help = "outstanding interests for the express and segments paths")
+	parser.add_argument("--blob", type = int, default = 4 << 20,
+		help = "size of the blob fetched by the segments path")
+	parser.add_argument("--chunk", type = int, default = 4096,
+		help = "segment size")
+	parser.add_argument("--timeout", type = int, default = 4000,
+		metavar = "MS", help = "interest lifetime")
+	parser.add_argument("--path", action = "append",
+		choices = ("get", "express", "segments"),
+		help = "run only this path (can be repeated)")
+	parser.add_argument("--json", metavar = "FILE",
+		help = "write results to FILE as JSON ('-' for stdout)")
+	args = parser.parse_args(argv)
+
+	result = run(args.count, args.payload, args.window, args.blob, args.chunk,
+		args.timeout, args.path, sys.stderr if args.json == "-" else sys.stdout)
+
+	if args.json == "-":
+		json.dump(result, sys.stdout, indent = 1)
+	elif args.json:
+		with open(args.json, "w") as f:
+			json.dump(result, f, indent = 1)
+
+	return 0
+
+if __name__ == "__main__":
+	sys.exit(main())
@@ -0,0 +1,48 @@
+#
+# Copyright (c) 2026, Regents of the University of California
+# BSD license, See the COPYING file for more information
+#
+
+# Tracing of the C module's hot paths (run, upcall and its parts, get, put,
+# encode, sign, verify). It's off by default and costs next to nothing then.
+#
+#	pyccn.trace.enable()
+#	...
+#	pyccn.trace.dump_chrome("trace.json")  # open in chrome://tracing
+
+from . import _pyccn
+import json, os
+
+def enable():
+	_pyccn.trace_enable(True)
+
+def disable():
+	_pyccn.trace_enable(False)
+
+def clear():
+	_pyccn.trace_clear()
+
+# list of (name, phase, timestamp in us, thread id), phase is 'B' or 'E'
+def events():
+	return _pyccn.trace_events()
+
+# events of exited threads that were dropped before events() returned them
+def dropped():
+	return _pyccn.trace_dropped()
+
+def chrome_trace():
+	pid = os.getpid()
+	return {
+		"traceEvents": [{"name": name, "ph": phase, "ts": ts, "pid": pid,
+			"tid": tid, "cat": "pyccn"} for name, phase, ts, tid in events()],
+		"displayTimeUnit": "ms"
+	}
+
+# f is a file name or an open file
+def dump_chrome(f):
+	if hasattr(f, "write"):
+		json.dump(chrome_trace(), f)
+		return
+
+	with open(f, "w") as fp:
+		json.dump(chrome_trace(), fp)
@@ -83,3 +83,52 @@ def py2ccn_time(value):
 	inttime = int(value * 4096 + 0.5)
 	bintime = struct.pack("!Q", inttime)
 	return bintime.lstrip(b'\x00')
+
+_upcall_kind_names = ('final', 'interest', 'consumed_interest', 'content',
+	'interest_timed_out', 'content_unverified', 'content_bad')
+
+# Formats CCN.stats() in Prometheus text exposition format, labels is
+# an optional dict added to every sample (e.g. {'handle': 'producer'})
+def stats_to_prometheus(stats, labels = None, prefix = "pyccn"):
+	def fmt_labels(extra = None):
+		l = dict(labels or {})
+		l.update(extra or {})
+		if not l:
+			return ""
+		return "{%s}" % ",".join('%s="%s"' % (k, str(v).replace('\\', '\\\\')
+			.replace('"', '\\"')) for k, v in sorted(l.items()))
+
+	lines = []
+	def counter(name, value, help, extra = None, header = True):
+		if header:
+			lines.append("# HELP %s_%s %s" % (prefix, name, help))
+			lines.append("# TYPE %s_%s counter" % (prefix, name))
+		lines.append("%s_%s%s %d" % (prefix, name, fmt_labels(extra), value))
+
+	counter("interests_expressed_total", stats['interests_expressed'],
+		"Interests expressed")
+	counter("interests_reexpressed_total", stats['reexpressed'],
+		"Interests re-expressed after a timeout")
+	counter("interest_timeouts_total", stats['timeouts'], "Interest timeouts")
+	counter("puts_total", stats['puts'], "ContentObjects put")
+	counter("put_bytes_total", stats['put_bytes'], "Bytes of ContentObjects put")
+
+	for kind, value in enumerate(stats['upcall_kinds']):
+		counter("ccn_upcalls_total", value, "Upcalls received from ccn by kind",
+			{'kind': _upcall_kind_names[kind]}, kind == 0)
+
+	# bucket i counts upcalls faster than 2^i us, last one is +Inf
+	name = "%s_upcall_duration_seconds" % prefix
+	lines.append("# HELP %s Time spent in Python upcalls" % name)
+	lines.append("# TYPE %s histogram" % name)
+	total = 0
+	buckets = stats['upcall_latency']
+	for i, value in enumerate(buckets):
+		total += value
+		le = "+Inf" if i == len(buckets) - 1 else repr((1 << i) / 1e6)
+		lines.append("%s_bucket%s %d" % (name, fmt_labels({'le': le}), total))
+	lines.append("%s_sum%s %r" % (name, fmt_labels(),
+		stats['upcall_latency_sum'] / 1e6))
+	lines.append("%s_count%s %d" % (name, fmt_labels(), stats['upcalls']))
+
+	return "\n".join(lines) + "\n"
@@ -0,0 +1,46 @@
+import pyccn
+import threading
+
+name = pyccn.Name("/pyccn/test/aggregate")
+
+class Producer(pyccn.Closure):
+	def __init__(self):
+		self.interests = 0
+
+	def upcall(self, kind, info):
+		if kind == pyccn.UPCALL_INTEREST:
+			self.interests += 1
+		return pyccn.RESULT_OK
+
+class Consumer(threading.Thread):
+	def __init__(self):
+		threading.Thread.__init__(self)
+		self.co = None
+
+	def run(self):
+		self.co = pyccn.CCN().get(name, timeoutms = 4000)
+
+k = pyccn.CCN.getDefaultKey()
+producer = Producer()
+
+handle = pyccn.CCN()
+handle.setInterestFilter(name, producer, aggregate = True)
+
+consumers = [Consumer() for i in range(3)]
+for c in consumers:
+	c.start()
+
+# let all interests arrive before we produce anything
+handle.run(1000)
+assert(producer.interests == 1)
+
+co = pyccn.ContentObject(name, "aggregated reply")
+co.signedInfo.publisherPublicKeyDigest = k.publicKeyID
+co.sign(k)
+handle.put(co)
+handle.run(500)
+
+for c in consumers:
+	c.join()
+	assert(c.co is not None)
+	assert(c.co.content == b"aggregated reply")
@@ -0,0 +1,60 @@
+import array, mmap, tempfile
+from pyccn import ContentObject, Name, Key, SignedInfo, _pyccn
+from pyccn.impl import segmenting
+
+k = Key()
+k.generateRSA(1024)
+si = SignedInfo(k.publicKeyID)
+
+payload = b"0123456789abcdef" * 1024
+
+def encoded(content):
+	co = ContentObject(Name("/buffer/test"), content, si)
+	co.sign(k)
+	return _pyccn.dump_charbuf(co.ccn_data)
+
+reference = encoded(payload)
+
+# buffers are kept as they are and read in place
+ba = bytearray(payload)
+co = ContentObject(Name("/buffer/test"), ba, si)
+assert co.content is ba
+
+view = memoryview(ba)
+assert encoded(ba) == reference
+assert encoded(view) == reference
+assert encoded(array.array("B", payload)) == reference
+
+# slices of a larger buffer aren't copied
+assert encoded(memoryview(b"xx" + payload + b"yy")[2:-2]) == reference
+
+f = tempfile.TemporaryFile()
+f.write(payload)
+f.flush()
+m = mmap.mmap(f.fileno(), 0)
+assert encoded(m) == reference
+
+# text is still encoded, empty content still works
+assert encoded(payload.decode("ascii")) == reference
+co = ContentObject(Name("/buffer/test"), None, si)
+co.sign(k)
+co2 = _pyccn.ContentObject_obj_from_ccn(co.ccn_data)
+assert not co2.content
+
+# segmenting an mmap
+wrapper = segmenting.Wrapper(Name("/buffer/segments"), k)
+segments = list(segmenting.segmenter(m, wrapper, 4096))
+assert len(segments) == 4
+received = b"".join(_pyccn.ContentObject_obj_from_ccn(co.ccn_data).content
+	for co in segments)
+assert received == payload
+
+# segments read the mmap in place, it can't be closed while their views
+# exist (BufferError on Python 3)
+for co in segments:
+	if hasattr(co.content, "release"):
+		co.content.release()
+del segments, co
+
+m.close()
+f.close()
@@ -0,0 +1,67 @@
+from pyccn import CCN, ContentObject, Name, Key, SignedInfo, DIGEST_SHA256, \
+	HMAC_SHA256, _pyccn
+
+k = Key()
+k.generateRSA(1024)
+
+def content_object(alg):
+	co = ContentObject(Name("/digest/test"), b"payload", SignedInfo())
+	co.digestAlgorithm = alg
+	return co
+
+def tampered(co):
+	data = bytearray(_pyccn.dump_charbuf(co.ccn_data))
+	i = data.index(b"payload")
+	data[i] ^= 1
+	return _pyccn.ContentObject_obj_from_ccn(
+		_pyccn.new_charbuf("ContentObject_ccn_data", bytes(data)))
+
+# digest only, no key needed on either side
+co = content_object(DIGEST_SHA256)
+co.sign()
+co2 = _pyccn.ContentObject_obj_from_ccn(co.ccn_data)
+assert co2.digestAlgorithm == DIGEST_SHA256
+assert co2.signature.digestAlgorithm == DIGEST_SHA256
+assert len(co2.signature.signatureBits) == 32
+assert co2.verify_signature()
+assert not tampered(co).verify_signature()
+
+# anyone can make one, so it isn't accepted in place of a signature
+assert not co2.verify_signature(k)
+assert not co2.verify_signature(b"secret")
+handle = CCN()
+assert not co2.verify_content(handle)
+
+# HMAC with a shared secret
+secret = b"cluster secret"
+co = content_object(HMAC_SHA256)
+co.sign(secret)
+co2 = _pyccn.ContentObject_obj_from_ccn(co.ccn_data)
+assert co2.digestAlgorithm == HMAC_SHA256
+assert co2.verify_signature(secret)
+assert not co2.verify_signature(b"other secret")
+assert not tampered(co).verify_signature(secret)
+
+assert not co2.verify_signature(k)
+assert not co2.verify_content(handle)
+
+try:
+	content_object(HMAC_SHA256).sign(k)
+except TypeError:
+	pass
+else:
+	raise AssertionError("HMAC needs a shared secret")
+
+# regular signatures are unaffected
+co = content_object(None)
+co.sign(k)
+co2 = _pyccn.ContentObject_obj_from_ccn(co.ccn_data)
+assert co2.digestAlgorithm is None
+assert co2.verify_signature(k)
+
+try:
+	content_object("1.2.3.4").sign(k)
+except NotImplementedError:
+	pass
+else:
+	raise AssertionError("unknown algorithm should be refused")
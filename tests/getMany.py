@@ -0,0 +1,48 @@
+import pyccn
+
+prefix = pyccn.Name("/pyccn/test/get_many")
+k = pyccn.CCN.getDefaultKey()
+
+class Producer(pyccn.Closure):
+	def upcall(self, kind, info):
+		if kind != pyccn.UPCALL_INTEREST:
+			return pyccn.RESULT_OK
+
+		name = info.Interest.name
+		if name[-1] == b"missing":
+			return pyccn.RESULT_OK
+
+		co = pyccn.ContentObject(name, name[-1])
+		co.signedInfo.publisherPublicKeyDigest = k.publicKeyID
+		co.sign(k)
+		producer.put(co)
+		return pyccn.RESULT_INTEREST_CONSUMED
+
+producer = pyccn.CCN()
+producer.setInterestFilter(prefix, Producer())
+
+import threading
+t = threading.Thread(target = producer.run, args = (5000,))
+t.start()
+
+names = [prefix.append(str(i)) for i in range(20)]
+names.insert(5, prefix.append("missing"))
+names.append(pyccn.Interest(name = prefix.append("last")))
+
+c = pyccn.CCN()
+res = c.get_many(names, timeoutms = 1000, max_outstanding = 4)
+
+producer.setRunTimeout(0)
+t.join()
+
+assert(len(res) == len(names))
+assert(res[5] is None)
+del names[5]
+del res[5]
+for i, co in enumerate(res[:-1]):
+	assert(co is not None)
+	assert(co.name == names[i])
+	assert(co.content == str(i).encode())
+assert(res[-1].content == b"last")
+
+assert(c.get_many([]) == [])
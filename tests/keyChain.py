@@ -0,0 +1,90 @@
+import threading, time
+from pyccn import ContentObject, Key, KeyChain, KeyLocator, Name, SignedInfo, \
+	CONTENT_KEY, DIGEST_SHA256, _pyccn
+
+# KeyName with a digest survives the round trip
+locator = KeyLocator(Name("/publisher/KEY"))
+locator.keyNameDigest = b"\x01" * 32
+parsed = _pyccn.KeyLocator_obj_from_ccn(locator.ccn_data)
+assert str(parsed.keyName) == "/publisher/KEY"
+assert parsed.keyNameDigest == b"\x01" * 32
+
+publisher = Key()
+publisher.generateRSA(1024)
+
+def publish(key, content, locator):
+	co = ContentObject(Name("/publisher/data"), content,
+		SignedInfo(key.publicKeyID, locator))
+	co.sign(key)
+	return co
+
+# stands in for a CCN handle, serves the publisher's key slowly
+class Handle(object):
+	def __init__(self):
+		self.fetches = 0
+
+	def get(self, name, template, timeoutms):
+		self.fetches += 1
+		time.sleep(0.2)
+		if str(name) != "/publisher/KEY":
+			return None
+		return ContentObject(name, publisher.publicToDER(),
+			SignedInfo(publisher.publicKeyID, type = CONTENT_KEY))
+
+handle = Handle()
+chain = KeyChain(handle, capacity = 2, negative_ttl = 60)
+
+# embedded key
+co = publish(publisher, b"embedded", KeyLocator(publisher))
+assert chain.verify(co)
+assert chain.find(publisher.publicKeyID) is not None
+chain.clear()
+
+# named key, concurrent lookups share one fetch
+co = publish(publisher, b"named", KeyLocator(Name("/publisher/KEY")))
+results = []
+threads = [threading.Thread(target = lambda: results.append(chain.verify(co)))
+	for i in range(4)]
+for t in threads:
+	t.start()
+for t in threads:
+	t.join()
+assert results == [True] * 4
+assert handle.fetches == 1
+assert chain.stats()["coalesced"] == 3
+
+# now cached
+assert chain.verify(co)
+assert handle.fetches == 1
+
+# digest-only object naming a known key isn't signed by it
+co = ContentObject(Name("/publisher/data"), b"digest",
+	SignedInfo(publisher.publicKeyID, KeyLocator(publisher)))
+co.digestAlgorithm = DIGEST_SHA256
+co.sign()
+co = _pyccn.ContentObject_obj_from_ccn(co.ccn_data)
+assert chain.lookup(co) is not None
+assert not chain.verify(co)
+
+# key that can't be fetched is looked up only once
+other = Key()
+other.generateRSA(1024)
+co = publish(other, b"missing", KeyLocator(Name("/nobody/KEY")))
+assert not chain.verify(co)
+assert not chain.verify(co)
+assert handle.fetches == 2
+assert chain.stats()["negative_hits"] == 1
+
+# embedded key not matching the signer's digest is ignored
+co = publish(other, b"forged", KeyLocator(publisher))
+co.signedInfo.publisherPublicKeyDigest = other.publicKeyID
+assert chain.lookup(co) is None
+
+# least recently used key is dropped
+keys = [Key() for i in range(3)]
+for key in keys:
+	key.generateEC("prime256v1")
+	chain.add(key)
+assert len(chain) == 2
+assert chain.find(keys[0].publicKeyID) is None
+assert chain.find(keys[2].publicKeyID) is not None
@@ -0,0 +1,58 @@
+import pyccn
+from pyccn import Key, KeyLocator, ContentObject, SignedInfo, Name, _pyccn
+
+k = Key()
+k.generateEC()
+assert(k.type == "EC")
+assert(len(k.publicKeyID) == 32)
+
+# PEM and DER round trip, publicKeyID doesn't depend on the encoding
+
+private = k.privateToPEM()
+public = k.publicToPEM()
+
+k2 = Key()
+k2.fromPEM(private=private)
+assert(k.privateToDER() == k2.privateToDER())
+assert(k.publicToDER() == k2.publicToDER())
+assert(k.publicKeyID == k2.publicKeyID)
+
+k2 = Key()
+k2.fromPEM(public=public)
+assert(k.publicToDER() == k2.publicToDER())
+assert(k.publicKeyID == k2.publicKeyID)
+
+try:
+	k2.privateToPEM()
+except:
+	pass
+else:
+	raise AssertionError("This should fail - this is not a private key")
+
+k2 = Key()
+k2.fromDER(private=k.privateToDER())
+assert(k.publicKeyID == k2.publicKeyID)
+
+k2 = Key()
+k2.fromDER(public=k.publicToDER())
+assert(k.publicKeyID == k2.publicKeyID)
+
+# embedded in KeyLocator
+
+locator = _pyccn.KeyLocator_obj_from_ccn(KeyLocator(k).ccn_data)
+assert(locator.key.publicToDER() == k.publicToDER())
+assert(locator.key.publicKeyID == k.publicKeyID)
+
+# signing and verification
+
+si = SignedInfo(k.publicKeyID, KeyLocator(k))
+co = ContentObject(Name("/test/ec"), "hello!", si)
+co.sign(k)
+assert(co.verify_signature(k))
+
+co2 = _pyccn.ContentObject_obj_from_ccn(co.ccn_data)
+assert(co2.verify_signature(locator.key))
+
+k3 = Key()
+k3.generateEC()
+assert(not co2.verify_signature(k3))
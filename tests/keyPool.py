@@ -0,0 +1,68 @@
+import threading, time
+from pyccn import KeyPool
+
+pool = KeyPool({("RSA", 1024): 3, ("EC", "prime256v1"): 2}, threads = 2)
+assert pool.fill(timeout = 60)
+
+stats = pool.stats()
+assert stats["RSA-1024"]["available"] == 3
+assert stats["EC-prime256v1"]["available"] == 2
+
+ids = set()
+for i in range(3):
+	key = pool.get(("RSA", 1024))
+	assert key.type == "RSA"
+	ids.add(key.publicKeyID)
+key = pool.get(("EC", "prime256v1"))
+assert key.type == "EC"
+ids.add(key.publicKeyID)
+
+# every key is handed out only once
+assert len(ids) == 4
+
+stats = pool.stats()
+assert stats["RSA-1024"]["handed_out"] == 3
+assert stats["RSA-1024"]["misses"] == 0
+assert stats["RSA-1024"]["wait_ms"]["max"] is not None
+
+# refilled in the background
+assert pool.fill(timeout = 60)
+assert pool.stats()["RSA-1024"]["available"] == 3
+
+try:
+	pool.get()
+except ValueError:
+	pass
+else:
+	raise AssertionError("pool has more types, get() needs one")
+
+try:
+	pool.get(("RSA", 4096))
+except ValueError:
+	pass
+else:
+	raise AssertionError("type not in the pool")
+
+pool.close()
+
+# running dry still gives a key, it's counted as a miss
+with KeyPool({("EC", "prime256v1"): 0}) as pool:
+	key = pool.get()
+	assert key.type == "EC"
+	assert pool.stats()["EC-prime256v1"]["misses"] == 1
+
+# fill() doesn't wait for keys that can't be generated
+with KeyPool({("EC", "no-such-curve"): 1}) as pool:
+	try:
+		pool.fill(timeout = 60)
+	except ValueError:
+		pass
+	else:
+		raise AssertionError("generation can't succeed")
+	assert pool.stats()["EC-no-such-curve"]["failed"]
+	assert pool.errors >= 5
+
+# nor on a closed pool
+pool = KeyPool({("RSA", 1024): 1000})
+threading.Timer(0.5, pool.close).start()
+assert not pool.fill()
@@ -0,0 +1,33 @@
+import pyccn
+import pyccn._pyccn as _pyccn
+
+k = pyccn.CCN.getDefaultKey()
+
+co = pyccn.ContentObject()
+co.name = pyccn.Name('/lazy/content/object')
+co.content = "lazy content"
+co.signedInfo.publisherPublicKeyDigest = k.publicKeyID
+co.signedInfo.freshnessSeconds = 30
+co.sign(k)
+
+co2 = _pyccn.ContentObject_obj_from_ccn(co.ccn_data)
+assert(co2._lazy == set(pyccn.ContentObject._lazy_fields))
+
+assert(co2.name == co.name)
+assert(co2._lazy == set(['content', 'signedInfo', 'signature']))
+
+assert(co2.content == co.content)
+assert(co2.signedInfo.publisherPublicKeyDigest == k.publicKeyID)
+assert(co2.signedInfo.freshnessSeconds == 30)
+assert(co2.signature.signatureBits)
+assert(not co2._lazy)
+assert(not co2.ccn_data_dirty)
+
+# overwriting a field that wasn't decoded yet must not bring the old value back
+co3 = _pyccn.ContentObject_obj_from_ccn(co.ccn_data)
+co3.content = "replaced"
+assert(co3.content == b"replaced")
+assert(co3.ccn_data_dirty)
+co3.sign(k)
+assert(co3.name == co.name)
+assert(_pyccn.ContentObject_obj_from_ccn(co3.ccn_data).content == b"replaced")
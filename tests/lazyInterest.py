@@ -0,0 +1,33 @@
+from pyccn import Interest, Name, _pyccn
+
+i = Interest()
+i.name = Name('/lazy/interest')
+i.minSuffixComponents = 1
+i.scope = 2
+i.interestLifetime = 8.0
+i.nonce = b'nonce'
+
+i2 = _pyccn.Interest_obj_from_ccn(i.ccn_data)
+assert(i2._lazy == set(Interest._lazy_fields))
+assert(not i2.ccn_data_dirty)
+
+assert(i2.scope == 2)
+assert(i2._lazy == set(Interest._lazy_fields) - set(['scope']))
+
+assert(i2.maxSuffixComponents is None)
+assert(i2.exclude is None)
+assert(i2.nonce == b'nonce')
+
+# the name shares the interest buffer, it must outlive the interest
+n = i2.name
+del i2
+assert(n == i.name)
+assert(str(n) == str(i.name))
+
+i3 = _pyccn.Interest_obj_from_ccn(i.ccn_data)
+i3.childSelector = 1
+assert(i3.ccn_data_dirty)
+i4 = _pyccn.Interest_obj_from_ccn(i3.ccn_data)
+assert(i4.childSelector == 1)
+assert(i4.minSuffixComponents == 1)
+assert(i4.interestLifetime == 8.0)
@@ -0,0 +1,48 @@
+import pyccn
+from pyccn.impl.forwarder import Forwarder
+import threading
+
+fwd = Forwarder()
+fwd.start()
+
+prefix = pyccn.Name("/pyccn/test/forwarder")
+k = pyccn.Key()
+k.generateRSA(1024)
+
+class Producer(pyccn.Closure):
+	def upcall(self, kind, info):
+		if kind != pyccn.UPCALL_INTEREST:
+			return pyccn.RESULT_OK
+
+		name = info.Interest.name
+		co = pyccn.ContentObject(name, name[-1])
+		co.signedInfo.publisherPublicKeyDigest = k.publicKeyID
+		co.sign(k)
+		producer.put(co)
+		return pyccn.RESULT_INTEREST_CONSUMED
+
+producer = pyccn.CCN(fwd.sockname)
+producer.setInterestFilter(prefix, Producer())
+
+t = threading.Thread(target = producer.run, args = (5000,))
+t.start()
+
+c = pyccn.CCN(fwd.sockname)
+co = c.get(prefix.append("hello"), timeoutms = 4000)
+print(co)
+assert co.content == b"hello"
+
+res = c.get_many([prefix.append(str(i)) for i in range(10)], timeoutms = 2000)
+assert [r.content for r in res] == [str(i).encode() for i in range(10)]
+
+# nobody answers this one
+co = c.get(pyccn.Name("/pyccn/test/nothing_here"), timeoutms = 200)
+assert co is None
+
+producer.setRunTimeout(0)
+t.join()
+
+print(fwd.fib.keys())
+assert (b"pyccn", b"test", b"forwarder") in fwd.fib
+
+fwd.stop()
@@ -0,0 +1,26 @@
+import pyccn
+
+k = pyccn.CCN.getDefaultKey()
+
+co = pyccn.ContentObject()
+co.name = pyccn.Name('/match/many/%00')
+co.content = "segment 0"
+co.signedInfo.publisherPublicKeyDigest = k.publicKeyID
+co.sign(k)
+
+interests = [
+	pyccn.Interest(name = pyccn.Name('/match/many')),
+	pyccn.Interest(name = pyccn.Name('/match/other')),
+	pyccn.Interest(name = pyccn.Name('/match')),
+	pyccn.Interest(name = pyccn.Name('/match/many'), minSuffixComponents = 3),
+	pyccn.Interest(name = pyccn.Name('/match/many/%00'),
+		publisherPublicKeyDigest = k.publicKeyID)]
+
+expected = [i for i, interest in enumerate(interests)
+	if co.matchesInterest(interest)]
+assert(expected == [0, 2, 4])
+
+assert(co.matchesInterests(interests) == expected)
+assert(co.matchesInterests([i.ccn_data for i in interests]) == expected)
+assert(co.matchingInterests(interests) == [interests[i] for i in expected])
+assert(co.matchesInterests([]) == [])
@@ -0,0 +1,62 @@
+from pyccn import ContentObject, Name, Key, SignedInfo, sign_aggregated, \
+	verify_aggregated, _pyccn
+
+k = Key()
+k.generateRSA(1024)
+
+k2 = Key()
+k2.generateRSA(1024)
+
+def objects(count):
+	si = SignedInfo(k.publicKeyID)
+	return [ContentObject(Name("/merkle/%d" % i), ("chunk %d" % i).encode(), si)
+		for i in range(count)]
+
+for count in (1, 2, 3, 7, 64):
+	objs = objects(count)
+	sign_aggregated(objs, k)
+
+	assert verify_aggregated(objs, k)
+	assert not verify_aggregated(objs, k2)
+
+	# each one is verifiable without the others
+	for co in objs:
+		assert co.verify_signature(k)
+		assert not co.verify_signature(k2)
+
+	co = _pyccn.ContentObject_obj_from_ccn(objs[-1].ccn_data)
+	assert str(co.name) == "/merkle/%d" % (count - 1)
+	assert co.content == ("chunk %d" % (count - 1)).encode()
+	assert co.signature.witness
+
+# objects from different trees don't verify together
+a, b = objects(4), objects(4)
+sign_aggregated(a, k)
+sign_aggregated(b, k)
+assert not verify_aggregated(a[:2] + b[2:], k)
+
+# tampered object fails, the rest of the tree is still fine
+objs = objects(5)
+sign_aggregated(objs, k)
+data = bytearray(_pyccn.dump_charbuf(objs[2].ccn_data))
+i = data.index(b"chunk 2")
+data[i] ^= 1
+bad = _pyccn.ContentObject_obj_from_ccn(_pyccn.new_charbuf("ContentObject_ccn_data",
+	bytes(data)))
+assert not bad.verify_signature(k)
+assert objs[1].verify_signature(k)
+
+# EC keys work too
+ec = Key()
+ec.generateEC()
+objs = objects(9)
+sign_aggregated(objs, ec)
+assert verify_aggregated(objs, ec)
+assert objs[4].verify_signature(ec)
+
+try:
+	sign_aggregated([], k)
+except ValueError:
+	pass
+else:
+	raise AssertionError("empty set shouldn't be signed")
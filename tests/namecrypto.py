@@ -34,6 +34,57 @@ ret = NameCrypto.verify_command(state2, name_from_js, window, fixture_key=secret
 print ret
 assert(ret == True)
 
+# Test signer (symmetric, key set up once)
+
+signer = NameCrypto.Signer.from_fixture_key(secret, app_name)
+state2 = NameCrypto.new_state()
+
+auth_name = signer.authenticate(name)
+ret = NameCrypto.verify_command(state2, auth_name, window, fixture_key=secret)
+assert(ret == True)
+
+names = [name.append(str(i)) for i in range(100)]
+auth_names = signer.authenticate_many(names)
+assert(len(auth_names) == len(names))
+for n, auth_n in zip(names, auth_names):
+	assert(auth_n.components[:-1] == n.components)
+	ret = NameCrypto.verify_command(state2, auth_n, window, fixture_key=secret)
+	assert(ret == True)
+
+# replaying fails
+ret = NameCrypto.verify_command(state2, auth_names[0], window, fixture_key=secret)
+assert(ret != True)
+
+# Test verifier table (many applications, commands out of order)
+
+verifier = NameCrypto.new_verifier(max_apps = 2, window = 64)
+auth_names = signer.authenticate_many(names[:10])
+for auth_n in reversed(auth_names):
+	ret = NameCrypto.verify_command(verifier, auth_n, window, fixture_key=secret)
+	assert(ret == True)
+
+for auth_n in auth_names:
+	ret = NameCrypto.verify_command(verifier, auth_n, window, fixture_key=secret)
+	assert(ret != True)
+
+# tampered command doesn't use up its sequence number
+auth_n = signer.authenticate(name)
+comps = auth_n.components[:]
+comps[-1] = comps[-1][:-1] + (b'\x00' if comps[-1][-1:] != b'\x00' else b'\x01')
+ret = NameCrypto.verify_command(verifier, Name(comps), window, fixture_key=secret)
+assert(ret != True)
+ret = NameCrypto.verify_command(verifier, auth_n, window, fixture_key=secret)
+assert(ret == True)
+
+for other in ('other1', 'other2'):
+	s = NameCrypto.Signer.from_fixture_key(secret, other)
+	ret = NameCrypto.verify_command(verifier, s.authenticate(name), window, fixture_key=secret)
+	assert(ret == True)
+
+stats = NameCrypto.verifier_stats(verifier)
+print stats
+assert(stats['apps'] == 2 and stats['evictions'] == 1)
+
 # Test asymmetric authentication
 
 state = NameCrypto.new_state()
@@ -70,3 +121,23 @@ ret = NameCrypto.verify_command(state3, name_from_js2, window, pub_key=keyLoc2.k
 print ret
 assert(ret == True)
 
+
+# Test key cache (key is converted once, looked up by its id)
+
+key_cache = NameCrypto.new_key_cache()
+key_id = NameCrypto.key_cache_add(key_cache, key)
+assert(key_id == key.publicKeyID)
+assert(NameCrypto.key_cache_add(key_cache, key) == key_id)
+
+state = NameCrypto.new_state()
+state2 = NameCrypto.new_state()
+for i in range(3):
+	auth_name = NameCrypto.authenticate_command_sig(state, name, app_name, key)
+	ret = NameCrypto.verify_command(state2, auth_name, window, key_cache=key_cache, key_id=key_id)
+	assert(ret == True)
+
+auth_name = NameCrypto.authenticate_command_sig(state, name, app_name, key)
+assert(NameCrypto.key_cache_remove(key_cache, key_id))
+ret = NameCrypto.verify_command(state2, auth_name, window, key_cache=key_cache, key_id=key_id)
+assert(ret != True)
+assert(not NameCrypto.key_cache_remove(key_cache, key_id))
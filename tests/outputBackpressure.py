@@ -0,0 +1,50 @@
+import pyccn
+import time
+
+prefix = pyccn.Name("/pyccn/test/backpressure")
+k = pyccn.CCN.getDefaultKey()
+
+handle = pyccn.CCN()
+assert handle.pending_output_bytes() == 0
+assert not handle.output_is_blocked()
+
+try:
+	handle.setOutputWatermarks(2048, 1024)
+except ValueError:
+	pass
+else:
+	raise AssertionError("low watermark above the high one was accepted")
+
+objects = []
+for i in range(500):
+	co = pyccn.ContentObject(prefix.append(str(i)), b"x" * 4096)
+	co.signedInfo.publisherPublicKeyDigest = k.publicKeyID
+	co.sign(k)
+	objects.append(co)
+
+drained = []
+handle.setOutputWatermarks(0, 64 * 1024)
+handle.setWritableCallback(lambda: drained.append(handle.pending_output_bytes()))
+
+# nothing sends queued objects until run()
+blocked = False
+for co in objects:
+	handle.put(co)
+	blocked = blocked or handle.output_is_blocked()
+
+assert handle.output_is_blocked() == (handle.pending_output_bytes() > 64 * 1024)
+
+deadline = time.time() + 10
+while handle.output_is_pending() and time.time() < deadline:
+	handle.run(100)
+
+assert not handle.output_is_pending()
+assert handle.pending_output_bytes() == 0
+assert not handle.output_is_blocked()
+
+# called once, when everything got out
+if blocked:
+	assert drained == [0]
+
+handle.setWritableCallback(None)
+assert handle.stats()["puts"] == len(objects)
@@ -0,0 +1,44 @@
+import pyccn
+from pyccn import _pyccn
+
+prefix = pyccn.Name("/pyccn/test/put_many")
+k = pyccn.CCN.getDefaultKey()
+
+class Producer(pyccn.Closure):
+	def upcall(self, kind, info):
+		return pyccn.RESULT_OK
+
+handle = pyccn.CCN()
+handle.setInterestFilter(prefix, Producer())
+
+objects = []
+for i in range(50):
+	co = pyccn.ContentObject(prefix.append(str(i)), str(i) * 100)
+	co.signedInfo.publisherPublicKeyDigest = k.publicKeyID
+	co.sign(k)
+	objects.append(co)
+
+accepted, pending = handle.put_many(objects)
+assert accepted + pending == len(objects)
+
+# anything left pending is sent as the socket drains
+handle.run(100)
+assert not handle.output_is_pending()
+
+assert handle.stats()["puts"] == len(objects)
+
+c = pyccn.CCN()
+for i in (0, 1, 25, 49):
+	co = c.get(prefix.append(str(i)), timeoutms = 2000)
+	assert co is not None
+	assert co.content == (str(i) * 100).encode()
+
+# not encoded yet
+try:
+	handle.put_many([pyccn.ContentObject(prefix.append("x"), "x")])
+except _pyccn.CCNContentObjectError:
+	pass
+else:
+	raise AssertionError("put_many() took an unsigned object")
+
+assert handle.put_many([]) == (0, 0)
@@ -0,0 +1,42 @@
+import pyccn
+import time
+
+class MyClosure(pyccn.Closure):
+	def __init__(self):
+		self.kinds = []
+
+	def upcall(self, kind, upcallInfo):
+		self.kinds.append(kind)
+		return pyccn.RESULT_OK
+
+n = pyccn.Name("/pyccn/test/retry/nobody/answers/this")
+i = pyccn.Interest(interestLifetime = 0.5)
+
+# retries should be handled in C, closure only sees the final timeout
+closure = MyClosure()
+retry = pyccn.RetryPolicy(retries = 2, backoffms = 100, jitter = 0.1)
+
+c = pyccn.CCN()
+start = time.time()
+c.expressInterest(n, closure, i, retry)
+while pyccn.UPCALL_FINAL not in closure.kinds and time.time() - start < 10:
+	c.run(100)
+elapsed = time.time() - start
+
+print(closure.kinds)
+assert(closure.kinds == [pyccn.UPCALL_INTEREST_TIMED_OUT, pyccn.UPCALL_FINAL])
+# three lifetimes plus 100 and 200 ms of backoff
+assert(elapsed >= 1.5)
+
+# deadline stops retries early
+closure = MyClosure()
+retry = pyccn.RetryPolicy(retries = 10, deadlinems = 800)
+
+start = time.time()
+c.expressInterest(n, closure, i, retry)
+while pyccn.UPCALL_FINAL not in closure.kinds and time.time() - start < 10:
+	c.run(100)
+elapsed = time.time() - start
+
+assert(closure.kinds == [pyccn.UPCALL_INTEREST_TIMED_OUT, pyccn.UPCALL_FINAL])
+assert(elapsed < 3)
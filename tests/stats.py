@@ -0,0 +1,35 @@
+import pyccn
+from pyccn import utils
+
+c = pyccn.CCN()
+
+s = c.stats()
+assert(s['puts'] == 0)
+assert(s['interests_expressed'] == 0)
+assert(len(s['upcall_latency']) > 0)
+
+k = pyccn.CCN.getDefaultKey()
+co = pyccn.ContentObject(pyccn.Name("/pyccn/test/stats"), "stats")
+co.signedInfo.publisherPublicKeyDigest = k.publicKeyID
+co.sign(k)
+c.put(co)
+
+n = pyccn.Name("/pyccn/test/stats/nobody/answers/this")
+assert(c.get(n, timeoutms = 100) is None)
+
+s = c.stats()
+print(s)
+assert(s['puts'] == 1)
+assert(s['put_bytes'] > len(co.content))
+assert(s['interests_expressed'] == 1)
+assert(s['timeouts'] == 1)
+
+text = utils.stats_to_prometheus(s, {'handle': 'test'})
+print(text)
+assert('pyccn_puts_total{handle="test"} 1\n' in text)
+assert('pyccn_upcall_duration_seconds_count{handle="test"} 0\n' in text)
+
+c.resetStats()
+s = c.stats()
+assert(s['puts'] == 0)
+assert(s['put_bytes'] == 0)
@@ -0,0 +1,39 @@
+import pyccn
+import threading
+
+prefix = pyccn.Name("/pyccn/test/submit")
+k = pyccn.CCN.getDefaultKey()
+
+handle = pyccn.CCN()
+loop = threading.Thread(target = handle.run, args = (-1,))
+loop.start()
+
+# run() is executing in other thread, these get queued
+class Producer(pyccn.Closure):
+	def upcall(self, kind, info):
+		return pyccn.RESULT_OK
+
+handle.setInterestFilter(prefix, Producer())
+
+def worker(i):
+	co = pyccn.ContentObject(prefix.append(str(i)), str(i))
+	co.signedInfo.publisherPublicKeyDigest = k.publicKeyID
+	co.sign(k)
+	handle.put(co)
+
+workers = [threading.Thread(target = worker, args = (i,)) for i in range(8)]
+for w in workers:
+	w.start()
+for w in workers:
+	w.join()
+
+c = pyccn.CCN()
+for i in range(8):
+	co = c.get(prefix.append(str(i)), timeoutms = 2000)
+	assert(co is not None)
+	assert(co.content == str(i).encode())
+
+# stopping works from other thread too
+handle.setRunTimeout(0)
+loop.join(5)
+assert(not loop.is_alive())
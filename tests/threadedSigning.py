@@ -0,0 +1,50 @@
+import threading
+import pyccn
+
+# signing, verification and key generation release the GIL, make sure they
+# give correct results when called from many threads at once
+
+THREADS = 8
+ROUNDS = 50
+
+k = pyccn.Key()
+k.generateRSA(1024)
+
+ec = pyccn.Key()
+ec.generateEC()
+
+errors = []
+
+def worker(i):
+	try:
+		for j in range(ROUNDS):
+			key = k if j % 2 else ec
+			co = pyccn.ContentObject(pyccn.Name("/threads/%d/%d" % (i, j)),
+				b"x" * (j * 100), pyccn.SignedInfo(key.publicKeyID))
+			co.sign(key)
+			assert co.verify_signature(key)
+			assert not co.verify_signature(ec if key is k else k)
+			assert len(co.digest()) == 32
+
+			co2 = pyccn.ContentObject(co.name, co.content, co.signedInfo)
+			co2.digestAlgorithm = pyccn.DIGEST_SHA256
+			co2.sign()
+			assert co2.verify_signature()
+
+		generated = pyccn.Key()
+		generated.generateRSA(1024)
+		loaded = pyccn.Key()
+		loaded.fromPEM(private = generated.privateToPEM())
+		assert loaded.publicKeyID == generated.publicKeyID
+		assert loaded.publicToDER() == generated.publicToDER()
+	except Exception as e:
+		errors.append(e)
+
+threads = [threading.Thread(target = worker, args = (i,))
+	for i in range(THREADS)]
+for t in threads:
+	t.start()
+for t in threads:
+	t.join()
+
+assert not errors, errors
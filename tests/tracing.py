@@ -0,0 +1,47 @@
+import pyccn
+from pyccn import trace
+import json, threading
+
+k = pyccn.CCN.getDefaultKey()
+
+def sign():
+	co = pyccn.ContentObject(pyccn.Name("/pyccn/test/trace"), "trace")
+	co.signedInfo.publisherPublicKeyDigest = k.publicKeyID
+	co.sign(k)
+	return co
+
+trace.clear()
+sign()
+assert(len(trace.events()) == 0)
+
+trace.enable()
+co = sign()
+co.verify_signature(k)
+trace.disable()
+sign()
+
+events = trace.events()
+print(events)
+names = [e[0] for e in events]
+assert(names.count("encode") == 2)
+assert(names.count("sign") == 2)
+assert(names.count("verify") == 2)
+assert([e[1] for e in events if e[0] == "sign"] == ["B", "E"])
+
+t = json.loads(json.dumps(trace.chrome_trace()))
+assert(len(t["traceEvents"]) == len(events))
+
+trace.clear()
+assert(len(trace.events()) == 0)
+
+# events of exited threads are kept until they're read
+trace.enable()
+for i in range(2):
+	t = threading.Thread(target = sign)
+	t.start()
+	t.join()
+trace.disable()
+
+assert(len(set(e[3] for e in trace.events() if e[0] == "sign")) == 2)
+assert(trace.dropped() == 0)
+trace.clear()
@@ -0,0 +1,72 @@
+import pyccn
+import threading, time
+
+prefix = pyccn.Name("/pyccn/test/verify")
+k = pyccn.CCN.getDefaultKey()
+other = pyccn.Key()
+other.generateRSA(1024)
+
+# answers /good with a valid signature, /bad is signed by another key than
+# the one its SignedInfo claims, /digest has only a digest
+class Producer(pyccn.Closure):
+	def upcall(self, kind, info):
+		if kind != pyccn.UPCALL_INTEREST:
+			return pyccn.RESULT_OK
+
+		name = info.Interest.name
+		co = pyccn.ContentObject(name, b"payload")
+		co.signedInfo.publisherPublicKeyDigest = k.publicKeyID
+		co.signedInfo.keyLocator = pyccn.KeyLocator(k)
+		if name[-1] == b"digest":
+			co.digestAlgorithm = pyccn.DIGEST_SHA256
+			co.sign()
+		else:
+			co.sign(other if name[-1] == b"bad" else k)
+		sender.put(co)
+
+		return pyccn.RESULT_INTEREST_CONSUMED
+
+results = {}
+finals = []
+
+class Receiver(pyccn.Closure):
+	def upcall(self, kind, info):
+		if kind == pyccn.UPCALL_FINAL:
+			finals.append(threading.current_thread())
+			return pyccn.RESULT_OK
+
+		assert kind != pyccn.UPCALL_CONTENT_UNVERIFIED
+		results[info.ContentObject.name[-1]] = (kind,
+			threading.current_thread())
+		return pyccn.RESULT_OK
+
+sender = pyccn.CCN()
+sender.setInterestFilter(prefix, Producer())
+sender_loop = threading.Thread(target = sender.run, args = (-1,))
+sender_loop.start()
+
+receiver = pyccn.CCN()
+receiver.setVerifier(pyccn.KeyChain(keys = [k, other]))
+
+for last in ("good", "bad", "digest"):
+	receiver.expressInterest(prefix.append(last), Receiver())
+
+deadline = time.time() + 10
+while len(finals) < 3 and time.time() < deadline:
+	receiver.run(100)
+
+sender.setRunTimeout(0)
+sender_loop.join(5)
+
+assert results[b"good"][0] == pyccn.UPCALL_CONTENT
+assert results[b"bad"][0] == pyccn.UPCALL_CONTENT_BAD
+assert results[b"digest"][0] == pyccn.UPCALL_CONTENT_BAD
+
+# closures are still called from run()
+me = threading.current_thread()
+assert results[b"good"][1] is me and results[b"bad"][1] is me
+assert results[b"digest"][1] is me
+assert finals == [me, me, me]
+
+assert receiver.verifierStats() == {"verified": 1, "bad": 2}
+receiver.setVerifier(None)